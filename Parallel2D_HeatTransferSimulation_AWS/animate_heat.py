@@ -1,6 +1,15 @@
 import numpy as np
 import matplotlib.pyplot as plt
 from matplotlib.animation import FuncAnimation
+import os
+import sys
+
+# Use the shared C kernels when ../libheat has been built, NumPy otherwise
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "libheat"))
+try:
+    import heat as libheat
+except OSError:
+    libheat = None
 
 # --------------------------------------------------
 # Grid + physical parameters
@@ -29,17 +38,20 @@ u[:, -1]  = cold_T
 
 def step_heat(u):
     """One explicit time step of 2D heat equation."""
-    new = u.copy()
-    new[1:-1, 1:-1] = (
-        u[1:-1, 1:-1]
-        + dt * (
-            u[2:, 1:-1] +
-            u[:-2, 1:-1] +
-            u[1:-1, 2:] +
-            u[1:-1, :-2] -
-            4 * u[1:-1, 1:-1]
+    if libheat is not None:
+        new = libheat.step(u, dt=dt)
+    else:
+        new = u.copy()
+        new[1:-1, 1:-1] = (
+            u[1:-1, 1:-1]
+            + dt * (
+                u[2:, 1:-1] +
+                u[:-2, 1:-1] +
+                u[1:-1, 2:] +
+                u[1:-1, :-2] -
+                4 * u[1:-1, 1:-1]
+            )
         )
-    )
 
     # Re-apply boundary conditions (hot top/bottom, cold sides)
     new[0, :]  = hot_T
@@ -11,6 +11,7 @@ class HeatSimulationVisualizer:
     def __init__(self, config_file='config.json'):
         """Initialize the visualizer with configuration"""
         self.config = self.load_config(config_file)
+        self.rows_coord, self.cols_coord = self.load_coordinates()
         self.setup_plot_style()
         
     def load_config(self, config_file):
@@ -54,6 +55,26 @@ class HeatSimulationVisualizer:
             else:
                 default[key] = value
     
+    def load_coordinates(self):
+        """Node coordinates written by a stretched-grid run (None on a uniform grid)"""
+        if os.path.exists('grid_x.txt') and os.path.exists('grid_y.txt'):
+            print("✓ Stretched grid: plotting at the node coordinates in grid_x.txt / grid_y.txt")
+            return np.loadtxt('grid_x.txt'), np.loadtxt('grid_y.txt')
+        return None, None
+    
+    def coordinates(self, T):
+        """Horizontal (column) and vertical (row) positions of the cells of T"""
+        if self.rows_coord is not None and len(self.rows_coord) == T.shape[0] and len(self.cols_coord) == T.shape[1]:
+            return self.cols_coord, self.rows_coord
+        return np.arange(T.shape[1]), np.arange(T.shape[0])
+    
+    def draw_field(self, ax, T, **kwargs):
+        """imshow on a uniform grid; pcolormesh at the node positions on a stretched one"""
+        if self.rows_coord is None:
+            return ax.imshow(T, origin='lower', **kwargs)
+        x, y = self.coordinates(T)
+        return ax.pcolormesh(x, y, T, shading='nearest', **kwargs)
+    
     def setup_plot_style(self):
         """Setup matplotlib style for better plots"""
         plt.style.use('default')
@@ -93,8 +114,8 @@ class HeatSimulationVisualizer:
             if os.path.exists(filename):
                 T = self.read_temperature_data(filename)
                 if T is not None:
-                    im = axes[idx].imshow(T, cmap=self.config['visualization']['colormap'], 
-                                        origin='lower', vmin=0, vmax=100)
+                    im = self.draw_field(axes[idx], T, cmap=self.config['visualization']['colormap'],
+                                         vmin=0, vmax=100)
                     axes[idx].set_title(title, fontweight='bold')
                     axes[idx].set_xlabel('X Position')
                     axes[idx].set_ylabel('Y Position')
@@ -133,8 +154,7 @@ class HeatSimulationVisualizer:
             return
         
         # Create meshgrid
-        x = np.arange(T.shape[1])
-        y = np.arange(T.shape[0])
+        x, y = self.coordinates(T)
         X, Y = np.meshgrid(x, y)
         
         # Create 3D plot
@@ -226,44 +246,52 @@ class HeatSimulationVisualizer:
         if T_final is None:
             return
         
-        # Calculate temperature gradient (heat flux direction)
-        grad_y, grad_x = np.gradient(T_final)
+        # Calculate temperature gradient (heat flux direction), per unit
+        # length on a stretched grid
+        x, y = self.coordinates(T_final)
+        if self.rows_coord is None:
+            grad_y, grad_x = np.gradient(T_final)
+        else:
+            grad_y, grad_x = np.gradient(T_final, y, x)
         heat_flux_magnitude = np.sqrt(grad_x**2 + grad_y**2)
         
         # Create figure with subplots
         fig, ((ax1, ax2), (ax3, ax4)) = plt.subplots(2, 2, figsize=(16, 14))
         
         # 1. Heat flux magnitude
-        im1 = ax1.imshow(heat_flux_magnitude, cmap='viridis', origin='lower')
+        im1 = self.draw_field(ax1, heat_flux_magnitude, cmap='viridis')
         ax1.set_title('Heat Flux Magnitude', fontweight='bold')
         ax1.set_xlabel('X Position')
         ax1.set_ylabel('Y Position')
         plt.colorbar(im1, ax=ax1, label='Flux Magnitude')
         
         # 2. Temperature gradient in X direction
-        im2 = ax2.imshow(grad_x, cmap='coolwarm', origin='lower')
+        im2 = self.draw_field(ax2, grad_x, cmap='coolwarm')
         ax2.set_title('Temperature Gradient (X-direction)', fontweight='bold')
         ax2.set_xlabel('X Position')
         ax2.set_ylabel('Y Position')
         plt.colorbar(im2, ax=ax2, label='∂T/∂X')
         
         # 3. Temperature gradient in Y direction
-        im3 = ax3.imshow(grad_y, cmap='coolwarm', origin='lower')
+        im3 = self.draw_field(ax3, grad_y, cmap='coolwarm')
         ax3.set_title('Temperature Gradient (Y-direction)', fontweight='bold')
         ax3.set_xlabel('X Position')
         ax3.set_ylabel('Y Position')
         plt.colorbar(im3, ax=ax3, label='∂T/∂Y')
         
         # 4. Streamplot of heat flux
-        x = np.arange(T_final.shape[1])
-        y = np.arange(T_final.shape[0])
         X, Y = np.meshgrid(x, y)
         
         # Plot temperature as background
-        im4 = ax4.imshow(T_final, cmap='hot', origin='lower', alpha=0.7)
-        # Overlay streamlines for heat flux
-        ax4.streamplot(X, Y, -grad_x, -grad_y, color='white', 
-                      linewidth=1, arrowsize=1, density=1.5)
+        im4 = self.draw_field(ax4, T_final, cmap='hot', alpha=0.7)
+        # Overlay streamlines for heat flux (streamplot needs even spacing,
+        # so stretched grids get arrows at their nodes instead)
+        if self.rows_coord is None:
+            ax4.streamplot(X, Y, -grad_x, -grad_y, color='white',
+                          linewidth=1, arrowsize=1, density=1.5)
+        else:
+            skip = (slice(None, None, max(1, T_final.shape[0] // 25)), slice(None, None, max(1, T_final.shape[1] // 25)))
+            ax4.quiver(X[skip], Y[skip], -grad_x[skip], -grad_y[skip], color='white')
         ax4.set_title('Heat Flux Streamlines', fontweight='bold')
         ax4.set_xlabel('X Position')
         ax4.set_ylabel('Y Position')
@@ -301,8 +329,8 @@ class HeatSimulationVisualizer:
                 ax2.clear()
                 
                 # Left subplot: Temperature heatmap
-                im1 = ax1.imshow(T, cmap=self.config['visualization']['colormap'], 
-                               origin='lower', vmin=0, vmax=100)
+                im1 = self.draw_field(ax1, T, cmap=self.config['visualization']['colormap'],
+                                      vmin=0, vmax=100)
                 ax1.set_title(f'Temperature Distribution - Step {step}', fontweight='bold')
                 ax1.set_xlabel('X Position')
                 ax1.set_ylabel('Y Position')
@@ -311,8 +339,9 @@ class HeatSimulationVisualizer:
                 center_row = T[T.shape[0]//2, :]
                 center_col = T[:, T.shape[1]//2]
                 
-                ax2.plot(center_row, 'r-', linewidth=2, label='Middle Row')
-                ax2.plot(center_col, 'b-', linewidth=2, label='Middle Column')
+                x, y = self.coordinates(T)
+                ax2.plot(x, center_row, 'r-', linewidth=2, label='Middle Row')
+                ax2.plot(y, center_col, 'b-', linewidth=2, label='Middle Column')
                 ax2.set_title(f'Cross-section Profiles - Step {step}', fontweight='bold')
                 ax2.set_xlabel('Position')
                 ax2.set_ylabel('Temperature (°C)')
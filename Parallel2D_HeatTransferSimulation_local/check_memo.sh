@@ -0,0 +1,46 @@
+#!/bin/bash
+# The result memo must never change a run's output: a run resumed from a
+# stored prefix has to match a fresh run byte for byte, with and without
+# tile skipping. Exit status 1 on a mismatch.
+# Usage: ./check_memo.sh [prefix steps] [total steps]
+
+PREFIX=${1:-3000}
+TOTAL=${2:-20000}
+SOLVER=$(pwd)/heat_simulation_advanced
+
+if [ ! -x "$SOLVER" ]; then
+    echo "Error: ./heat_simulation_advanced not found. Run 'make advanced' first."
+    exit 1
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+run() {
+    # run DIR ARGS...: one solve in its own directory, final field kept
+    local dir=$1
+    shift
+    mkdir -p "$dir"
+    (cd "$dir" && "$SOLVER" "$@" > log.txt 2>&1) || {
+        echo "Error: run in $dir failed"
+        tail -5 "$dir/log.txt"
+        exit 1
+    }
+}
+
+status=0
+for threshold in 0 2e-3; do
+    memo="$WORK/memo-$threshold"
+    run "$WORK/fresh-$threshold" --tile-threshold "$threshold" --set simulation.steps="$TOTAL"
+    run "$WORK/prefix-$threshold" --tile-threshold "$threshold" --memo "$memo" --set simulation.steps="$PREFIX"
+    run "$WORK/resumed-$threshold" --tile-threshold "$threshold" --memo "$memo" --set simulation.steps="$TOTAL"
+    resumed=$(grep -c "Memo: resumed" "$WORK/resumed-$threshold/log.txt")
+    if cmp -s "$WORK/fresh-$threshold/output_final.txt" "$WORK/resumed-$threshold/output_final.txt"; then
+        printf "threshold %-6s %s: matches a fresh run\n" "$threshold" \
+               "$([ "$resumed" -gt 0 ] && echo "resumed from step $PREFIX" || echo "memo bypassed")"
+    else
+        printf "threshold %-6s MISMATCH against a fresh run\n" "$threshold"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,919 @@
+// heat_pod: reduced-order (POD-Galerkin) surrogate of a heat run, built
+// from the snapshots the solvers write (output_step_*.txt from
+// save_to_file/write_snapshot, or binary checkpoints).
+//
+//   heat_pod build [--rank R] [--oversample P] [--power Q] [--model FILE]
+//                  [--config FILE] [--set KEY=VALUE]... SNAPSHOT...
+//   heat_pod eval  [--model FILE] [--tolerance TOL] [--probe I,J]...
+//                  [--field PREFIX] [--times FILE] [TIME...]
+//
+// build streams over the snapshots a few times, never holding more than
+// one: a randomized SVD of the centred snapshot matrix gives the POD
+// basis, and the discrete Laplacian (applied with a libheat backend) is
+// Galerkin-projected onto it. The result is a small linear ODE,
+// da/dt = A a + b, diagonalized once, so a query costs O(rank^2).
+// eval answers times with an estimate of the RMS error, from a second,
+// richer reduced model (see error_estimate).
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "heat.h"
+
+#define MODEL_FILE "pod.model"
+#define MODEL_MAGIC "HEATPOD1"
+#define CONFIG_FILE "config.json"
+
+// Basis size, extra random directions for the range finder, and power
+// iterations (each is one more pass over the snapshots)
+#define POD_RANK 10
+#define POD_MAX_RANK 64
+#define POD_OVERSAMPLE 5
+#define POD_POWER 1
+
+// The error-check model adds this many (alpha L)^-1 images of the
+// residual directions to the basis
+#define CHECK_LEVELS 2
+#define CHECK_MAX_RANK (POD_MAX_RANK + CHECK_LEVELS * (POD_MAX_RANK + 1))
+
+// Queries whose error estimate exceeds this fraction of the snapshots'
+// temperature range are flagged
+#define POD_TOLERANCE 0.01
+
+// Conjugate-gradient tolerance (relative) for the check model's Poisson solves
+#define CG_TOLERANCE 1e-10
+
+#define MAX_PROBES 16
+
+typedef struct {
+    const char *path;
+    int step;
+    int binary;                 // a checkpoint rather than a text snapshot
+} Snapshot;
+
+// A reduced ODE da/dt = A a + b on an orthonormal basis, diagonalized:
+// coefficients live in the eigenbasis of the (symmetrized) A, c = V^T a
+typedef struct {
+    int rank;
+    double *lambda;             // eigenvalues of A, descending
+    double *V;                  // eigenvectors, rank x rank, row-major
+    double *c0, *beta;          // V^T a0 and V^T b
+} ReducedOde;
+
+// Everything eval needs, as stored in the model file
+typedef struct {
+    int rows, cols;
+    double alpha, dx, dy, dt;
+    double t0;                  // time of the first snapshot (the initial condition)
+    double t_end;               // time of the last snapshot
+    double scale;               // temperature range of the snapshots
+    double energy;              // fraction of the snapshot variance the basis keeps
+    double asymmetry;           // ||A - A^T|| / ||A|| before symmetrizing
+    double *mean;               // u0, rows*cols
+    double *basis;              // Phi, rom.rank fields of rows*cols
+    ReducedOde rom;             // the surrogate, on Phi
+    ReducedOde check;           // the error check, on Phi and its enrichment
+} PodModel;
+
+// ---------------------------------------------------------------------------
+// Snapshot input
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s build [--rank R] [--oversample P] [--power Q] [--model FILE]\n"
+                    "                [--config FILE] [--set KEY=VALUE]... SNAPSHOT...\n"
+                    "       %s eval [--model FILE] [--tolerance TOL] [--probe I,J]... [--field PREFIX]\n"
+                    "               [--times FILE] [TIME...]\n", program, program);
+    exit(EXIT_FAILURE);
+}
+
+// Step number from a checkpoint header or a name like output_step_0400.txt; -1 if none
+static int snapshot_step(const char *path, int *binary) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) return -1;
+    heat_checkpoint_header header;
+    *binary = heat_checkpoint_load_header(fp, &header) == 0;
+    fclose(fp);
+    if (*binary) return header.step;
+    const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    const char *digits = strstr(name, "step_");
+    return digits != NULL && digits[5] >= '0' && digits[5] <= '9' ? atoi(digits + 5) : -1;
+}
+
+// Rows and columns of a text snapshot: its lines and the values on the first
+static int text_shape(const char *path, int *rows, int *cols) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) return -1;
+    *rows = *cols = 0;
+    int c, in_value = 0, line_has_value = 0;
+    while ((c = fgetc(fp)) != EOF) {
+        int space = c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        if (!space && !in_value && *rows == 0) (*cols)++;
+        in_value = !space;
+        line_has_value = line_has_value || !space;
+        if (c == '\n') {
+            if (line_has_value) (*rows)++;
+            line_has_value = 0;
+        }
+    }
+    if (line_has_value) (*rows)++;
+    fclose(fp);
+    return *rows > 0 && *cols > 0 ? 0 : -1;
+}
+
+// One snapshot into T (rows*cols); exits on a short or mismatched file
+static void read_snapshot(const Snapshot *snapshot, int rows, int cols, double *T) {
+    size_t cells = (size_t)rows * cols;
+    FILE *fp = fopen(snapshot->path, snapshot->binary ? "rb" : "r");
+    int ok = fp != NULL;
+    if (ok && snapshot->binary) {
+        heat_checkpoint_header header;
+        ok = heat_checkpoint_load_header(fp, &header) == 0 && header.nx == rows && header.ny == cols &&
+             fread(T, sizeof(double), cells, fp) == cells;
+    } else if (ok) {
+        for (size_t n = 0; n < cells && ok; n++) {
+            ok = fscanf(fp, "%lf", &T[n]) == 1;
+        }
+        double extra;
+        ok = ok && fscanf(fp, "%lf", &extra) != 1;
+    }
+    if (fp != NULL) fclose(fp);
+    if (!ok) {
+        fprintf(stderr, "ERROR: %s is not a %dx%d snapshot\n", snapshot->path, rows, cols);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static int by_step(const void *a, const void *b) {
+    return ((const Snapshot *)a)->step - ((const Snapshot *)b)->step;
+}
+
+// ---------------------------------------------------------------------------
+// Small dense linear algebra
+
+static double dot(const double *x, const double *y, size_t n) {
+    double sum = 0.0;
+    for (size_t k = 0; k < n; k++) sum += x[k] * y[k];
+    return sum;
+}
+
+// Orthonormalize k columns of length n in place (Gram-Schmidt, done
+// twice for accuracy). Columns that vanish are left as zero.
+static void orthonormalize(double *Q, int k, size_t n) {
+    for (int c = 0; c < k; c++) {
+        double *q = Q + (size_t)c * n;
+        double before = sqrt(dot(q, q, n));
+        for (int pass = 0; pass < 2; pass++) {
+            for (int p = 0; p < c; p++) {
+                const double *prev = Q + (size_t)p * n;
+                double projection = dot(prev, q, n);
+                for (size_t i = 0; i < n; i++) q[i] -= projection * prev[i];
+            }
+        }
+        double norm = sqrt(dot(q, q, n));
+        double inverse = norm > 1e-12 * before && norm > 0.0 ? 1.0 / norm : 0.0;
+        for (size_t i = 0; i < n; i++) q[i] *= inverse;
+    }
+}
+
+// Eigenvalues (descending) and eigenvectors (columns of V, row-major) of
+// a symmetric n x n matrix S, by cyclic Jacobi rotations. S is destroyed.
+static void symmetric_eigen(double *S, int n, double *values, double *V) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) V[i * n + j] = i == j;
+    }
+    for (int sweep = 0; sweep < 100; sweep++) {
+        double off = 0.0, total = 0.0;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                total += S[i * n + j] * S[i * n + j];
+                if (i != j) off += S[i * n + j] * S[i * n + j];
+            }
+        }
+        if (off <= 1e-30 * total || off == 0.0) break;
+        for (int p = 0; p < n; p++) {
+            for (int q = p + 1; q < n; q++) {
+                double apq = S[p * n + q];
+                if (apq == 0.0) continue;
+                double theta = (S[q * n + q] - S[p * n + p]) / (2.0 * apq);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double c = 1.0 / sqrt(t * t + 1.0), s = t * c;
+                for (int k = 0; k < n; k++) {
+                    double skp = S[k * n + p], skq = S[k * n + q];
+                    S[k * n + p] = c * skp - s * skq;
+                    S[k * n + q] = s * skp + c * skq;
+                }
+                for (int k = 0; k < n; k++) {
+                    double spk = S[p * n + k], sqk = S[q * n + k];
+                    S[p * n + k] = c * spk - s * sqk;
+                    S[q * n + k] = s * spk + c * sqk;
+                }
+                for (int k = 0; k < n; k++) {
+                    double vkp = V[k * n + p], vkq = V[k * n + q];
+                    V[k * n + p] = c * vkp - s * vkq;
+                    V[k * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < n; i++) values[i] = S[i * n + i];
+    // Selection sort by descending eigenvalue, swapping eigenvector columns along
+    for (int i = 0; i < n; i++) {
+        int best = i;
+        for (int j = i + 1; j < n; j++) {
+            if (values[j] > values[best]) best = j;
+        }
+        if (best == i) continue;
+        double value = values[i];
+        values[i] = values[best];
+        values[best] = value;
+        for (int k = 0; k < n; k++) {
+            double v = V[k * n + i];
+            V[k * n + i] = V[k * n + best];
+            V[k * n + best] = v;
+        }
+    }
+}
+
+// Standard normal samples from a fixed-seed xorshift (Box-Muller), so
+// the same snapshots always give the same model
+static double gaussian(uint64_t *state) {
+    double u[2];
+    for (int k = 0; k < 2; k++) {
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+        u[k] = ((*state >> 11) + 0.5) / 9007199254740992.0;
+    }
+    return sqrt(-2.0 * log(u[0])) * cos(6.283185307179586 * u[1]);
+}
+
+// out = -alpha L v on the interior from one explicit step (the ring keeps
+// its values, so its rows are zero). On fields that vanish on the ring
+// (the Dirichlet edges are in u0) this K = -alpha L is SPD.
+static void apply_operator(const heat_backend *backend, const heat_grid *grid, const double *v, double *out) {
+    size_t cells = (size_t)grid->rows * grid->cols;
+    memcpy(out, v, cells * sizeof(double));
+    backend->step(grid, v, out, heat_interior(grid));
+    for (size_t i = 0; i < cells; i++) out[i] = (v[i] - out[i]) / grid->dt;
+}
+
+// Solves -alpha L x = rhs by conjugate gradients; rhs must vanish on the
+// ring. work holds 3 fields. Returns the iteration count, or -1 when the
+// tolerance is not reached.
+static int solve_operator(const heat_backend *backend, const heat_grid *grid, const double *rhs, double *x,
+                          double *work) {
+    size_t cells = (size_t)grid->rows * grid->cols;
+    double *res = work, *dir = work + cells, *Ad = work + 2 * cells;
+    memset(x, 0, cells * sizeof(double));
+    memcpy(res, rhs, cells * sizeof(double));
+    memcpy(dir, rhs, cells * sizeof(double));
+    double rr = dot(res, res, cells), target = CG_TOLERANCE * CG_TOLERANCE * rr;
+    for (int it = 0; it < 4 * (grid->rows + grid->cols) + 100; it++) {
+        if (rr <= target) return it;
+        apply_operator(backend, grid, dir, Ad);
+        double step = rr / dot(dir, Ad, cells);
+        for (size_t i = 0; i < cells; i++) {
+            x[i] += step * dir[i];
+            res[i] -= step * Ad[i];
+        }
+        double next = dot(res, res, cells);
+        for (size_t i = 0; i < cells; i++) dir[i] = res[i] + (next / rr) * dir[i];
+        rr = next;
+    }
+    return rr <= target ? 0 : -1;
+}
+
+// ---------------------------------------------------------------------------
+// Reduced model: coefficients, error estimate, file format
+
+// a = V c, c_i = e^{l_i s} c0_i + beta_i (e^{l_i s} - 1) / l_i, s = t - t0
+static void pod_coefficients(const ReducedOde *ode, double s, double *a) {
+    double c[CHECK_MAX_RANK];
+    for (int i = 0; i < ode->rank; i++) {
+        double l = ode->lambda[i];
+        double growth = fabs(l * s) > 1e-12 ? expm1(l * s) / l : s;
+        c[i] = ode->c0[i] + (l * ode->c0[i] + ode->beta[i]) * growth;
+    }
+    for (int i = 0; i < ode->rank; i++) {
+        a[i] = dot(&ode->V[i * ode->rank], c, ode->rank);
+    }
+}
+
+// Estimated RMS error of the surrogate state a at time t. The error obeys
+// de/dt = alpha L e - R, where the residual R is the part of
+// alpha L (u0 + Phi a) outside the basis: a combination of the r + 1
+// fixed fields W = (I - Phi Phi^T) alpha L [u0 Phi]. The check model runs
+// the same Galerkin reduction on Phi plus K^-1 W, K^-2 W, ..., the
+// directions the error is driven into (exactly so at steady state, with
+// the slow modes weighted up), and its distance from the surrogate
+// stands in for the distance to the full solution. Its first rom.rank
+// basis vectors are Phi, so that distance is a coefficient difference:
+// O(rank^2) per query, like the surrogate itself.
+static double error_estimate(const PodModel *m, double t, const double *a) {
+    double b[CHECK_MAX_RANK];
+    pod_coefficients(&m->check, t - m->t0, b);
+    double sq = 0.0;
+    for (int i = 0; i < m->check.rank; i++) {
+        double d = i < m->rom.rank ? b[i] - a[i] : b[i];
+        sq += d * d;
+    }
+    return sqrt(sq / ((double)m->rows * m->cols));
+}
+
+static int ode_allocate(ReducedOde *ode) {
+    int r = ode->rank;
+    ode->lambda = (double *)malloc(r * sizeof(double));
+    ode->V = (double *)malloc(r * r * sizeof(double));
+    ode->c0 = (double *)malloc(r * sizeof(double));
+    ode->beta = (double *)malloc(r * sizeof(double));
+    return ode->lambda && ode->V && ode->c0 && ode->beta ? 0 : -1;
+}
+
+static void ode_free(ReducedOde *ode) {
+    free(ode->lambda);
+    free(ode->V);
+    free(ode->c0);
+    free(ode->beta);
+}
+
+static int pod_allocate(PodModel *m) {
+    size_t cells = (size_t)m->rows * m->cols;
+    m->mean = (double *)malloc(cells * sizeof(double));
+    m->basis = (double *)malloc(cells * m->rom.rank * sizeof(double));
+    int ok = ode_allocate(&m->rom) == 0;
+    ok = ode_allocate(&m->check) == 0 && ok;
+    return m->mean && m->basis && ok ? 0 : -1;
+}
+
+static void pod_free(PodModel *m) {
+    free(m->mean);
+    free(m->basis);
+    ode_free(&m->rom);
+    ode_free(&m->check);
+}
+
+// The scalars, then every array in PodModel order
+#define ODE_ARRAYS(ode) \
+    {(ode)->lambda, (size_t)(ode)->rank}, {(ode)->V, (size_t)(ode)->rank * (ode)->rank}, \
+    {(ode)->c0, (size_t)(ode)->rank}, {(ode)->beta, (size_t)(ode)->rank}
+#define MODEL_ARRAYS(m, cells) \
+    {(m)->mean, (cells)}, {(m)->basis, (cells) * (m)->rom.rank}, ODE_ARRAYS(&(m)->rom), ODE_ARRAYS(&(m)->check)
+
+typedef struct {
+    char magic[8];
+    int32_t rows, cols, rank, check_rank;
+    double alpha, dx, dy, dt, t0, t_end, scale, energy, asymmetry;
+} ModelHeader;
+
+static int pod_save(const PodModel *m, const char *path) {
+    ModelHeader header = {MODEL_MAGIC, m->rows, m->cols, m->rom.rank, m->check.rank, m->alpha, m->dx, m->dy,
+                          m->dt, m->t0, m->t_end, m->scale, m->energy, m->asymmetry};
+    size_t cells = (size_t)m->rows * m->cols;
+    struct { double *data; size_t count; } arrays[] = {MODEL_ARRAYS(m, cells)};
+    FILE *fp = fopen(path, "wb");
+    int ok = fp != NULL && fwrite(&header, sizeof(header), 1, fp) == 1;
+    for (size_t k = 0; k < sizeof(arrays) / sizeof(arrays[0]) && ok; k++) {
+        ok = fwrite(arrays[k].data, sizeof(double), arrays[k].count, fp) == arrays[k].count;
+    }
+    ok = fp != NULL && fclose(fp) == 0 && ok;
+    if (!ok) fprintf(stderr, "ERROR: Cannot write model %s\n", path);
+    return ok ? 0 : -1;
+}
+
+static int pod_load(PodModel *m, const char *path) {
+    ModelHeader header;
+    FILE *fp = fopen(path, "rb");
+    int ok = fp != NULL && fread(&header, sizeof(header), 1, fp) == 1 &&
+             memcmp(header.magic, MODEL_MAGIC, 8) == 0 && header.rank >= 1 && header.rank <= POD_MAX_RANK &&
+             header.check_rank >= header.rank && header.check_rank <= CHECK_MAX_RANK && header.rows >= 3 &&
+             header.cols >= 3;
+    if (ok) {
+        memset(m, 0, sizeof(*m));
+        m->rows = header.rows;
+        m->cols = header.cols;
+        m->rom.rank = header.rank;
+        m->check.rank = header.check_rank;
+        m->alpha = header.alpha;
+        m->dx = header.dx;
+        m->dy = header.dy;
+        m->dt = header.dt;
+        m->t0 = header.t0;
+        m->t_end = header.t_end;
+        m->scale = header.scale;
+        m->energy = header.energy;
+        m->asymmetry = header.asymmetry;
+        ok = pod_allocate(m) == 0;
+    }
+    if (ok) {
+        size_t cells = (size_t)m->rows * m->cols;
+        struct { double *data; size_t count; } arrays[] = {MODEL_ARRAYS(m, cells)};
+        for (size_t k = 0; k < sizeof(arrays) / sizeof(arrays[0]) && ok; k++) {
+            ok = fread(arrays[k].data, sizeof(double), arrays[k].count, fp) == arrays[k].count;
+        }
+    }
+    if (fp != NULL) fclose(fp);
+    if (!ok) fprintf(stderr, "ERROR: %s is not a POD model\n", path);
+    return ok ? 0 : -1;
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ---------------------------------------------------------------------------
+// build
+
+// Galerkin projection onto the orthonormal fields basis[0..rank):
+// A = Psi^T alpha L Psi and b = Psi^T alpha L u0, one explicit step per
+// field, then the symmetrized A diagonalized and the centred initial
+// condition x0 projected. Each eigenvalue l becomes the rate the solver's
+// explicit steps actually decay that mode at, log(1 + l dt) / dt, so the
+// model follows the snapshots rather than the time-continuous limit
+// (beta is rescaled to keep the steady state). work holds one field.
+// Returns the asymmetry ||A - A^T|| / ||A||, or -1 if allocation fails.
+static double reduce(const heat_backend *backend, const heat_grid *grid, const double *mean, const double *basis,
+                     const double *x0, ReducedOde *ode, double *work) {
+    size_t cells = (size_t)grid->rows * grid->cols;
+    int r = ode->rank;
+    double *A = (double *)malloc(((size_t)r * r + 2 * r) * sizeof(double));
+    if (A == NULL) return -1.0;
+    double *b = A + (size_t)r * r, *a0 = b + r;
+    for (int q = 0; q <= r; q++) {
+        apply_operator(backend, grid, q < r ? basis + (size_t)q * cells : mean, work);
+        for (int p = 0; p < r; p++) {
+            double value = -dot(basis + (size_t)p * cells, work, cells);
+            if (q < r) A[p * r + q] = value;
+            else b[p] = value;
+        }
+    }
+    double norm = 0.0, skew = 0.0;
+    for (int p = 0; p < r; p++) {
+        a0[p] = dot(basis + (size_t)p * cells, x0, cells);
+        for (int q = 0; q < p; q++) {
+            double mid = 0.5 * (A[p * r + q] + A[q * r + p]);
+            norm += A[p * r + q] * A[p * r + q] + A[q * r + p] * A[q * r + p];
+            skew += 2.0 * (A[p * r + q] - mid) * (A[p * r + q] - mid);
+            A[p * r + q] = A[q * r + p] = mid;
+        }
+        norm += A[p * r + p] * A[p * r + p];
+    }
+    symmetric_eigen(A, r, ode->lambda, ode->V);
+    for (int p = 0; p < r; p++) {
+        ode->c0[p] = 0.0;
+        ode->beta[p] = 0.0;
+        for (int q = 0; q < r; q++) {
+            ode->c0[p] += ode->V[q * r + p] * a0[q];
+            ode->beta[p] += ode->V[q * r + p] * b[q];
+        }
+        double l = ode->lambda[p], dt = grid->dt;
+        if (l < 0.0 && 1.0 + l * dt > 0.0) {
+            ode->lambda[p] = log1p(l * dt) / dt;
+            ode->beta[p] *= ode->lambda[p] / l;
+        }
+    }
+    free(A);
+    return norm > 0.0 ? sqrt(skew / norm) : 0.0;
+}
+
+static int build(int argc, char **argv) {
+    static heat_config cfg;
+    const char *model_path = MODEL_FILE, *config_path = NULL;
+    int rank = POD_RANK, oversample = POD_OVERSAMPLE, power = POD_POWER;
+    Snapshot *snapshots = (Snapshot *)malloc(argc * sizeof(Snapshot));
+    int count = 0;
+    for (int a = 2; a < argc; a++) {
+        if (strcmp(argv[a], "--rank") == 0 && a + 1 < argc) {
+            rank = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--oversample") == 0 && a + 1 < argc) {
+            oversample = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--power") == 0 && a + 1 < argc) {
+            power = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--model") == 0 && a + 1 < argc) {
+            model_path = argv[++a];
+        } else if (strcmp(argv[a], "--config") == 0 && a + 1 < argc) {
+            config_path = argv[++a];
+        } else if (strcmp(argv[a], "--set") == 0 && a + 1 < argc) {
+            a++;    // applied after the file
+        } else if (argv[a][0] == '-') {
+            usage(argv[0]);
+        } else {
+            snapshots[count].path = argv[a];
+            snapshots[count].step = snapshot_step(argv[a], &snapshots[count].binary);
+            if (snapshots[count].step < 0) {
+                fprintf(stderr, "ERROR: %s is missing or has no step number (expected output_step_N.txt or a checkpoint)\n", argv[a]);
+                return EXIT_FAILURE;
+            }
+            count++;
+        }
+    }
+    if (count < 2 || rank < 1 || rank > POD_MAX_RANK || oversample < 0 || power < 0) {
+        fprintf(stderr, "ERROR: Need at least 2 snapshots, a rank from 1 to 64 and non-negative --oversample/--power\n");
+        usage(argv[0]);
+    }
+    qsort(snapshots, count, sizeof(Snapshot), by_step);
+
+    // Physics: the solver defaults < config.json < --set < a checkpoint's own header
+    PodModel m;
+    memset(&m, 0, sizeof(m));
+    m.alpha = 0.1;
+    m.dx = m.dy = 0.01;
+    m.dt = 0.0001;
+    if (heat_config_load(&cfg, config_path ? config_path : CONFIG_FILE) != 0) {
+        if (config_path != NULL) {
+            fprintf(stderr, "ERROR: %s\n", cfg.error);
+            return EXIT_FAILURE;
+        }
+        cfg.count = 0;
+    }
+    for (int a = 2; a + 1 < argc; a++) {
+        if (strcmp(argv[a], "--set") == 0 && heat_config_set(&cfg, argv[++a]) != 0) {
+            fprintf(stderr, "ERROR: --set: %s\n", cfg.error);
+            return EXIT_FAILURE;
+        }
+    }
+    const struct { const char *key; double *value; } keys[] = {
+        {"simulation.alpha", &m.alpha}, {"simulation.dx", &m.dx}, {"simulation.dy", &m.dy}, {"simulation.dt", &m.dt}
+    };
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+        if (heat_config_double(&cfg, keys[k].key, keys[k].value) < 0) {
+            fprintf(stderr, "ERROR: %s must be a number\n", keys[k].key);
+            return EXIT_FAILURE;
+        }
+    }
+    if (snapshots[0].binary) {
+        heat_checkpoint_header header;
+        FILE *fp = fopen(snapshots[0].path, "rb");
+        if (fp == NULL || heat_checkpoint_load_header(fp, &header) != 0) {
+            fprintf(stderr, "ERROR: Cannot read %s\n", snapshots[0].path);
+            return EXIT_FAILURE;
+        }
+        fclose(fp);
+        m.rows = header.nx;
+        m.cols = header.ny;
+        m.alpha = header.alpha;
+        m.dx = header.dx;
+        m.dy = header.dy;
+        m.dt = header.dt;
+    } else if (text_shape(snapshots[0].path, &m.rows, &m.cols) != 0) {
+        fprintf(stderr, "ERROR: Cannot read %s\n", snapshots[0].path);
+        return EXIT_FAILURE;
+    }
+    if (m.rows < 3 || m.cols < 3) {
+        fprintf(stderr, "ERROR: %s is only %dx%d\n", snapshots[0].path, m.rows, m.cols);
+        return EXIT_FAILURE;
+    }
+    m.t0 = snapshots[0].step * m.dt;
+    m.t_end = snapshots[count - 1].step * m.dt;
+
+    size_t cells = (size_t)m.rows * m.cols;
+    int k = rank + oversample < count ? rank + oversample : count;
+    double *x = (double *)malloc(cells * sizeof(double));
+    double *Y = (double *)calloc(cells * k, sizeof(double));
+    double *omega = (double *)malloc((size_t)count * k * sizeof(double));
+    double *B = (double *)malloc((size_t)k * count * sizeof(double));
+    m.rom.rank = rank;
+    m.check.rank = rank + CHECK_LEVELS * (rank + 1);
+    if (!x || !Y || !omega || !B || pod_allocate(&m) != 0) {
+        fprintf(stderr, "ERROR: Allocation failed for a %dx%d grid\n", m.rows, m.cols);
+        return EXIT_FAILURE;
+    }
+    printf("POD surrogate from %d snapshots (%dx%d, steps %d-%d, t %g-%g)\n", count, m.rows, m.cols,
+           snapshots[0].step, snapshots[count - 1].step, m.t0, m.t_end);
+    double start = now();
+
+    // Pass 1: the mean (the offset u0) and the temperature range
+    double low = INFINITY, high = -INFINITY;
+    memset(m.mean, 0, cells * sizeof(double));
+    for (int j = 0; j < count; j++) {
+        read_snapshot(&snapshots[j], m.rows, m.cols, x);
+        for (size_t i = 0; i < cells; i++) {
+            m.mean[i] += x[i] / count;
+            low = fmin(low, x[i]);
+            high = fmax(high, x[i]);
+        }
+    }
+    m.scale = high > low ? high - low : 1.0;
+
+    // Pass 2: sketch Y = X Omega of the centred snapshot matrix X
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    for (size_t n = 0; n < (size_t)count * k; n++) omega[n] = gaussian(&seed);
+    for (int j = 0; j < count; j++) {
+        read_snapshot(&snapshots[j], m.rows, m.cols, x);
+        for (size_t i = 0; i < cells; i++) x[i] -= m.mean[i];
+        for (int c = 0; c < k; c++) {
+            double w = omega[(size_t)j * k + c];
+            double *y = Y + (size_t)c * cells;
+            for (size_t i = 0; i < cells; i++) y[i] += w * x[i];
+        }
+    }
+
+    // Power iterations, Y = X X^T Q, one pass each, sharpen the spectrum
+    for (int q = 0; q < power; q++) {
+        orthonormalize(Y, k, cells);
+        double *Z = (double *)calloc(cells * k, sizeof(double));
+        if (Z == NULL) {
+            fprintf(stderr, "ERROR: Allocation failed for a power iteration\n");
+            return EXIT_FAILURE;
+        }
+        for (int j = 0; j < count; j++) {
+            read_snapshot(&snapshots[j], m.rows, m.cols, x);
+            for (size_t i = 0; i < cells; i++) x[i] -= m.mean[i];
+            for (int c = 0; c < k; c++) {
+                double w = dot(Y + (size_t)c * cells, x, cells);
+                double *z = Z + (size_t)c * cells;
+                for (size_t i = 0; i < cells; i++) z[i] += w * x[i];
+            }
+        }
+        free(Y);
+        Y = Z;
+    }
+    orthonormalize(Y, k, cells);
+
+    // Pass: B = Q^T X (k x count) and the total variance
+    double variance = 0.0;
+    for (int j = 0; j < count; j++) {
+        read_snapshot(&snapshots[j], m.rows, m.cols, x);
+        for (size_t i = 0; i < cells; i++) x[i] -= m.mean[i];
+        variance += dot(x, x, cells);
+        for (int c = 0; c < k; c++) B[(size_t)c * count + j] = dot(Y + (size_t)c * cells, x, cells);
+    }
+
+    // SVD of the small B through the eigenvectors of B B^T
+    double *S = (double *)malloc((size_t)k * k * sizeof(double));
+    double *U = (double *)malloc((size_t)k * k * sizeof(double));
+    double *sigma2 = (double *)malloc(k * sizeof(double));
+    for (int p = 0; p < k; p++) {
+        for (int q = 0; q < k; q++) S[p * k + q] = dot(B + (size_t)p * count, B + (size_t)q * count, count);
+    }
+    symmetric_eigen(S, k, sigma2, U);
+    int kept = 0;
+    double captured = 0.0;
+    while (kept < rank && kept < k && sigma2[kept] > 1e-20 * sigma2[0] && sigma2[kept] > 0.0) {
+        captured += sigma2[kept];
+        kept++;
+    }
+    if (kept == 0) {
+        fprintf(stderr, "ERROR: The snapshots do not change; there is nothing to reduce\n");
+        return EXIT_FAILURE;
+    }
+    if (kept < rank) {
+        printf("Rank reduced from %d to %d (the snapshots span no more directions)\n", rank, kept);
+    }
+    m.rom.rank = kept;
+    m.energy = variance > 0.0 ? captured / variance : 1.0;
+
+    // Phi = Q U[:, :rank]
+    for (int r = 0; r < m.rom.rank; r++) {
+        double *phi = m.basis + (size_t)r * cells;
+        memset(phi, 0, cells * sizeof(double));
+        for (int c = 0; c < k; c++) {
+            double w = U[c * k + r];
+            const double *q = Y + (size_t)c * cells;
+            for (size_t i = 0; i < cells; i++) phi[i] += w * q[i];
+        }
+    }
+
+    // The surrogate: the Galerkin projection onto Phi, started from the
+    // first snapshot
+    heat_grid grid = {m.rows, m.cols, m.cols, m.alpha, m.dx, m.dy, m.dt};
+    const heat_backend *backend = heat_select_backend(NULL);
+    if (backend == NULL) backend = heat_get_backend(HEAT_DEFAULT_BACKEND);
+    int r = m.rom.rank;
+    double *work = (double *)malloc(4 * cells * sizeof(double));
+    m.check.rank = r + CHECK_LEVELS * (r + 1);
+    double *Psi = (double *)calloc(cells * m.check.rank, sizeof(double));
+    if (work == NULL || Psi == NULL) {
+        fprintf(stderr, "ERROR: Allocation failed for the error check\n");
+        return EXIT_FAILURE;
+    }
+    read_snapshot(&snapshots[0], m.rows, m.cols, x);
+    for (size_t i = 0; i < cells; i++) x[i] -= m.mean[i];
+    m.asymmetry = reduce(backend, &grid, m.mean, m.basis, x, &m.rom, work);
+
+    // The error check: Phi, then the residual directions
+    // W = (I - Phi Phi^T) K [u0 Phi] pulled back through K^-1 once per
+    // level, orthonormalized; directions already spanned are dropped
+    memcpy(Psi, m.basis, cells * r * sizeof(double));
+    int n = r;
+    for (int j = 0; j <= r; j++) {
+        double *w = work + 3 * cells;
+        apply_operator(backend, &grid, j < r ? m.basis + (size_t)j * cells : m.mean, w);
+        for (int p = 0; p < r; p++) {
+            const double *phi = m.basis + (size_t)p * cells;
+            double projection = dot(phi, w, cells);
+            for (size_t i = 0; i < cells; i++) w[i] -= projection * phi[i];
+        }
+        for (int level = 0; level < CHECK_LEVELS && dot(w, w, cells) > 0.0; level++) {
+            double *z = Psi + (size_t)(r + level * (r + 1) + j) * cells;
+            if (solve_operator(backend, &grid, w, z, work) < 0) {
+                printf("WARNING: A Poisson solve for the error check did not converge\n");
+            }
+            memcpy(w, z, cells * sizeof(double));
+        }
+    }
+    orthonormalize(Psi, m.check.rank, cells);
+    for (int c = r; c < m.check.rank; c++) {
+        double *psi = Psi + (size_t)c * cells;
+        if (dot(psi, psi, cells) > 0.5) memmove(Psi + (size_t)n++ * cells, psi, cells * sizeof(double));
+    }
+    m.check.rank = n;
+    if (reduce(backend, &grid, m.mean, Psi, x, &m.check, work) < 0.0 || m.asymmetry < 0.0) {
+        fprintf(stderr, "ERROR: Allocation failed for the reduced operators\n");
+        return EXIT_FAILURE;
+    }
+    double build_time = now() - start;
+
+    // Check against the snapshots: the surrogate's actual RMS error at
+    // each snapshot time (||x - u0||^2 - 2 a.Phi^T(x - u0) + ||a||^2) next
+    // to the estimate eval would report
+    double worst = 0.0, worst_estimate = 0.0, low_ratio = INFINITY, high_ratio = 0.0;
+    for (int j = 0; j < count; j++) {
+        double a[POD_MAX_RANK];
+        double t = snapshots[j].step * m.dt;
+        read_snapshot(&snapshots[j], m.rows, m.cols, x);
+        for (size_t i = 0; i < cells; i++) x[i] -= m.mean[i];
+        pod_coefficients(&m.rom, t - m.t0, a);
+        double sq = dot(x, x, cells) + dot(a, a, r);
+        for (int p = 0; p < r; p++) sq -= 2.0 * a[p] * dot(m.basis + (size_t)p * cells, x, cells);
+        double error = sq > 0.0 ? sqrt(sq / cells) : 0.0;
+        double estimate = error_estimate(&m, t, a);
+        worst = fmax(worst, error);
+        worst_estimate = fmax(worst_estimate, estimate);
+        if (error > 1e-6 * (m.scale + 1.0)) {    // above the text snapshots' rounding
+            low_ratio = fmin(low_ratio, estimate / error);
+            high_ratio = fmax(high_ratio, estimate / error);
+        }
+    }
+
+    printf("Basis: %d modes keep %.6f%% of the snapshot variance (%d random directions, %d power iterations)\n",
+           r, 100.0 * m.energy, k, power);
+    printf("Reduced operator: eigenvalues %.4g to %.4g, asymmetry %.2e before symmetrizing\n",
+           m.rom.lambda[r - 1], m.rom.lambda[0], m.asymmetry);
+    if (m.rom.lambda[0] > 0.0) {
+        printf("WARNING: The reduced operator has a growing mode; expect flagged queries\n");
+    }
+    printf("Error check: rank %d; against the snapshots max RMS error %.3e, max estimate %.3e", m.check.rank,
+           worst, worst_estimate);
+    if (high_ratio > 0.0) printf(" (estimate/error %.2f to %.2f)", low_ratio, high_ratio);
+    printf("\n");
+    if (high_ratio > 0.0 && low_ratio < 0.5) {
+        printf("WARNING: The estimate misses part of the error at the snapshots; were the edges Dirichlet?\n");
+    }
+    printf("Built in %.3f s\n", build_time);
+    int status = pod_save(&m, model_path);
+    if (status == 0) {
+        printf("✓ Model saved to %s (%.1f MB)\n", model_path,
+               (cells * (r + 1.0) + r * (r + 3.0) + n * (n + 3.0)) * sizeof(double) / (1024.0 * 1024.0));
+    }
+
+    free(snapshots);
+    free(x);
+    free(Y);
+    free(omega);
+    free(B);
+    free(S);
+    free(U);
+    free(sigma2);
+    free(work);
+    free(Psi);
+    pod_free(&m);
+    return status == 0 ? 0 : EXIT_FAILURE;
+}
+
+// ---------------------------------------------------------------------------
+// eval
+
+static int eval(int argc, char **argv) {
+    const char *model_path = MODEL_FILE, *times_path = NULL, *field_prefix = NULL;
+    double tolerance = POD_TOLERANCE;
+    int probes[MAX_PROBES][2], probe_count = 0;
+    double *times = (double *)malloc(argc * sizeof(double));
+    int count = 0, capacity = argc;
+    for (int a = 2; a < argc; a++) {
+        if (strcmp(argv[a], "--model") == 0 && a + 1 < argc) {
+            model_path = argv[++a];
+        } else if (strcmp(argv[a], "--tolerance") == 0 && a + 1 < argc) {
+            tolerance = atof(argv[++a]);
+        } else if (strcmp(argv[a], "--times") == 0 && a + 1 < argc) {
+            times_path = argv[++a];
+        } else if (strcmp(argv[a], "--field") == 0 && a + 1 < argc) {
+            field_prefix = argv[++a];
+        } else if (strcmp(argv[a], "--probe") == 0 && a + 1 < argc && probe_count < MAX_PROBES) {
+            if (sscanf(argv[++a], "%d,%d", &probes[probe_count][0], &probes[probe_count][1]) != 2) usage(argv[0]);
+            probe_count++;
+        } else {
+            char *end;
+            times[count] = strtod(argv[a], &end);
+            if (end == argv[a] || *end != '\0') usage(argv[0]);
+            count++;
+        }
+    }
+    if (times_path != NULL) {
+        FILE *fp = fopen(times_path, "r");
+        if (fp == NULL) {
+            fprintf(stderr, "ERROR: Cannot open %s\n", times_path);
+            return EXIT_FAILURE;
+        }
+        double t;
+        while (fscanf(fp, "%lf", &t) == 1) {
+            if (count == capacity) {
+                capacity *= 2;
+                times = (double *)realloc(times, capacity * sizeof(double));
+                if (times == NULL) return EXIT_FAILURE;
+            }
+            times[count++] = t;
+        }
+        fclose(fp);
+    }
+
+    PodModel m;
+    if (pod_load(&m, model_path) != 0) return EXIT_FAILURE;
+    for (int p = 0; p < probe_count; p++) {
+        if (probes[p][0] < 0 || probes[p][0] >= m.rows || probes[p][1] < 0 || probes[p][1] >= m.cols) {
+            fprintf(stderr, "ERROR: Probe %d,%d is outside the %dx%d grid\n", probes[p][0], probes[p][1], m.rows, m.cols);
+            return EXIT_FAILURE;
+        }
+    }
+    if (count == 0) times[count++] = m.t_end;
+    printf("Model %s: %dx%d, rank %d, trained on t %g-%g, tolerance %g of the %g range\n",
+           model_path, m.rows, m.cols, m.rom.rank, m.t0, m.t_end, tolerance, m.scale);
+
+    // Time the queries themselves (coefficients, estimate and probes), in
+    // a loop long enough for the clock
+    size_t cells = (size_t)m.rows * m.cols;
+    double *estimates = (double *)malloc(count * sizeof(double));
+    double *values = (double *)malloc((size_t)count * (probe_count + 1) * sizeof(double));
+    double a[POD_MAX_RANK];
+    int repeats = 0;
+    double start = now(), elapsed;
+    do {
+        for (int q = 0; q < count; q++) {
+            pod_coefficients(&m.rom, times[q] - m.t0, a);
+            estimates[q] = error_estimate(&m, times[q], a);
+            for (int p = 0; p < probe_count; p++) {
+                size_t cell = (size_t)probes[p][0] * m.cols + probes[p][1];
+                double value = m.mean[cell];
+                for (int r = 0; r < m.rom.rank; r++) value += m.basis[r * cells + cell] * a[r];
+                values[(size_t)q * probe_count + p] = value;
+            }
+        }
+        repeats++;
+        elapsed = now() - start;
+    } while (elapsed < 0.05);
+    double per_query = elapsed / ((double)repeats * count);
+
+    int flagged = 0;
+    double *T = field_prefix ? (double *)malloc(cells * sizeof(double)) : NULL;
+    heat_grid grid = {m.rows, m.cols, m.cols, m.alpha, m.dx, m.dy, m.dt};
+    for (int q = 0; q < count; q++) {
+        int trusted = times[q] >= m.t0 && estimates[q] <= tolerance * m.scale;
+        flagged += !trusted;
+        printf("t=%-10g RMS error ~ %.3e  %s", times[q], estimates[q],
+               trusted ? "ok       " : times[q] < m.t0 ? "UNTRUSTED (before the first snapshot)" : "UNTRUSTED");
+        for (int p = 0; p < probe_count; p++) {
+            printf("  T[%d,%d]=%.6f", probes[p][0], probes[p][1], values[(size_t)q * probe_count + p]);
+        }
+        if (trusted && times[q] > m.t_end) printf("  (extrapolated)");
+        printf("\n");
+        if (T != NULL) {
+            char filename[512];
+            pod_coefficients(&m.rom, times[q] - m.t0, a);
+            memcpy(T, m.mean, cells * sizeof(double));
+            for (int r = 0; r < m.rom.rank; r++) {
+                for (size_t i = 0; i < cells; i++) T[i] += m.basis[r * cells + i] * a[r];
+            }
+            snprintf(filename, sizeof(filename), "%s_%04d.txt", field_prefix, q);
+            FILE *fp = fopen(filename, "w");
+            if (fp == NULL) {
+                fprintf(stderr, "ERROR: Cannot open file %s for writing\n", filename);
+                continue;
+            }
+            heat_write_rows(&grid, T, 0, m.rows, fp);
+            fclose(fp);
+        }
+    }
+    printf("✓ %d queries, %.2f µs each (coefficients, error estimate%s); %d flagged\n", count, per_query * 1e6,
+           probe_count ? " and probes" : "", flagged);
+    if (T != NULL) printf("✓ Fields written to %s_NNNN.txt\n", field_prefix);
+
+    free(T);
+    free(times);
+    free(estimates);
+    free(values);
+    pod_free(&m);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "build") == 0) return build(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "eval") == 0) return eval(argc, argv);
+    usage(argv[0]);
+    return EXIT_FAILURE;
+}
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include "heat.h"
 
 #define NX 100
 #define NY 100
@@ -12,67 +13,93 @@
 #define STEPS 1000
 #define OUTPUT_INTERVAL 100
 
-void initialize(double T[NX][NY]) {
+// Stencil backend from libheat, chosen with $HEAT_BACKEND (default scalar)
+static const heat_backend *backend;
+static const heat_grid grid = {NX, NY, NY, ALPHA, DX, DY, DT};
+
+// Field storage, chosen with $HEAT_LAYOUT (rowmajor, tiled or morton)
+static heat_layout layout;
+#define T_AT(T, i, j) HEAT_AT(&layout, T, i, j)
+
+void initialize(double *T) {
     // Initialize with zero temperature everywhere
     for (int i = 0; i < NX; i++) {
         for (int j = 0; j < NY; j++) {
-            T[i][j] = 0.0;
+            T_AT(T, i, j) = 0.0;
         }
     }
     
     // Set boundary conditions: heat from top and bottom
     for (int j = 0; j < NY; j++) {
-        T[0][j] = 100.0;      // Top boundary (hot)
-        T[NX-1][j] = 100.0;   // Bottom boundary (hot)
-        T[j][0] = 0.0;        // Left boundary (cold)
-        T[j][NY-1] = 0.0;     // Right boundary (cold)
+        T_AT(T, 0, j) = 100.0;      // Top boundary (hot)
+        T_AT(T, NX-1, j) = 100.0;   // Bottom boundary (hot)
+        T_AT(T, j, 0) = 0.0;        // Left boundary (cold)
+        T_AT(T, j, NY-1) = 0.0;     // Right boundary (cold)
     }
 }
 
-void update_temperature(double T[NX][NY], double T_new[NX][NY]) {
-    double dx2 = DX * DX;
-    double dy2 = DY * DY;
-    
-    // Update interior points
-    for (int i = 1; i < NX-1; i++) {
-        for (int j = 1; j < NY-1; j++) {
-            double d2T_dx2 = (T[i+1][j] - 2*T[i][j] + T[i-1][j]) / dx2;
-            double d2T_dy2 = (T[i][j+1] - 2*T[i][j] + T[i][j-1]) / dy2;
-            
-            T_new[i][j] = T[i][j] + ALPHA * DT * (d2T_dx2 + d2T_dy2);
-        }
+void update_temperature(double *T, double *T_new) {
+    // Update interior points (row-major fields go through the backend).
+    // In place ($HEAT_INPLACE) there is no second grid.
+    if (T_new == NULL) {
+        heat_step_inplace(backend, &grid, T, heat_interior(&grid));
+        T_new = T;
+    } else {
+        heat_layout_step(&layout, backend, &grid, T, T_new, heat_interior(&grid));
     }
     
     // Apply boundary conditions (keep constant)
     for (int j = 0; j < NY; j++) {
-        T_new[0][j] = 100.0;      // Top
-        T_new[NX-1][j] = 100.0;   // Bottom
+        T_AT(T_new, 0, j) = 100.0;      // Top
+        T_AT(T_new, NX-1, j) = 100.0;   // Bottom
     }
     for (int i = 0; i < NX; i++) {
-        T_new[i][0] = 0.0;        // Left
-        T_new[i][NY-1] = 0.0;     // Right
+        T_AT(T_new, i, 0) = 0.0;        // Left
+        T_AT(T_new, i, NY-1) = 0.0;     // Right
     }
 }
 
-void save_to_file(double T[NX][NY], const char* filename) {
+void save_to_file(double *T, const char* filename) {
     FILE *fp = fopen(filename, "w");
-    for (int i = 0; i < NX; i++) {
-        for (int j = 0; j < NY; j++) {
-            fprintf(fp, "%.6f ", T[i][j]);
-        }
-        fprintf(fp, "\n");
-    }
+    heat_layout_write_rows(&layout, T, 0, NX, fp);
     fclose(fp);
     printf("Saved data to %s\n", filename);
 }
 
 int main() {
-    double T[NX][NY], T_new[NX][NY];
+    backend = heat_select_backend(NULL);
+    if (backend == NULL) {
+        fprintf(stderr, "ERROR: Unknown %s '%s'. Available backends:\n", HEAT_BACKEND_ENV, getenv(HEAT_BACKEND_ENV));
+        heat_list_backends(stderr);
+        return 1;
+    }
+    int kind = heat_parse_layout(getenv(HEAT_LAYOUT_ENV));
+    if (kind < 0) {
+        fprintf(stderr, "ERROR: Unknown %s '%s' (rowmajor, tiled or morton)\n", HEAT_LAYOUT_ENV, getenv(HEAT_LAYOUT_ENV));
+        return 1;
+    }
+    const char *inplace_env = getenv(HEAT_INPLACE_ENV);
+    int inplace = inplace_env != NULL && inplace_env[0] != '\0' && strcmp(inplace_env, "0") != 0;
+    if (inplace && kind != HEAT_LAYOUT_ROW_MAJOR) {
+        fprintf(stderr, "ERROR: %s needs the row-major layout\n", HEAT_INPLACE_ENV);
+        return 1;
+    }
+    double *T = NULL, *T_new = NULL;
+    if (heat_layout_init(&layout, (heat_layout_kind)kind, NX, NY) == 0) {
+        T = (double *)calloc(layout.size, sizeof(double));
+        T_new = inplace ? NULL : (double *)calloc(layout.size, sizeof(double));
+    }
+    if (T == NULL || (!inplace && T_new == NULL)) {
+        fprintf(stderr, "ERROR: Memory allocation failed\n");
+        return 1;
+    }
     
     printf("Initializing 2D Heat Simulation...\n");
     printf("Grid size: %dx%d\n", NX, NY);
     printf("Time steps: %d\n", STEPS);
     printf("Boundary conditions: Top=100°C, Bottom=100°C, Sides=0°C\n");
+    printf("Stencil backend: %s\n", backend->name);
+    printf("Memory layout: %s%s\n", heat_layout_name(layout.kind), inplace ? ", updated in place" : "");
     
     initialize(T);
     save_to_file(T, "output_step_0000.txt");
@@ -81,7 +108,9 @@ int main() {
         update_temperature(T, T_new);
         
         // Copy T_new to T for next iteration
-        memcpy(T, T_new, NX * NY * sizeof(double));
+        if (T_new != NULL) {
+            memcpy(T, T_new, layout.size * sizeof(double));
+        }
         
         if ((step + 1) % OUTPUT_INTERVAL == 0) {
             char filename[50];
@@ -94,5 +123,8 @@ int main() {
     save_to_file(T, "output_final.txt");
     printf("Simulation completed successfully!\n");
     
+    free(T);
+    free(T_new);
+    heat_layout_free(&layout);
     return 0;
 }
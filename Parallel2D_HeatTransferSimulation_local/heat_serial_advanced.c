@@ -4,7 +4,61 @@
 #include <string.h>
 #include <time.h>
 #include <sys/time.h>
+#include <sys/resource.h>
 #include <unistd.h>
+#include <dirent.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <utime.h>
+#include "heat.h"
+
+// Run configuration: built-in defaults < config.json (or --config FILE)
+// < --set KEY=VALUE < dedicated options such as --bc or --backend
+#define CONFIG_FILE "config.json"
+
+// Checkpoint/restart (heat_checkpoint_header, same format as heat_mpi.c)
+#define CHECKPOINT_FILE "checkpoint.bin"
+
+// Tile activity tracking: a tile is skipped once it and its four
+// neighbours changed by at most TILE_THRESHOLD for TILE_IDLE_STEPS steps.
+// The default threshold only skips tiles that did not change at all.
+#define TILE_SIZE 32
+#define TILE_IDLE_STEPS 4
+#define TILE_THRESHOLD 0.0
+
+// Spatial order of the stencil: 2 (5-point) or 4 (wide 9-point cross,
+// Dirichlet edges only). The 4th-order stencil reaches a given accuracy
+// on a much coarser grid; see libheat's order-bench.
+#define STENCIL_ORDER 2
+
+// Out-of-core mode (--out-of-core FILE): T lives in a memory-mapped file
+// and each pass streams it through a window of a few rows per step,
+// advancing OOC_TIME_BLOCK steps before writing back. Finished slabs of
+// OOC_SLAB_ROWS rows are released and the next one prefetched.
+#define OOC_TIME_BLOCK 8
+#define OOC_SLAB_ROWS 256
+
+// Query daemon (--serve SOCKET): one JSON request per line on a Unix
+// socket, shaped like config.json. Final fields stay in an LRU cache of
+// up to DAEMON_CACHE_MB megabytes (DAEMON_MAX_ENTRIES results), keyed by
+// a hash of the canonicalized configuration.
+#define DAEMON_CACHE_MB 256
+#define DAEMON_MAX_ENTRIES 64
+#define DAEMON_LINE_MAX 8192
+
+// Result memo (--memo DIR): final states, and periodic checkpoints, stored
+// as checkpoint files named KEY-STEP-CHECKSUM.ckpt. KEY covers everything
+// but the step count, so a longer run resumes from the longest stored
+// prefix. Least recently used files go once the store exceeds MEMO_MB.
+#define MEMO_MB 1024
+#define MEMO_SUFFIX ".ckpt"
 
 // Configuration structure
 typedef struct {
@@ -12,21 +66,90 @@ typedef struct {
     double alpha, dx, dy, dt;
     int steps;
     double top_temp, bottom_temp, left_temp, right_temp;
+    heat_bc_type bc_type[HEAT_EDGE_COUNT];  // per edge, dirichlet unless set with --bc
+    double bc_param[HEAT_EDGE_COUNT];       // neumann: outward dT/dn; robin: transfer coefficient
     int output_interval;
     int progress_bar_width;
+    int checkpoint_interval;
+    const char *checkpoint_path;
+    const char *restart_path;
+    double tile_threshold;
+    const char *backend_name;   // libheat stencil backend, NULL for $HEAT_BACKEND/scalar
+    int jit;                    // compile a kernel specialized for this grid at startup
+    int order;                  // STENCIL_ORDER unless set with --order
+    int inplace;                // update T over itself (no T_new); disables tile skipping
+    const char *out_of_core;    // file holding T, NULL to keep T in memory
+    int time_block;             // steps per out-of-core pass
+    int slab_rows;              // rows per out-of-core prefetch/release slab
+    const char *mask_path;      // geometry mask (holes, fixed-temperature cells), NULL for a full rectangle
+    const char *materials_path; // per-cell diffusivity map, NULL for a uniform alpha
+    int float_coeffs;           // store the materials' face coefficients as float
+    heat_stretch stretch[2];    // node spacing down the rows (x) and across the columns (y)
+    int axisymmetric;           // rows are z, columns are r with the axis at column 0
+    const char *basis_cache;    // boundary superposition cache, NULL to step the run
+    const char *queries_path;   // edge temperatures to answer from the cache, NULL for none
+    const char *serve_path;     // Unix socket to serve requests on, NULL for a single run
+    int cache_mb;               // daemon result cache size
+    const char *memo_dir;       // on-disk result memo, NULL to always start from scratch
+    int memo_mb;                // memo size before least recently used entries are evicted
 } SimulationConfig;
 
+// Per-tile activity over the interior cells [1, nx-1) x [1, ny-1)
+typedef struct {
+    int rows, cols;
+    double *max_change;         // max |dT| of each tile in the last step
+    int *quiet_steps;           // consecutive steps with no change above threshold nearby
+    unsigned char *active;
+    int *active_list;
+    int active_count;
+    long long cell_updates;
+    long long skipped_updates;
+} TileTracker;
+
 // Function declarations
 double get_current_time();
 void print_progress_bar(int iteration, int total, double start_time, int bar_width);
 void print_simulation_header(SimulationConfig config);
 void initialize(double **T, SimulationConfig config);
-void update_temperature(double **T, double **T_new, SimulationConfig config);
-double calculate_residual(double **T, SimulationConfig config);
+void apply_boundaries(double **T, SimulationConfig config);
+void update_temperature(double **T, double **T_new, SimulationConfig config, TileTracker *tiles,
+                        const heat_backend *backend);
+void update_tile_activity(double **T, double **T_new, SimulationConfig config, TileTracker *tiles);
+double calculate_residual(const TileTracker *tiles, SimulationConfig config);
+void tiles_init(TileTracker *tiles, SimulationConfig config);
+void tiles_free(TileTracker *tiles);
 void save_to_file(double **T, SimulationConfig config, const char* filename);
 double **allocate_2d_array(int nx, int ny);
 void free_2d_array(double **array, int nx);
+double **map_2d_array(const char *path, int nx, int ny);
 void validate_simulation(SimulationConfig config);
+void write_checkpoint(double **T, SimulationConfig config, int step);
+int load_checkpoint_header(SimulationConfig *config);
+void load_checkpoint_data(double **T, SimulationConfig config);
+void parse_args(int argc, char **argv, SimulationConfig *config);
+int apply_config(SimulationConfig *config, heat_config *cfg);
+
+static volatile sig_atomic_t stop_requested = 0;
+
+// The file behind T in out-of-core mode (T == NULL otherwise)
+static heat_mapped_field mapped_field;
+
+// Geometry from --mask (kind == NULL for a full rectangle)
+static heat_mask mask;
+
+// Diffusivity map from --materials (kind == NULL for a uniform alpha)
+static heat_materials materials;
+
+// Node coordinates and stencil weights from --stretch (x == NULL on a uniform grid)
+static heat_stretched stretched;
+
+// Radial weights from --axisymmetric (inner == NULL on a Cartesian grid)
+static heat_axisym axisym;
+
+static void request_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
 
 // High-resolution timer
 double get_current_time() {
@@ -70,11 +193,16 @@ void print_simulation_header(SimulationConfig config) {
            config.top_temp, config.bottom_temp);
     printf("║   Left: %6.1f°C   Right: %6.1f°C                       ║\n", 
            config.left_temp, config.right_temp);
+    printf("║   Types: top %s, bottom %s, left %s, right %s\n",
+           heat_bc_name(config.bc_type[HEAT_EDGE_TOP]), heat_bc_name(config.bc_type[HEAT_EDGE_BOTTOM]),
+           config.axisymmetric ? "axis" : heat_bc_name(config.bc_type[HEAT_EDGE_LEFT]),
+           heat_bc_name(config.bc_type[HEAT_EDGE_RIGHT]));
     printf("╚══════════════════════════════════════════════════════════════╝\n");
     printf("\n");
 }
 
-// Memory allocation with error checking
+// Memory allocation with error checking. Rows point into one contiguous
+// block so array[0] can be handed to libheat as a row-major field.
 double **allocate_2d_array(int nx, int ny) {
     double **array = (double **)malloc(nx * sizeof(double *));
     if (array == NULL) {
@@ -82,29 +210,159 @@ double **allocate_2d_array(int nx, int ny) {
         exit(EXIT_FAILURE);
     }
     
-    for (int i = 0; i < nx; i++) {
-        array[i] = (double *)malloc(ny * sizeof(double));
-        if (array[i] == NULL) {
-            fprintf(stderr, "ERROR: Memory allocation failed for columns\n");
-            exit(EXIT_FAILURE);
-        }
+    array[0] = (double *)malloc((size_t)nx * ny * sizeof(double));
+    if (array[0] == NULL) {
+        fprintf(stderr, "ERROR: Memory allocation failed for columns\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 1; i < nx; i++) {
+        array[i] = array[0] + (size_t)i * ny;
     }
     return array;
 }
 
 void free_2d_array(double **array, int nx) {
+    (void)nx;
+    free(array[0]);
+    free(array);
+}
+
+// Row pointers into a memory-mapped file (out-of-core mode)
+double **map_2d_array(const char *path, int nx, int ny) {
+    double **array = (double **)malloc(nx * sizeof(double *));
+    if (array == NULL || heat_map_field(&mapped_field, path, nx, ny) != 0) {
+        fprintf(stderr, "ERROR: Cannot map %s for the temperature field\n", path);
+        exit(EXIT_FAILURE);
+    }
     for (int i = 0; i < nx; i++) {
-        free(array[i]);
+        array[i] = mapped_field.T + (size_t)i * ny;
+    }
+    return array;
+}
+
+// Sweeps over a mapped T (initialization, output, checkpoints) call this
+// after each row so every finished slab is written back and dropped from
+// the resident set; the last row releases the whole field. No-op in memory.
+static void release_slab(SimulationConfig config, int row_end) {
+    if (mapped_field.T == NULL) return;
+    if (row_end == config.nx) {
+        heat_release_rows(&mapped_field, 0, config.nx);
+    } else if (row_end % config.slab_rows == 0) {
+        heat_release_rows(&mapped_field, row_end - config.slab_rows, row_end);
     }
-    free(array);
 }
 
 // Validation function
 void validate_simulation(SimulationConfig config) {
     printf("Validating simulation parameters...\n");
     
-    // Check stability condition (CFL condition for 2D heat equation)
-    double stable_dt = 0.25 * fmin(config.dx * config.dx, config.dy * config.dy) / config.alpha;
+    // A periodic edge wraps onto the opposite one
+    if ((config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC) != (config.bc_type[HEAT_EDGE_BOTTOM] == HEAT_BC_PERIODIC) ||
+        (config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC) != (config.bc_type[HEAT_EDGE_RIGHT] == HEAT_BC_PERIODIC)) {
+        fprintf(stderr, "ERROR: Periodic boundaries must be set on both top and bottom, or both left and right\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    if (config.order != 2 && config.order != 4) {
+        fprintf(stderr, "ERROR: Stencil order must be 2 or 4 (got %d)\n", config.order);
+        exit(EXIT_FAILURE);
+    }
+    if (config.order == 4) {
+        for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+            if (config.bc_type[e] != HEAT_BC_DIRICHLET) {
+                fprintf(stderr, "ERROR: The 4th-order stencil needs Dirichlet boundaries (%s is %s)\n",
+                        heat_edge_name((heat_edge)e), heat_bc_name(config.bc_type[e]));
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (config.nx < 5 || config.ny < 5) {
+            fprintf(stderr, "ERROR: The 4th-order stencil needs at least a 5x5 grid\n");
+            exit(EXIT_FAILURE);
+        }
+        if (config.inplace || config.out_of_core) {
+            fprintf(stderr, "ERROR: In-place and out-of-core updates only support the 2nd-order stencil\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (config.mask_path && (config.order == 4 || config.inplace || config.out_of_core)) {
+        fprintf(stderr, "ERROR: Masks need the default two-buffer 2nd-order update (no --order 4, --inplace or --out-of-core)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config.materials_path && (config.mask_path || config.order == 4 || config.inplace || config.out_of_core)) {
+        fprintf(stderr, "ERROR: Materials need the default two-buffer 2nd-order update (no --mask, --order 4, --inplace or --out-of-core)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (stretched.x != NULL) {
+        if (config.mask_path || config.materials_path || config.order == 4 || config.inplace || config.out_of_core) {
+            fprintf(stderr, "ERROR: Stretched grids need the default two-buffer 2nd-order update (no --mask, --materials, --order 4, --inplace or --out-of-core)\n");
+            exit(EXIT_FAILURE);
+        }
+        if ((config.stretch[0].kind != HEAT_STRETCH_UNIFORM && config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC) ||
+            (config.stretch[1].kind != HEAT_STRETCH_UNIFORM && config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC)) {
+            fprintf(stderr, "ERROR: A stretched axis cannot have periodic edges\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (axisym.inner != NULL) {
+        if (config.mask_path || config.materials_path || stretched.x != NULL || config.order == 4 ||
+            config.inplace || config.out_of_core) {
+            fprintf(stderr, "ERROR: Axisymmetric runs need the default two-buffer 2nd-order update (no --mask, --materials, --stretch, --order 4, --inplace or --out-of-core)\n");
+            exit(EXIT_FAILURE);
+        }
+        if (config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC) {
+            fprintf(stderr, "ERROR: Axisymmetric runs cannot have periodic left/right edges (the left edge is the axis)\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    // Tile skipping freezes the unit-temperature basis runs below the
+    // threshold, which breaks the linearity superposition relies on
+    if (config.basis_cache && (config.mask_path || config.restart_path || config.out_of_core ||
+                               config.tile_threshold != 0.0)) {
+        fprintf(stderr, "ERROR: Superposition needs a zero start, no fixed cells and every tile updated (no --mask, --restart, --out-of-core or --tile-threshold)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config.serve_path && (config.mask_path || config.materials_path || stretched.x != NULL ||
+                              axisym.inner != NULL || config.out_of_core || config.basis_cache ||
+                              config.restart_path || config.jit)) {
+        fprintf(stderr, "ERROR: The daemon serves plain rectangular runs (no --mask, --materials, --stretch, --axisymmetric, --out-of-core, --superpose, --restart or --jit)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config.memo_dir && (config.serve_path || config.basis_cache)) {
+        fprintf(stderr, "ERROR: The result memo applies to stepped runs (no --serve or --superpose)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config.memo_dir && config.memo_mb < 0) {
+        fprintf(stderr, "ERROR: The memo size must not be negative (got %d MB)\n", config.memo_mb);
+        exit(EXIT_FAILURE);
+    }
+    if (config.serve_path && config.cache_mb < 0) {
+        fprintf(stderr, "ERROR: The result cache size must not be negative (got %d MB)\n", config.cache_mb);
+        exit(EXIT_FAILURE);
+    }
+    if (config.queries_path && !config.basis_cache) {
+        fprintf(stderr, "ERROR: --queries are answered from a basis cache (add --superpose FILE)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config.time_block < 1 || config.slab_rows < 1) {
+        fprintf(stderr, "ERROR: The time block and slab size must be at least 1 (got %d, %d)\n",
+                config.time_block, config.slab_rows);
+        exit(EXIT_FAILURE);
+    }
+    
+    // Check stability condition (CFL condition for 2D heat equation). The
+    // wide cross has a larger spectral radius: 3/8 of the 5-point limit
+    // per unit of 1/dx^2 + 1/dy^2 instead of 1/2. With materials the most
+    // diffusive one sets the limit.
+    double alpha = materials.kind != NULL ? materials.alpha_max : config.alpha;
+    double stable_dt = (config.order == 4 ? 0.1875 : 0.25) * fmin(config.dx * config.dx, config.dy * config.dy) / alpha;
+    if (stretched.x != NULL) {
+        // The smallest cells set the limit
+        stable_dt = heat_stretched_stable_dt(&stretched, config.alpha);
+    } else if (axisym.inner != NULL) {
+        // The axis cell sees the radial term twice
+        heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+        stable_dt = heat_axisym_stable_dt(&grid);
+    }
     
     if (config.dt > stable_dt) {
         printf("⚠️  WARNING: Time step may be unstable!\n");
@@ -124,13 +382,21 @@ void validate_simulation(SimulationConfig config) {
     }
     
     // Check memory requirements
-    size_t memory_mb = config.nx * config.ny * sizeof(double) / (1024 * 1024);
-    printf("✓ Estimated memory: %zu MB\n\n", memory_mb);
+    size_t memory_mb = (size_t)config.nx * config.ny * sizeof(double) / (1024 * 1024);
+    if (config.out_of_core) {
+        // Rings of 3 rows per step in the block, plus two slabs of the mapping
+        size_t window_rows = 3 * (size_t)config.time_block + 2 + 2 * (size_t)config.slab_rows;
+        printf("✓ Estimated memory: %.1f MB window (%zu MB on disk)\n\n",
+               window_rows * config.ny * sizeof(double) / (1024.0 * 1024.0), memory_mb);
+    } else {
+        printf("✓ Estimated memory: %zu MB\n\n", memory_mb);
+    }
 }
 
 // Initialize temperature field
 void initialize(double **T, SimulationConfig config) {
-    for (int i = 0; i < config.nx; i++) {
+    // A freshly mapped file is already zero-filled
+    for (int i = 0; i < config.nx && mapped_field.T == NULL; i++) {
         for (int j = 0; j < config.ny; j++) {
             T[i][j] = 0.0;
         }
@@ -142,54 +408,207 @@ void initialize(double **T, SimulationConfig config) {
         T[config.nx-1][j] = config.bottom_temp;
     }
     for (int i = 0; i < config.nx; i++) {
-        T[i][0] = config.left_temp;
+        // On the axis column 0 is an interior node
+        if (axisym.inner == NULL) T[i][0] = config.left_temp;
         T[i][config.ny-1] = config.right_temp;
+        release_slab(config, i + 1);
+    }
+}
+
+// Boundary condition of one edge; the edge temperature is the Dirichlet
+// value or the Robin ambient temperature
+static heat_bc edge_bc(SimulationConfig config, heat_edge edge) {
+    double temps[HEAT_EDGE_COUNT] = {config.top_temp, config.bottom_temp, config.left_temp, config.right_temp};
+    heat_bc bc = {config.bc_type[edge], temps[edge], config.bc_param[edge]};
+    if (bc.type == HEAT_BC_NEUMANN) bc.value = config.bc_param[edge];
+    return bc;
+}
+
+// Fill the ghost ring of T from its interior, once per step. Columns go
+// last so the corners keep the left/right values. Columns are filled a
+// slab at a time for out-of-core fields. An axisymmetric run updates
+// column 0 (the axis) with the interior instead.
+void apply_boundaries(double **T, SimulationConfig config) {
+    heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+    heat_bc bc[HEAT_EDGE_COUNT];
+    for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+        bc[e] = edge_bc(config, (heat_edge)e);
+    }
+    if (stretched.x != NULL) {
+        heat_stretched_fill_edge(&stretched, &grid, T[0], HEAT_EDGE_TOP, &bc[HEAT_EDGE_TOP], 0, config.ny);
+        heat_stretched_fill_edge(&stretched, &grid, T[0], HEAT_EDGE_BOTTOM, &bc[HEAT_EDGE_BOTTOM], 0, config.ny);
+        heat_stretched_fill_edge(&stretched, &grid, T[0], HEAT_EDGE_LEFT, &bc[HEAT_EDGE_LEFT], 0, config.nx);
+        heat_stretched_fill_edge(&stretched, &grid, T[0], HEAT_EDGE_RIGHT, &bc[HEAT_EDGE_RIGHT], 0, config.nx);
+        return;
+    }
+    heat_fill_edge(&grid, T[0], HEAT_EDGE_TOP, &bc[HEAT_EDGE_TOP], 0, config.ny);
+    heat_fill_edge(&grid, T[0], HEAT_EDGE_BOTTOM, &bc[HEAT_EDGE_BOTTOM], 0, config.ny);
+    for (int i = 0; i < config.nx; i += config.slab_rows) {
+        int end = i + config.slab_rows < config.nx ? i + config.slab_rows : config.nx;
+        if (axisym.inner == NULL) heat_fill_edge(&grid, T[0], HEAT_EDGE_LEFT, &bc[HEAT_EDGE_LEFT], i, end);
+        heat_fill_edge(&grid, T[0], HEAT_EDGE_RIGHT, &bc[HEAT_EDGE_RIGHT], i, end);
+        release_slab(config, end);
     }
 }
 
-// Update temperature using finite differences
-void update_temperature(double **T, double **T_new, SimulationConfig config) {
-    double dx2 = config.dx * config.dx;
-    double dy2 = config.dy * config.dy;
-    double factor = config.alpha * config.dt;
+// Tile grid over the interior; every tile starts active
+void tiles_init(TileTracker *tiles, SimulationConfig config) {
+    tiles->rows = (config.nx - 2 + TILE_SIZE - 1) / TILE_SIZE;
+    tiles->cols = (config.ny - 2 + TILE_SIZE - 1) / TILE_SIZE;
+    int count = tiles->rows * tiles->cols;
+    tiles->max_change = (double *)calloc(count, sizeof(double));
+    tiles->quiet_steps = (int *)calloc(count, sizeof(int));
+    tiles->active = (unsigned char *)malloc(count);
+    tiles->active_list = (int *)malloc(count * sizeof(int));
+    if (!tiles->max_change || !tiles->quiet_steps || !tiles->active || !tiles->active_list) {
+        fprintf(stderr, "Error: Tile tracker allocation failed\n");
+        exit(1);
+    }
+    for (int t = 0; t < count; t++) {
+        tiles->active[t] = 1;
+        tiles->active_list[t] = t;
+    }
+    tiles->active_count = count;
+    tiles->cell_updates = 0;
+    tiles->skipped_updates = 0;
+}
+
+void tiles_free(TileTracker *tiles) {
+    free(tiles->max_change);
+    free(tiles->quiet_steps);
+    free(tiles->active);
+    free(tiles->active_list);
+}
+
+// Update temperature using finite differences, active tiles only. In
+// place (T_new NULL) the whole interior is swept, since a skipped tile
+// relies on both time levels; tile 0 then carries the step's max |dT|.
+void update_temperature(double **T, double **T_new, SimulationConfig config, TileTracker *tiles,
+                        const heat_backend *backend) {
+    heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+    if (T_new == NULL) {
+        tiles->max_change[0] = heat_step_inplace(backend, &grid, T[0], heat_interior(&grid));
+        return;
+    }
     
-    for (int i = 1; i < config.nx-1; i++) {
-        for (int j = 1; j < config.ny-1; j++) {
-            double d2T_dx2 = (T[i+1][j] - 2*T[i][j] + T[i-1][j]) / dx2;
-            double d2T_dy2 = (T[i][j+1] - 2*T[i][j] + T[i][j-1]) / dy2;
-            
-            T_new[i][j] = T[i][j] + factor * (d2T_dx2 + d2T_dy2);
+    for (int n = 0; n < tiles->active_count; n++) {
+        int t = tiles->active_list[n];
+        int i0 = 1 + (t / tiles->cols) * TILE_SIZE;
+        int j0 = 1 + (t % tiles->cols) * TILE_SIZE;
+        int i1 = i0 + TILE_SIZE < config.nx - 1 ? i0 + TILE_SIZE : config.nx - 1;
+        int j1 = j0 + TILE_SIZE < config.ny - 1 ? j0 + TILE_SIZE : config.ny - 1;
+        heat_region tile = {i0, i1, j0, j1};
+        
+        if (mask.kind != NULL) {
+            tiles->max_change[t] = heat_mask_step(&mask, 0, &grid, T[0], T_new[0], tile);
+        } else if (materials.kind != NULL) {
+            tiles->max_change[t] = heat_materials_step(&materials, 0, &grid, T[0], T_new[0], tile);
+        } else if (stretched.x != NULL) {
+            tiles->max_change[t] = heat_stretched_step(&stretched, &grid, T[0], T_new[0], tile);
+        } else if (axisym.inner != NULL) {
+            // Tiles in the first column also update the axis
+            tiles->max_change[t] = heat_axisym_step(&axisym, &grid, T[0], T_new[0], tile);
+        } else if (config.order == 4) {
+            // Tiles touching the ghost ring use the Dirichlet closure there
+            unsigned edges = (i0 == 1 ? HEAT_EDGE_BIT(HEAT_EDGE_TOP) : 0) |
+                             (i1 == config.nx - 1 ? HEAT_EDGE_BIT(HEAT_EDGE_BOTTOM) : 0) |
+                             (j0 == 1 ? HEAT_EDGE_BIT(HEAT_EDGE_LEFT) : 0) |
+                             (j1 == config.ny - 1 ? HEAT_EDGE_BIT(HEAT_EDGE_RIGHT) : 0);
+            tiles->max_change[t] = heat_step4(&grid, T[0], T_new[0], tile, edges);
+        } else {
+            tiles->max_change[t] = backend->step(&grid, T[0], T_new[0], tile);
         }
+        tiles->cell_updates += (long long)(i1 - i0) * (j1 - j0);
     }
+    tiles->skipped_updates += (long long)(config.nx - 2) * (config.ny - 2) - tiles->cell_updates;
+    tiles->cell_updates = 0;
+}
+
+// Rebuild the active-tile list after a step (before the pointer swap).
+// A tile wakes up as soon as it or a face neighbour changed above the
+// threshold; changes travel one cell per step (two with the 4th-order
+// stencil), so a woken tile is never late. Periodic edges make tiles on
+// opposite sides neighbours. A tile going to sleep copies its new values
+// into the other buffer so both time levels agree while it is skipped.
+void update_tile_activity(double **T, double **T_new, SimulationConfig config, TileTracker *tiles) {
+    int count = tiles->rows * tiles->cols;
+    int wrap_rows = config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC;
+    int wrap_cols = config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC;
+    tiles->active_count = 0;
     
-    // Apply boundary conditions (keep constant)
-    for (int j = 0; j < config.ny; j++) {
-        T_new[0][j] = config.top_temp;
-        T_new[config.nx-1][j] = config.bottom_temp;
+    for (int t = 0; t < count; t++) {
+        int ti = t / tiles->cols, tj = t % tiles->cols;
+        double nearby = tiles->max_change[t];
+        if (ti > 0) nearby = fmax(nearby, tiles->max_change[t - tiles->cols]);
+        if (ti < tiles->rows - 1) nearby = fmax(nearby, tiles->max_change[t + tiles->cols]);
+        if (tj > 0) nearby = fmax(nearby, tiles->max_change[t - 1]);
+        if (tj < tiles->cols - 1) nearby = fmax(nearby, tiles->max_change[t + 1]);
+        if (wrap_rows && (ti == 0 || ti == tiles->rows - 1)) {
+            nearby = fmax(nearby, tiles->max_change[(tiles->rows - 1 - ti) * tiles->cols + tj]);
+        }
+        if (wrap_cols && (tj == 0 || tj == tiles->cols - 1)) {
+            nearby = fmax(nearby, tiles->max_change[ti * tiles->cols + tiles->cols - 1 - tj]);
+        }
+        
+        if (nearby > config.tile_threshold) {
+            tiles->quiet_steps[t] = 0;
+        } else if (tiles->active[t]) {
+            tiles->quiet_steps[t]++;
+        }
+        
+        int was_active = tiles->active[t];
+        tiles->active[t] = tiles->quiet_steps[t] < TILE_IDLE_STEPS;
+        if (tiles->active[t]) {
+            tiles->active_list[tiles->active_count++] = t;
+        } else if (was_active) {
+            int i0 = 1 + ti * TILE_SIZE;
+            int j0 = 1 + tj * TILE_SIZE;
+            int i1 = i0 + TILE_SIZE < config.nx - 1 ? i0 + TILE_SIZE : config.nx - 1;
+            int j1 = j0 + TILE_SIZE < config.ny - 1 ? j0 + TILE_SIZE : config.ny - 1;
+            for (int i = i0; i < i1; i++) {
+                memcpy(&T[i][j0], &T_new[i][j0], (j1 - j0) * sizeof(double));
+            }
+        }
     }
-    for (int i = 0; i < config.nx; i++) {
-        T_new[i][0] = config.left_temp;
-        T_new[i][config.ny-1] = config.right_temp;
+}
+
+// Steps for the next out-of-core pass: the time block, cut short so a
+// pass ends on every step that is saved, checkpointed or has its
+// residual taken
+static int stream_block(SimulationConfig config, int step) {
+    int block = config.steps - step < config.time_block ? config.steps - step : config.time_block;
+    int stops[3] = {config.output_interval, 100, config.checkpoint_interval};
+    for (int k = 0; k < 3; k++) {
+        if (stops[k] > 0 && stops[k] - step % stops[k] < block) {
+            block = stops[k] - step % stops[k];
+        }
     }
+    return block;
 }
 
-// Calculate residual for convergence monitoring
-double calculate_residual(double **T, SimulationConfig config) {
-    double max_residual = 0.0;
-    double dx2 = config.dx * config.dx;
-    double dy2 = config.dy * config.dy;
-    
-    for (int i = 1; i < config.nx-1; i++) {
-        for (int j = 1; j < config.ny-1; j++) {
-            double laplacian = (T[i+1][j] - 2*T[i][j] + T[i-1][j]) / dx2 +
-                             (T[i][j+1] - 2*T[i][j] + T[i][j-1]) / dy2;
-            double residual = fabs(laplacian);
-            if (residual > max_residual) {
-                max_residual = residual;
-            }
+// Residual (max |Laplacian| of the last step) from the tile-level maxima
+// of |dT| = alpha * dt * |Laplacian|; skipped tiles are below threshold
+double calculate_residual(const TileTracker *tiles, SimulationConfig config) {
+    double max_change = 0.0;
+    for (int t = 0; t < tiles->rows * tiles->cols; t++) {
+        if (tiles->max_change[t] > max_change) {
+            max_change = tiles->max_change[t];
         }
     }
-    return max_residual;
+    return max_change / (config.alpha * config.dt);
+}
+
+// Node coordinates of a stretched grid, one per line, for the plots
+static void write_coordinates(const char *filename, const double *coord, int n) {
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "ERROR: Cannot open file %s for writing\n", filename);
+        return;
+    }
+    for (int k = 0; k < n; k++) {
+        fprintf(fp, "%.9g\n", coord[k]);
+    }
+    fclose(fp);
 }
 
 // Save temperature field to file
@@ -200,16 +619,1116 @@ void save_to_file(double **T, SimulationConfig config, const char* filename) {
         return;
     }
     
+    heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
     for (int i = 0; i < config.nx; i++) {
-        for (int j = 0; j < config.ny; j++) {
-            fprintf(fp, "%.6f ", T[i][j]);
+        heat_write_rows(&grid, T[0], i, i + 1, fp);
+        release_slab(config, i + 1);
+    }
+    fclose(fp);
+}
+
+// Checkpoint header for T after `step` steps of this configuration
+static void fill_checkpoint_header(heat_checkpoint_header *header, SimulationConfig config, int step) {
+    heat_checkpoint_init(header);
+    header->step = step;
+    header->nx = config.nx;
+    header->ny = config.ny;
+    header->steps = config.steps;
+    header->output_interval = config.output_interval;
+    header->alpha = config.alpha;
+    header->dx = config.dx;
+    header->dy = config.dy;
+    header->dt = config.dt;
+    header->top_temp = config.top_temp;
+    header->bottom_temp = config.bottom_temp;
+    header->left_temp = config.left_temp;
+    header->right_temp = config.right_temp;
+}
+
+// Checkpoint header and T after `step` steps; 1 if every write succeeded.
+// `checksum`, if given, receives heat_hash of all bytes written.
+static int write_state(FILE *fp, double **T, SimulationConfig config, int step, unsigned long long *checksum) {
+    heat_checkpoint_header header;
+    fill_checkpoint_header(&header, config, step);
+    unsigned long long hash = heat_hash(HEAT_HASH_INIT, &header, sizeof(header));
+    
+    int ok = heat_checkpoint_save_header(fp, &header) == 0;
+    for (int i = 0; i < config.nx && ok; i++) {
+        ok = fwrite(T[i], sizeof(double), config.ny, fp) == (size_t)config.ny;
+        if (checksum != NULL) hash = heat_hash(hash, T[i], config.ny * sizeof(double));
+        release_slab(config, i + 1);
+    }
+    if (checksum != NULL) *checksum = hash;
+    return ok;
+}
+
+// Write T and the run configuration, replacing the previous checkpoint atomically
+void write_checkpoint(double **T, SimulationConfig config, int step) {
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", config.checkpoint_path);
+    
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "ERROR: Cannot open file %s for writing\n", tmp_path);
+        return;
+    }
+    
+    int ok = write_state(fp, T, config, step, NULL);
+    ok = (fclose(fp) == 0) && ok;
+    
+    if (!ok || rename(tmp_path, config.checkpoint_path) != 0) {
+        fprintf(stderr, "ERROR: Failed to write checkpoint %s\n", config.checkpoint_path);
+    }
+}
+
+// Restore the configuration stored in a checkpoint; returns the completed step count
+int load_checkpoint_header(SimulationConfig *config) {
+    FILE *fp = fopen(config->restart_path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "ERROR: Cannot open checkpoint %s\n", config->restart_path);
+        exit(EXIT_FAILURE);
+    }
+    
+    heat_checkpoint_header header;
+    int ok = heat_checkpoint_load_header(fp, &header) == 0 &&
+             fseek(fp, 0, SEEK_END) == 0 && ftell(fp) == (long)heat_checkpoint_bytes(&header);
+    fclose(fp);
+    if (!ok) {
+        fprintf(stderr, "ERROR: %s is not a valid checkpoint\n", config->restart_path);
+        exit(EXIT_FAILURE);
+    }
+    
+    config->nx = header.nx;
+    config->ny = header.ny;
+    config->steps = header.steps;
+    config->output_interval = header.output_interval;
+    config->alpha = header.alpha;
+    config->dx = header.dx;
+    config->dy = header.dy;
+    config->dt = header.dt;
+    config->top_temp = header.top_temp;
+    config->bottom_temp = header.bottom_temp;
+    config->left_temp = header.left_temp;
+    config->right_temp = header.right_temp;
+    return header.step;
+}
+
+void load_checkpoint_data(double **T, SimulationConfig config) {
+    FILE *fp = fopen(config.restart_path, "rb");
+    int ok = fp != NULL && fseek(fp, (long)sizeof(heat_checkpoint_header), SEEK_SET) == 0;
+    for (int i = 0; i < config.nx && ok; i++) {
+        ok = fread(T[i], sizeof(double), config.ny, fp) == (size_t)config.ny;
+        release_slab(config, i + 1);
+    }
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    if (!ok) {
+        fprintf(stderr, "ERROR: Failed to read checkpoint data from %s\n", config.restart_path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Command-line options. The config file and --set overrides are applied
+// first, so the dedicated options below take precedence over them.
+void parse_args(int argc, char **argv, SimulationConfig *config) {
+    static heat_config file_cfg, set_cfg;   // strings stay referenced by config
+    const char *path = NULL;
+    for (int a = 1; a + 1 < argc; a++) {
+        if (strcmp(argv[a], "--config") == 0) {
+            path = argv[++a];
+        } else if (strcmp(argv[a], "--set") == 0 && heat_config_set(&set_cfg, argv[++a]) != 0) {
+            fprintf(stderr, "ERROR: --set: %s\n", set_cfg.error);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (heat_config_load(&file_cfg, path ? path : CONFIG_FILE) == 0) {
+        printf("Configuration: %s\n", path ? path : CONFIG_FILE);
+    } else if (path != NULL || access(CONFIG_FILE, F_OK) == 0) {
+        fprintf(stderr, "ERROR: %s\n", file_cfg.error);
+        exit(EXIT_FAILURE);
+    } else {
+        file_cfg.count = 0;
+    }
+    if (apply_config(config, &file_cfg) != 0 || apply_config(config, &set_cfg) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    heat_config_warn_unused(&file_cfg, "simulation.", stderr);
+    heat_config_warn_unused(&file_cfg, "boundary_conditions.", stderr);
+    heat_config_warn_unused(&file_cfg, "solver.", stderr);
+    for (int e = 0; e < set_cfg.count; e++) {
+        if (!set_cfg.entries[e].used) {
+            fprintf(stderr, "ERROR: --set: unknown key %s\n", set_cfg.entries[e].key);
+            exit(EXIT_FAILURE);
         }
-        fprintf(fp, "\n");
+    }
+    
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--checkpoint-interval") == 0 && a + 1 < argc) {
+            config->checkpoint_interval = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--checkpoint") == 0 && a + 1 < argc) {
+            config->checkpoint_path = argv[++a];
+        } else if (strcmp(argv[a], "--restart") == 0 && a + 1 < argc) {
+            config->restart_path = argv[++a];
+        } else if (strcmp(argv[a], "--tile-threshold") == 0 && a + 1 < argc) {
+            config->tile_threshold = atof(argv[++a]);
+        } else if (strcmp(argv[a], "--backend") == 0 && a + 1 < argc) {
+            config->backend_name = argv[++a];
+        } else if (strcmp(argv[a], "--jit") == 0) {
+            config->jit = 1;
+        } else if (strcmp(argv[a], "--order") == 0 && a + 1 < argc) {
+            config->order = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--inplace") == 0) {
+            config->inplace = 1;
+        } else if (strcmp(argv[a], "--out-of-core") == 0 && a + 1 < argc) {
+            config->out_of_core = argv[++a];
+        } else if (strcmp(argv[a], "--time-block") == 0 && a + 1 < argc) {
+            config->time_block = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--slab-rows") == 0 && a + 1 < argc) {
+            config->slab_rows = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--mask") == 0 && a + 1 < argc) {
+            config->mask_path = argv[++a];
+        } else if (strcmp(argv[a], "--materials") == 0 && a + 1 < argc) {
+            config->materials_path = argv[++a];
+        } else if (strcmp(argv[a], "--float-coeffs") == 0) {
+            config->float_coeffs = 1;
+        } else if (strcmp(argv[a], "--axisymmetric") == 0) {
+            config->axisymmetric = 1;
+        } else if (strcmp(argv[a], "--superpose") == 0 && a + 1 < argc) {
+            config->basis_cache = argv[++a];
+        } else if (strcmp(argv[a], "--queries") == 0 && a + 1 < argc) {
+            config->queries_path = argv[++a];
+        } else if (strcmp(argv[a], "--serve") == 0 && a + 1 < argc) {
+            config->serve_path = argv[++a];
+        } else if (strcmp(argv[a], "--cache-mb") == 0 && a + 1 < argc) {
+            config->cache_mb = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--memo") == 0 && a + 1 < argc) {
+            config->memo_dir = argv[++a];
+        } else if (strcmp(argv[a], "--memo-mb") == 0 && a + 1 < argc) {
+            config->memo_mb = atoi(argv[++a]);
+        } else if ((strcmp(argv[a], "--config") == 0 || strcmp(argv[a], "--set") == 0) && a + 1 < argc) {
+            a++;    // handled before the other options
+        } else if (strcmp(argv[a], "--bc") == 0 && a + 1 < argc) {
+            heat_edge edge;
+            heat_bc_type type;
+            double param;
+            if (heat_parse_bc(argv[++a], &edge, &type, &param) != 0) {
+                fprintf(stderr, "ERROR: Bad boundary spec %s (expected EDGE=TYPE[:PARAM], e.g. left=robin:5)\n", argv[a]);
+                exit(EXIT_FAILURE);
+            }
+            config->bc_type[edge] = type;
+            config->bc_param[edge] = param;
+        } else if (strcmp(argv[a], "--stretch") == 0 && a + 1 < argc) {
+            int axis;
+            heat_stretch stretch;
+            if (heat_parse_stretch(argv[++a], &axis, &stretch) != 0) {
+                fprintf(stderr, "ERROR: Bad stretch spec %s (expected AXIS=KIND[:PARAM[:SIDE]], e.g. x=tanh:2.5)\n", argv[a]);
+                exit(EXIT_FAILURE);
+            }
+            config->stretch[axis] = stretch;
+        } else {
+            fprintf(stderr, "ERROR: Unknown or incomplete option %s\n", argv[a]);
+            fprintf(stderr, "Usage: %s [--checkpoint-interval N] [--checkpoint FILE] [--restart FILE] [--tile-threshold DT] [--backend NAME] [--jit]\n"
+                    "       [--order 2|4] [--inplace] [--out-of-core FILE [--time-block K] [--slab-rows N]]\n"
+                    "       [--mask FILE] [--materials FILE [--float-coeffs]] [--stretch AXIS=KIND[:PARAM[:SIDE]]]...\n"
+                    "       [--axisymmetric] [--superpose CACHE [--queries FILE]] [--bc EDGE=TYPE[:PARAM]]...\n"
+                    "       [--serve SOCKET [--cache-mb N]] [--memo DIR [--memo-mb N]] [--config FILE] [--set KEY=VALUE]...\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Apply the keys present in `cfg` (named after the config.json layout,
+// e.g. simulation.nx or boundary_conditions.top_bc). -1 on a bad value.
+int apply_config(SimulationConfig *config, heat_config *cfg) {
+    const struct { const char *key; int *value; } ints[] = {
+        {"simulation.nx", &config->nx}, {"simulation.ny", &config->ny},
+        {"simulation.steps", &config->steps}, {"simulation.output_interval", &config->output_interval},
+        {"solver.order", &config->order}, {"solver.time_block", &config->time_block},
+        {"solver.slab_rows", &config->slab_rows}, {"solver.memo_mb", &config->memo_mb}
+    };
+    const struct { const char *key; double *value; } doubles[] = {
+        {"simulation.alpha", &config->alpha}, {"simulation.dx", &config->dx},
+        {"simulation.dy", &config->dy}, {"simulation.dt", &config->dt},
+        {"boundary_conditions.top_temp", &config->top_temp},
+        {"boundary_conditions.bottom_temp", &config->bottom_temp},
+        {"boundary_conditions.left_temp", &config->left_temp},
+        {"boundary_conditions.right_temp", &config->right_temp},
+        {"solver.tile_threshold", &config->tile_threshold}
+    };
+    int status = 0;
+    for (size_t k = 0; k < sizeof(ints) / sizeof(ints[0]); k++) {
+        if (heat_config_int(cfg, ints[k].key, ints[k].value) < 0) {
+            fprintf(stderr, "ERROR: %s must be an integer\n", ints[k].key);
+            status = -1;
+        }
+    }
+    for (size_t k = 0; k < sizeof(doubles) / sizeof(doubles[0]); k++) {
+        if (heat_config_double(cfg, doubles[k].key, doubles[k].value) < 0) {
+            fprintf(stderr, "ERROR: %s must be a number\n", doubles[k].key);
+            status = -1;
+        }
+    }
+    if (heat_config_bool(cfg, "solver.jit", &config->jit) < 0) {
+        fprintf(stderr, "ERROR: solver.jit must be true or false\n");
+        status = -1;
+    }
+    if (heat_config_bool(cfg, "solver.inplace", &config->inplace) < 0) {
+        fprintf(stderr, "ERROR: solver.inplace must be true or false\n");
+        status = -1;
+    }
+    if (heat_config_bool(cfg, "solver.float_coeffs", &config->float_coeffs) < 0) {
+        fprintf(stderr, "ERROR: solver.float_coeffs must be true or false\n");
+        status = -1;
+    }
+    if (heat_config_bool(cfg, "solver.axisymmetric", &config->axisymmetric) < 0) {
+        fprintf(stderr, "ERROR: solver.axisymmetric must be true or false\n");
+        status = -1;
+    }
+    const char *backend = heat_config_get(cfg, "solver.backend");
+    if (backend != NULL) {
+        config->backend_name = backend;
+    }
+    const char *mask_path = heat_config_get(cfg, "solver.mask");
+    if (mask_path != NULL) {
+        config->mask_path = mask_path[0] ? mask_path : NULL;
+    }
+    const char *materials_path = heat_config_get(cfg, "solver.materials");
+    if (materials_path != NULL) {
+        config->materials_path = materials_path[0] ? materials_path : NULL;
+    }
+    const char *out_of_core = heat_config_get(cfg, "solver.out_of_core");
+    if (out_of_core != NULL) {
+        config->out_of_core = out_of_core[0] ? out_of_core : NULL;
+    }
+    const char *basis_cache = heat_config_get(cfg, "solver.basis_cache");
+    if (basis_cache != NULL) {
+        config->basis_cache = basis_cache[0] ? basis_cache : NULL;
+    }
+    const char *memo_dir = heat_config_get(cfg, "solver.memo_dir");
+    if (memo_dir != NULL) {
+        config->memo_dir = memo_dir[0] ? memo_dir : NULL;
+    }
+    
+    // Same specs as --stretch, e.g. "stretch_x": "tanh:2.5"
+    for (int axis = 0; axis < 2; axis++) {
+        char key[32], spec[HEAT_CONFIG_VALUE_MAX + 8];
+        snprintf(key, sizeof(key), "solver.stretch_%c", "xy"[axis]);
+        const char *value = heat_config_get(cfg, key);
+        if (value == NULL) continue;
+        int parsed;
+        snprintf(spec, sizeof(spec), "%c=%s", "xy"[axis], value);
+        if (heat_parse_stretch(spec, &parsed, &config->stretch[axis]) != 0) {
+            fprintf(stderr, "ERROR: %s: bad stretch '%s'\n", key, value);
+            status = -1;
+        }
+    }
+    
+    // Same specs as --bc, e.g. "left_bc": "robin:5"
+    for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+        char key[64], spec[HEAT_CONFIG_VALUE_MAX + 16];
+        snprintf(key, sizeof(key), "boundary_conditions.%s_bc", heat_edge_name((heat_edge)e));
+        const char *value = heat_config_get(cfg, key);
+        if (value == NULL) continue;
+        heat_edge edge;
+        snprintf(spec, sizeof(spec), "%s=%s", heat_edge_name((heat_edge)e), value);
+        if (heat_parse_bc(spec, &edge, &config->bc_type[e], &config->bc_param[e]) != 0) {
+            fprintf(stderr, "ERROR: %s: bad boundary type '%s'\n", key, value);
+            status = -1;
+        }
+    }
+    return status;
+}
+
+// Hash of everything a run's trajectory depends on except the step
+// count. The backend and output interval do not change the field and are
+// left out. In-place and out-of-core updates do change it once tiles are
+// skipped, since they sweep every tile: the threshold that actually takes
+// effect is hashed, 0 for them, so they share keys with two-buffer runs
+// at threshold 0 only. Parameters a boundary type ignores are zeroed and
+// -0.0 is folded into 0.0, so equivalent runs share a key.
+static unsigned long long trajectory_key(SimulationConfig config) {
+    double temps[HEAT_EDGE_COUNT] = {config.top_temp, config.bottom_temp, config.left_temp, config.right_temp};
+    double params[HEAT_EDGE_COUNT];
+    for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+        heat_bc_type type = config.bc_type[e];
+        int has_temp = (type == HEAT_BC_DIRICHLET || type == HEAT_BC_ROBIN) &&
+                       !(config.axisymmetric && e == HEAT_EDGE_LEFT);
+        params[e] = type == HEAT_BC_NEUMANN || type == HEAT_BC_ROBIN ? config.bc_param[e] + 0.0 : 0.0;
+        temps[e] = has_temp ? temps[e] + 0.0 : 0.0;
+    }
+    int ints[] = {config.nx, config.ny, config.order, config.axisymmetric, config.float_coeffs,
+                  config.bc_type[0], config.bc_type[1], config.bc_type[2], config.bc_type[3]};
+    double threshold = config.inplace || config.out_of_core ? 0.0 : config.tile_threshold + 0.0;
+    double doubles[] = {config.alpha + 0.0, config.dx + 0.0, config.dy + 0.0, config.dt + 0.0, threshold};
+    unsigned long long key = heat_hash(HEAT_HASH_INIT, ints, sizeof(ints));
+    key = heat_hash(key, doubles, sizeof(doubles));
+    key = heat_hash(key, temps, sizeof(temps));
+    key = heat_hash(key, params, sizeof(params));
+    for (int axis = 0; axis < 2; axis++) {
+        int kind[2] = {config.stretch[axis].kind, config.stretch[axis].side};
+        double param = config.stretch[axis].kind == HEAT_STRETCH_UNIFORM ? 0.0 : config.stretch[axis].param + 0.0;
+        key = heat_hash(key, kind, sizeof(kind));
+        key = heat_hash(key, &param, sizeof(param));
+    }
+    const char *maps[2] = {config.mask_path, config.materials_path};
+    for (int k = 0; k < 2; k++) {
+        char *text = maps[k] ? heat_mask_read(maps[k]) : NULL;
+        key = heat_hash(key, "|", 1);
+        if (text != NULL) key = heat_hash(key, text, strlen(text));
+        free(text);
+    }
+    return key;
+}
+
+// One stored state of the memo
+typedef struct {
+    char name[64];
+    unsigned long long key, checksum;
+    int step;
+    time_t used;                // modification time, refreshed on every hit
+    off_t bytes;
+} MemoEntry;
+
+// The memo files in config.memo_dir (all keys); NULL with *count 0 if none
+static MemoEntry *memo_scan(SimulationConfig config, int *count) {
+    *count = 0;
+    DIR *dir = opendir(config.memo_dir);
+    if (dir == NULL) return NULL;
+    MemoEntry *entries = NULL;
+    int capacity = 0;
+    struct dirent *file;
+    while ((file = readdir(dir)) != NULL) {
+        MemoEntry entry;
+        int length = 0;
+        if (sscanf(file->d_name, "%16llx-%10d-%16llx" MEMO_SUFFIX "%n", &entry.key, &entry.step,
+                   &entry.checksum, &length) != 3 || length == 0 || file->d_name[length] != '\0' ||
+            strlen(file->d_name) >= sizeof(entry.name)) {
+            continue;
+        }
+        char path[1024];
+        struct stat info;
+        snprintf(path, sizeof(path), "%s/%s", config.memo_dir, file->d_name);
+        if (stat(path, &info) != 0) continue;
+        strcpy(entry.name, file->d_name);
+        entry.used = info.st_mtime;
+        entry.bytes = info.st_size;
+        if (*count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            MemoEntry *grown = (MemoEntry *)realloc(entries, capacity * sizeof(MemoEntry));
+            if (grown == NULL) break;
+            entries = grown;
+        }
+        entries[(*count)++] = entry;
+    }
+    closedir(dir);
+    return entries;
+}
+
+static int by_step_descending(const void *a, const void *b) {
+    return ((const MemoEntry *)b)->step - ((const MemoEntry *)a)->step;
+}
+
+static int by_last_use(const void *a, const void *b) {
+    time_t ua = ((const MemoEntry *)a)->used, ub = ((const MemoEntry *)b)->used;
+    return (ua > ub) - (ua < ub);
+}
+
+// 1 if `path` is a complete checkpoint of this grid at entry->step whose
+// bytes hash to entry->checksum
+static int memo_verify(const char *path, SimulationConfig config, const MemoEntry *entry) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) return 0;
+    heat_checkpoint_header header;
+    int ok = heat_checkpoint_load_header(fp, &header) == 0 && header.step == entry->step &&
+             header.nx == config.nx && header.ny == config.ny &&
+             entry->bytes == (off_t)heat_checkpoint_bytes(&header);
+    unsigned long long hash = heat_hash(HEAT_HASH_INIT, &header, sizeof(header));
+    double row[1024];
+    size_t got;
+    while (ok && (got = fread(row, sizeof(double), 1024, fp)) > 0) {
+        hash = heat_hash(hash, row, got * sizeof(double));
     }
     fclose(fp);
+    return ok && hash == entry->checksum;
 }
 
-int main() {
+// Longest stored prefix of this run: the verified entry with the most
+// steps up to config.steps. Returns its step count and path, or -1.
+// Entries that fail verification are deleted.
+static int memo_lookup(SimulationConfig config, char *path, size_t size) {
+    int count;
+    MemoEntry *entries = memo_scan(config, &count);
+    unsigned long long key = trajectory_key(config);
+    qsort(entries, count, sizeof(MemoEntry), by_step_descending);
+    int found = -1;
+    for (int n = 0; n < count && found < 0; n++) {
+        if (entries[n].key != key || entries[n].step > config.steps) continue;
+        snprintf(path, size, "%s/%s", config.memo_dir, entries[n].name);
+        if (memo_verify(path, config, &entries[n])) {
+            found = entries[n].step;
+            utime(path, NULL);
+        } else {
+            fprintf(stderr, "WARNING: Memo entry %s is corrupt, removing it\n", path);
+            remove(path);
+        }
+    }
+    free(entries);
+    return found;
+}
+
+// Delete least recently used entries, never `keep`, until the store fits in memo_mb
+static void memo_evict(SimulationConfig config, const char *keep) {
+    int count;
+    MemoEntry *entries = memo_scan(config, &count);
+    qsort(entries, count, sizeof(MemoEntry), by_last_use);
+    double total = 0.0, limit = config.memo_mb * 1024.0 * 1024.0;
+    for (int n = 0; n < count; n++) {
+        total += entries[n].bytes;
+    }
+    int evicted = 0;
+    for (int n = 0; n < count && total > limit; n++) {
+        if (strcmp(entries[n].name, keep) == 0) continue;
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", config.memo_dir, entries[n].name);
+        if (remove(path) == 0) {
+            total -= entries[n].bytes;
+            evicted++;
+        }
+    }
+    if (evicted > 0) {
+        printf("\nMemo: evicted %d least recently used entries (%.1f MB left)\n", evicted, total / (1024.0 * 1024.0));
+    }
+    free(entries);
+}
+
+// Store T after `step` steps under this run's key, then trim the store
+static void memo_store(double **T, SimulationConfig config, int step) {
+    char tmp_path[1024], path[1024], name[64];
+    unsigned long long key = trajectory_key(config), checksum;
+    mkdir(config.memo_dir, 0755);
+    snprintf(tmp_path, sizeof(tmp_path), "%s/%016llx-%010d.tmp", config.memo_dir, key, step);
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "ERROR: Cannot open file %s for writing\n", tmp_path);
+        return;
+    }
+    int ok = write_state(fp, T, config, step, &checksum);
+    ok = (fclose(fp) == 0) && ok;
+    snprintf(name, sizeof(name), "%016llx-%010d-%016llx" MEMO_SUFFIX, key, step, checksum);
+    snprintf(path, sizeof(path), "%s/%s", config.memo_dir, name);
+    if (!ok || rename(tmp_path, path) != 0) {
+        fprintf(stderr, "ERROR: Failed to store memo entry %s\n", path);
+        remove(tmp_path);
+        return;
+    }
+    memo_evict(config, name);
+}
+
+// Cache key of a superposition basis: everything a run depends on apart
+// from the edge temperatures and the backend (which only moves rounding)
+static unsigned long long basis_key(SimulationConfig config) {
+    int ints[] = {config.nx, config.ny, config.steps, config.output_interval, config.order, config.axisymmetric,
+                  config.float_coeffs, config.bc_type[0], config.bc_type[1], config.bc_type[2], config.bc_type[3]};
+    double doubles[] = {config.alpha, config.dx, config.dy, config.dt, config.tile_threshold, config.bc_param[0],
+                        config.bc_param[1], config.bc_param[2], config.bc_param[3]};
+    unsigned long long key = heat_hash(HEAT_HASH_INIT, ints, sizeof(ints));
+    key = heat_hash(key, doubles, sizeof(doubles));
+    for (int axis = 0; axis < 2; axis++) {
+        int kind[2] = {config.stretch[axis].kind, config.stretch[axis].side};
+        key = heat_hash(key, kind, sizeof(kind));
+        key = heat_hash(key, &config.stretch[axis].param, sizeof(double));
+    }
+    if (config.materials_path != NULL) {
+        char *text = heat_mask_read(config.materials_path);
+        if (text != NULL) key = heat_hash(key, text, strlen(text));
+        free(text);
+    }
+    return key;
+}
+
+// One field per edge whose temperature enters the run (a Dirichlet value
+// or Robin ambient; not the axis), plus the fixed part for Neumann fluxes
+static int basis_sources(SimulationConfig config, int *source) {
+    int count = 0, fluxes = 0;
+    for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+        heat_bc_type type = config.bc_type[e];
+        if ((type == HEAT_BC_DIRICHLET || type == HEAT_BC_ROBIN) && !(config.axisymmetric && e == HEAT_EDGE_LEFT)) {
+            source[count++] = e;
+        }
+        fluxes = fluxes || (type == HEAT_BC_NEUMANN && config.bc_param[e] != 0.0);
+    }
+    if (fluxes || count == 0) source[count++] = HEAT_BASIS_FIXED;
+    return count;
+}
+
+// Step the run with edge `source` at 1 and every other temperature at 0
+// (the fixed part: all temperatures 0, fluxes as given), keeping each
+// snapshot a stepped run would write
+static void run_basis(SimulationConfig config, const heat_backend *backend, heat_basis *basis, int field) {
+    int source = basis->source[field];
+    double *temps[HEAT_EDGE_COUNT] = {&config.top_temp, &config.bottom_temp, &config.left_temp, &config.right_temp};
+    for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+        *temps[e] = e == source ? 1.0 : 0.0;
+        if (source != HEAT_BASIS_FIXED && config.bc_type[e] == HEAT_BC_NEUMANN) config.bc_param[e] = 0.0;
+    }
+
+    size_t bytes = (size_t)config.nx * config.ny * sizeof(double);
+    double **T = allocate_2d_array(config.nx, config.ny);
+    double **T_new = config.inplace ? NULL : allocate_2d_array(config.nx, config.ny);
+    TileTracker tiles;
+    tiles_init(&tiles, config);
+    initialize(T, config);
+    apply_boundaries(T, config);
+    int snapshot = 0;
+    memcpy(heat_basis_field(basis, snapshot++, field), T[0], bytes);
+    for (int step = 0; step < config.steps; step++) {
+        update_temperature(T, T_new, config, &tiles, backend);
+        if (T_new != NULL) {
+            update_tile_activity(T, T_new, config, &tiles);
+            double **temp = T;
+            T = T_new;
+            T_new = temp;
+        }
+        apply_boundaries(T, config);
+        if ((step + 1) % config.output_interval == 0 || step + 1 == config.steps) {
+            memcpy(heat_basis_field(basis, snapshot++, field), T[0], bytes);
+        }
+    }
+    free_2d_array(T, config.nx);
+    if (T_new != NULL) {
+        free_2d_array(T_new, config.nx);
+    }
+    tiles_free(&tiles);
+}
+
+// Each query line is "NAME TOP BOTTOM LEFT RIGHT"; its final state goes
+// to NAME_output_final.txt. -1 on a malformed line.
+static int answer_queries(SimulationConfig config, const heat_basis *basis, double **T, double step_time) {
+    FILE *fp = fopen(config.queries_path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "ERROR: Cannot open queries %s\n", config.queries_path);
+        return -1;
+    }
+    char line[512], name[64], filename[96];
+    int answered = 0, line_number = 0;
+    double combine_time = 0.0, start = get_current_time();
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        line_number++;
+        line[strcspn(line, "#")] = '\0';
+        double temps[HEAT_EDGE_COUNT];
+        int fields = sscanf(line, "%63s %lf %lf %lf %lf", name, &temps[HEAT_EDGE_TOP], &temps[HEAT_EDGE_BOTTOM],
+                            &temps[HEAT_EDGE_LEFT], &temps[HEAT_EDGE_RIGHT]);
+        if (fields <= 0) continue;
+        if (fields != 5) {
+            fprintf(stderr, "ERROR: %s:%d: expected NAME TOP BOTTOM LEFT RIGHT\n", config.queries_path, line_number);
+            fclose(fp);
+            return -1;
+        }
+        double t0 = get_current_time();
+        heat_basis_combine(basis, basis->snapshots - 1, temps, T[0]);
+        combine_time += get_current_time() - t0;
+        snprintf(filename, sizeof(filename), "%s_output_final.txt", name);
+        save_to_file(T, config, filename);
+        answered++;
+    }
+    fclose(fp);
+
+    double total = get_current_time() - start;
+    double gbytes = (double)answered * basis->count * basis->rows * basis->cols * sizeof(double) * 1e-9;
+    printf("✓ %d queries from %s in %.3f s: %.3f ms each to superpose (%.1f GB/s), the rest writing NAME_output_final.txt\n",
+           answered, config.queries_path, total, answered ? combine_time / answered * 1e3 : 0.0,
+           combine_time > 0.0 ? gbytes / combine_time : 0.0);
+    if (step_time > 0.0 && answered > 0) {
+        printf("  A stepped run took %.3f s, %.0fx the superposition\n", step_time, step_time * answered / combine_time);
+    }
+    return 0;
+}
+
+// --superpose: load the basis for this run from the cache (or build and
+// save it), then write the run's snapshots, and any queries, as
+// weighted sums of the basis fields
+static int run_superposed(SimulationConfig config, const heat_backend *backend) {
+    int source[HEAT_BASIS_MAX];
+    int count = basis_sources(config, source);
+    int snapshots = config.steps / config.output_interval + 1 + (config.steps % config.output_interval != 0);
+    unsigned long long key = basis_key(config);
+    double megabytes = (double)snapshots * count * config.nx * config.ny * sizeof(double) / (1024.0 * 1024.0);
+    double step_time = 0.0;
+
+    heat_basis basis;
+    double t0 = get_current_time();
+    if (heat_basis_load(&basis, config.basis_cache, key) == 0) {
+        printf("✓ Loaded %d basis fields x %d snapshots (%.1f MB) from %s in %.3f s\n",
+               count, snapshots, megabytes, config.basis_cache, get_current_time() - t0);
+    } else {
+        printf("Building the superposition basis: %d runs of %d steps, %d snapshots (%.1f MB)...\n",
+               count, config.steps, snapshots, megabytes);
+        if (heat_basis_init(&basis, config.nx, config.ny, snapshots, count, source, key) != 0) {
+            fprintf(stderr, "ERROR: Basis allocation failed (%.1f MB)\n", megabytes);
+            return EXIT_FAILURE;
+        }
+        for (int f = 0; f < count; f++) {
+            double tf = get_current_time();
+            run_basis(config, backend, &basis, f);
+            tf = get_current_time() - tf;
+            step_time += tf / count;
+            printf("  %-6s %.3f s\n", source[f] == HEAT_BASIS_FIXED ? "fluxes" : heat_edge_name((heat_edge)source[f]), tf);
+        }
+        if (heat_basis_save(&basis, config.basis_cache) == 0) {
+            printf("✓ Basis saved to %s\n", config.basis_cache);
+        }
+    }
+
+    // This run's own temperatures, written as a stepped run would
+    double temps[HEAT_EDGE_COUNT] = {config.top_temp, config.bottom_temp, config.left_temp, config.right_temp};
+    double **T = allocate_2d_array(config.nx, config.ny);
+    double combine_time = 0.0;
+    char filename[50];
+    for (int k = 0; k < snapshots; k++) {
+        double tc = get_current_time();
+        heat_basis_combine(&basis, k, temps, T[0]);
+        combine_time += get_current_time() - tc;
+        if (k * config.output_interval <= config.steps) {
+            snprintf(filename, sizeof(filename), "output_step_%04d.txt", k * config.output_interval);
+            save_to_file(T, config, filename);
+        }
+    }
+    save_to_file(T, config, "output_final.txt");
+    if (stretched.x != NULL) {
+        write_coordinates("grid_x.txt", stretched.x, config.nx);
+        write_coordinates("grid_y.txt", stretched.y, config.ny);
+    }
+    printf("✓ %d snapshots superposed in %.4f s and saved (output_step_*.txt, output_final.txt)\n",
+           snapshots, combine_time);
+
+    int status = 0;
+    if (config.queries_path != NULL) {
+        status = answer_queries(config, &basis, T, step_time);
+    }
+    free_2d_array(T, config.nx);
+    heat_basis_free(&basis);
+    return status == 0 ? 0 : EXIT_FAILURE;
+}
+
+// One cached result: the final field of a configuration
+typedef struct {
+    unsigned long long key;
+    int nx, ny;
+    double residual;
+    double compute_time;        // seconds the run took when it was computed
+    double *T;                  // nx*ny, row-major
+    unsigned long long last_used;
+    int shared;                 // exported as the shared-memory object /heat-<key>
+} CachedResult;
+
+// LRU cache of final fields, bounded by bytes and entry count
+typedef struct {
+    CachedResult entries[DAEMON_MAX_ENTRIES];
+    int count;
+    size_t bytes, max_bytes;
+    unsigned long long clock;
+    long long hits, misses;
+} ResultCache;
+
+// Grids kept between requests. The blocks only grow; the row pointers
+// are rebuilt for each request's shape.
+typedef struct {
+    double *block[2];
+    double **rows[2];
+    size_t capacity;            // cells in each block
+} Workspace;
+
+// Key of a request's final field: the trajectory plus the step count
+static unsigned long long result_key(SimulationConfig config) {
+    return heat_hash(trajectory_key(config), &config.steps, sizeof(config.steps));
+}
+
+static CachedResult *cache_find(ResultCache *cache, unsigned long long key) {
+    for (int n = 0; n < cache->count; n++) {
+        if (cache->entries[n].key == key) {
+            cache->entries[n].last_used = ++cache->clock;
+            return &cache->entries[n];
+        }
+    }
+    return NULL;
+}
+
+static void shared_name(unsigned long long key, char *name, size_t size) {
+    snprintf(name, size, "/heat-%016llx", key);
+}
+
+static void cache_evict(ResultCache *cache, int n) {
+    CachedResult *entry = &cache->entries[n];
+    if (entry->shared) {
+        char name[32];
+        shared_name(entry->key, name, sizeof(name));
+        shm_unlink(name);
+    }
+    cache->bytes -= (size_t)entry->nx * entry->ny * sizeof(double);
+    free(entry->T);
+    *entry = cache->entries[--cache->count];
+}
+
+// Copy a fresh result in, evicting the least recently used entries to
+// make room. NULL if it is larger than the whole cache.
+static CachedResult *cache_insert(ResultCache *cache, const CachedResult *result) {
+    size_t bytes = (size_t)result->nx * result->ny * sizeof(double);
+    if (bytes > cache->max_bytes) return NULL;
+    while (cache->count > 0 && (cache->count == DAEMON_MAX_ENTRIES || cache->bytes + bytes > cache->max_bytes)) {
+        int oldest = 0;
+        for (int n = 1; n < cache->count; n++) {
+            if (cache->entries[n].last_used < cache->entries[oldest].last_used) oldest = n;
+        }
+        cache_evict(cache, oldest);
+    }
+    double *T = (double *)malloc(bytes);
+    if (T == NULL) return NULL;
+    memcpy(T, result->T, bytes);
+    CachedResult *entry = &cache->entries[cache->count++];
+    *entry = *result;
+    entry->T = T;
+    entry->shared = 0;
+    entry->last_used = ++cache->clock;
+    cache->bytes += bytes;
+    return entry;
+}
+
+// Size the workspace for an nx x ny run (both time levels); -1 when out of memory
+static int workspace_reserve(Workspace *ws, int nx, int ny) {
+    size_t cells = (size_t)nx * ny;
+    for (int k = 0; k < 2; k++) {
+        if (cells > ws->capacity) {
+            free(ws->block[k]);
+            ws->block[k] = (double *)malloc(cells * sizeof(double));
+        }
+        double **rows = (double **)realloc(ws->rows[k], nx * sizeof(double *));
+        if (ws->block[k] == NULL || rows == NULL) {
+            ws->capacity = 0;
+            return -1;
+        }
+        ws->rows[k] = rows;
+        for (int i = 0; i < nx; i++) {
+            rows[i] = ws->block[k] + (size_t)i * ny;
+        }
+    }
+    if (cells > ws->capacity) ws->capacity = cells;
+    return 0;
+}
+
+// Step a request from the initial field in the workspace; returns the
+// buffer holding the final field
+static double **serve_run(SimulationConfig config, const heat_backend *backend, Workspace *ws, double *residual) {
+    double **T = ws->rows[0];
+    double **T_new = config.inplace ? NULL : ws->rows[1];
+    TileTracker tiles;
+    tiles_init(&tiles, config);
+    initialize(T, config);
+    apply_boundaries(T, config);
+    for (int step = 0; step < config.steps; step++) {
+        update_temperature(T, T_new, config, &tiles, backend);
+        if (T_new != NULL) {
+            update_tile_activity(T, T_new, config, &tiles);
+            double **temp = T;
+            T = T_new;
+            T_new = temp;
+        }
+        apply_boundaries(T, config);
+    }
+    *residual = config.steps > 0 ? calculate_residual(&tiles, config) : 0.0;
+    tiles_free(&tiles);
+    return T;
+}
+
+// Checkpoint header and field in the shared-memory object /heat-<key>, so
+// clients map it read-only instead of receiving a copy. 0 or -1.
+static int export_shared(CachedResult *entry, SimulationConfig config) {
+    if (entry->shared) return 0;
+    char name[32];
+    shared_name(entry->key, name, sizeof(name));
+    size_t field_bytes = (size_t)entry->nx * entry->ny * sizeof(double);
+    size_t bytes = sizeof(heat_checkpoint_header) + field_bytes;
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (fd < 0) return -1;
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0) {
+        map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(name);
+        return -1;
+    }
+    heat_checkpoint_header header;
+    fill_checkpoint_header(&header, config, config.steps);
+    memcpy(map, &header, sizeof(header));
+    memcpy((char *)map + sizeof(header), entry->T, field_bytes);
+    munmap(map, bytes);
+    entry->shared = 1;
+    return 0;
+}
+
+// A JSON string literal (quotes, backslashes and control characters escaped)
+static void put_json_string(FILE *fp, const char *text) {
+    fputc('"', fp);
+    for (; *text; text++) {
+        if (*text == '"' || *text == '\\') {
+            fprintf(fp, "\\%c", *text);
+        } else if ((unsigned char)*text < 0x20) {
+            fprintf(fp, "\\u%04x", (unsigned char)*text);
+        } else {
+            fputc(*text, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+static void reply_error(FILE *out, const char *fmt, ...) {
+    char message[512];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+    fprintf(out, "{\"status\": \"error\", \"message\": ");
+    put_json_string(out, message);
+    fprintf(out, "}\n");
+}
+
+// What validate_simulation checks, as a reason instead of an exit; NULL if the request can run
+static const char *check_request(SimulationConfig config, SimulationConfig base) {
+    if (config.mask_path != base.mask_path || config.materials_path != base.materials_path ||
+        config.out_of_core != base.out_of_core || config.basis_cache != base.basis_cache ||
+        config.stretch[0].kind != HEAT_STRETCH_UNIFORM || config.stretch[1].kind != HEAT_STRETCH_UNIFORM ||
+        config.axisymmetric || config.jit) {
+        return "masks, materials, stretched or axisymmetric grids, out-of-core runs, superposition and --jit are not served";
+    }
+    if (config.nx < 3 || config.ny < 3 || config.steps < 0 || config.output_interval < 1) {
+        return "the grid needs at least 3x3 cells, steps >= 0 and output_interval >= 1";
+    }
+    if ((config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC) != (config.bc_type[HEAT_EDGE_BOTTOM] == HEAT_BC_PERIODIC) ||
+        (config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC) != (config.bc_type[HEAT_EDGE_RIGHT] == HEAT_BC_PERIODIC)) {
+        return "periodic boundaries must be set on both top and bottom, or both left and right";
+    }
+    if (config.order != 2 && config.order != 4) {
+        return "the stencil order must be 2 or 4";
+    }
+    if (config.order == 4) {
+        for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+            if (config.bc_type[e] != HEAT_BC_DIRICHLET) return "the 4th-order stencil needs Dirichlet boundaries";
+        }
+        if (config.nx < 5 || config.ny < 5 || config.inplace) {
+            return "the 4th-order stencil needs at least a 5x5 grid and the two-buffer update";
+        }
+    }
+    return NULL;
+}
+
+// Answer one request line. Returns 1 after a shutdown command.
+static int handle_request(const char *line, SimulationConfig base, ResultCache *cache, Workspace *ws, FILE *out) {
+    static heat_config request;     // strings stay referenced by config until the reply is written
+    double start = get_current_time();
+    memset(&request, 0, sizeof(request));
+    if (heat_config_parse(&request, line, "request") != 0) {
+        reply_error(out, "%s", request.error);
+        return 0;
+    }
+
+    const char *command = heat_config_get(&request, "command");
+    if (command != NULL && strcmp(command, "stats") == 0) {
+        fprintf(out, "{\"status\": \"ok\", \"entries\": %d, \"megabytes\": %.3f, \"capacity_mb\": %.3f, "
+                "\"hits\": %lld, \"misses\": %lld}\n", cache->count, cache->bytes / (1024.0 * 1024.0),
+                cache->max_bytes / (1024.0 * 1024.0), cache->hits, cache->misses);
+        return 0;
+    }
+    if (command != NULL && strcmp(command, "shutdown") == 0) {
+        fprintf(out, "{\"status\": \"ok\"}\n");
+        return 1;
+    }
+    if (command != NULL && strcmp(command, "run") != 0) {
+        reply_error(out, "unknown command '%s' (run, stats or shutdown)", command);
+        return 0;
+    }
+    const char *result = heat_config_get(&request, "result");
+    const char *path = heat_config_get(&request, "path");
+    if (result == NULL) result = "shm";
+    int want_shm = strcmp(result, "shm") == 0, want_binary = strcmp(result, "binary") == 0;
+    int want_text = strcmp(result, "text") == 0;
+    if (!want_shm && !want_binary && !want_text && strcmp(result, "none") != 0) {
+        reply_error(out, "unknown result '%s' (shm, binary, text or none)", result);
+        return 0;
+    }
+    if ((want_binary || want_text) && (path == NULL || path[0] == '\0')) {
+        reply_error(out, "result '%s' needs a \"path\"", result);
+        return 0;
+    }
+
+    SimulationConfig config = base;
+    if (apply_config(&config, &request) != 0) {
+        reply_error(out, "bad value in request (details on the daemon's stderr)");
+        return 0;
+    }
+    for (int e = 0; e < request.count; e++) {
+        if (!request.entries[e].used) {
+            reply_error(out, "unknown key %s", request.entries[e].key);
+            return 0;
+        }
+    }
+    const char *reason = check_request(config, base);
+    if (reason != NULL) {
+        reply_error(out, "%s", reason);
+        return 0;
+    }
+    const heat_backend *backend = heat_select_backend(config.backend_name);
+    if (backend == NULL) {
+        reply_error(out, "unknown stencil backend '%s'", config.backend_name);
+        return 0;
+    }
+
+    unsigned long long key = result_key(config);
+    CachedResult *entry = cache_find(cache, key);
+    CachedResult fresh;
+    int cached = entry != NULL;
+    if (cached) {
+        cache->hits++;
+    } else {
+        cache->misses++;
+        if (workspace_reserve(ws, config.nx, config.ny) != 0) {
+            reply_error(out, "out of memory for a %dx%d grid", config.nx, config.ny);
+            return 0;
+        }
+        memset(&fresh, 0, sizeof(fresh));
+        fresh.key = key;
+        fresh.nx = config.nx;
+        fresh.ny = config.ny;
+        double t0 = get_current_time();
+        fresh.T = serve_run(config, backend, ws, &fresh.residual)[0];
+        fresh.compute_time = get_current_time() - t0;
+        entry = cache_insert(cache, &fresh);
+        if (entry == NULL) {
+            entry = &fresh;     // served from the workspace, too large to keep
+        }
+    }
+
+    // Binary files use the checkpoint format, so they also work with --restart
+    double **rows = (double **)malloc(config.nx * sizeof(double *));
+    if (rows == NULL) {
+        reply_error(out, "out of memory");
+        return 0;
+    }
+    for (int i = 0; i < config.nx; i++) {
+        rows[i] = entry->T + (size_t)i * config.ny;
+    }
+    if (want_binary) {
+        config.checkpoint_path = path;
+        write_checkpoint(rows, config, config.steps);
+    } else if (want_text) {
+        save_to_file(rows, config, path);
+    }
+    free(rows);
+    char name[32] = "";
+    if (want_shm) {
+        if (entry == &fresh) {
+            reply_error(out, "a %dx%d field does not fit in the %d MB cache; ask for a binary or text result",
+                        config.nx, config.ny, config.cache_mb);
+            return 0;
+        }
+        if (export_shared(entry, config) != 0) {
+            reply_error(out, "cannot create a shared-memory object: %s", strerror(errno));
+            return 0;
+        }
+        shared_name(key, name, sizeof(name));
+    }
+
+    double dt_limit = 0.25 * fmin(config.dx * config.dx, config.dy * config.dy) / config.alpha;
+    if (config.order == 4) dt_limit *= 0.75;
+    fprintf(out, "{\"status\": \"ok\", \"key\": \"%016llx\", \"cached\": %s, \"nx\": %d, \"ny\": %d, "
+            "\"steps\": %d, \"residual\": %.6e, \"stable\": %s, \"compute_seconds\": %.6f, \"seconds\": %.6f",
+            key, cached ? "true" : "false", config.nx, config.ny, config.steps, entry->residual,
+            config.dt <= dt_limit ? "true" : "false", entry->compute_time, get_current_time() - start);
+    if (want_shm) {
+        fprintf(out, ", \"shm\": \"%s\", \"bytes\": %zu", name,
+                sizeof(heat_checkpoint_header) + (size_t)config.nx * config.ny * sizeof(double));
+    } else if (want_binary || want_text) {
+        fprintf(out, ", \"%s\": ", result);
+        put_json_string(out, path);
+    }
+    fprintf(out, "}\n");
+    return 0;
+}
+
+// --serve: accept connections on a Unix socket and answer their request
+// lines in order until a shutdown command, SIGINT or SIGTERM. Requests
+// run one at a time; --backend threaded keeps its worker pool between them.
+static int serve(SimulationConfig base, const heat_backend *backend) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(base.serve_path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "ERROR: Socket path %s is too long\n", base.serve_path);
+        return EXIT_FAILURE;
+    }
+    strcpy(address.sun_path, base.serve_path);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(base.serve_path);
+    if (listener < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        fprintf(stderr, "ERROR: Cannot listen on %s: %s\n", base.serve_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, request_stop);
+    signal(SIGTERM, request_stop);
+    base.backend_name = backend->name;
+
+    static ResultCache cache;
+    Workspace ws = {{NULL, NULL}, {NULL, NULL}, 0};
+    cache.max_bytes = (size_t)base.cache_mb * 1024 * 1024;
+    printf("Serving on %s (%s backend, %d MB result cache); send {\"command\": \"shutdown\"} to stop\n",
+           base.serve_path, backend->name, base.cache_mb);
+    fflush(stdout);
+
+    int shutdown_requested = 0;
+    char line[DAEMON_LINE_MAX];
+    while (!shutdown_requested && !stop_requested) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "ERROR: accept on %s: %s\n", base.serve_path, strerror(errno));
+            break;
+        }
+        int client_out = dup(client);
+        FILE *in = fdopen(client, "r");
+        FILE *out = client_out >= 0 ? fdopen(client_out, "w") : NULL;
+        while (in != NULL && out != NULL && !shutdown_requested && fgets(line, sizeof(line), in) != NULL) {
+            size_t length = strlen(line);
+            if (length == sizeof(line) - 1 && line[length - 1] != '\n') {
+                // Drop the rest of an overlong line
+                int c;
+                while ((c = fgetc(in)) != EOF && c != '\n') {}
+                reply_error(out, "request longer than %d bytes", DAEMON_LINE_MAX - 2);
+            } else if (strspn(line, " \t\r\n") < length) {
+                shutdown_requested = handle_request(line, base, &cache, &ws, out);
+            }
+            fflush(out);
+        }
+        if (in != NULL) fclose(in); else close(client);
+        if (out != NULL) fclose(out); else if (client_out >= 0) close(client_out);
+    }
+
+    printf("Daemon stopped: %lld hits, %lld misses, %d results cached (%.1f MB)\n",
+           cache.hits, cache.misses, cache.count, cache.bytes / (1024.0 * 1024.0));
+    close(listener);
+    unlink(base.serve_path);
+    while (cache.count > 0) {
+        cache_evict(&cache, cache.count - 1);
+    }
+    for (int k = 0; k < 2; k++) {
+        free(ws.block[k]);
+        free(ws.rows[k]);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
     // Simulation configuration
     SimulationConfig config = {
         .nx = 100, .ny = 100,
@@ -218,9 +1737,83 @@ int main() {
         .top_temp = 100.0, .bottom_temp = 100.0,
         .left_temp = 0.0, .right_temp = 0.0,
         .output_interval = 100,
-        .progress_bar_width = 40
+        .progress_bar_width = 40,
+        .checkpoint_interval = 0,
+        .checkpoint_path = CHECKPOINT_FILE,
+        .restart_path = NULL,
+        .tile_threshold = TILE_THRESHOLD,
+        .backend_name = NULL,
+        .order = STENCIL_ORDER,
+        .out_of_core = NULL,
+        .time_block = OOC_TIME_BLOCK,
+        .slab_rows = OOC_SLAB_ROWS,
+        .mask_path = NULL,
+        .materials_path = NULL,
+        .cache_mb = DAEMON_CACHE_MB,
+        .memo_mb = MEMO_MB
     };
     
+    parse_args(argc, argv, &config);
+    
+    int start_step = 0;
+    if (config.restart_path != NULL) {
+        start_step = load_checkpoint_header(&config);
+    }
+    
+    const heat_backend *backend = heat_select_backend(config.backend_name);
+    if (backend == NULL) {
+        fprintf(stderr, "ERROR: Unknown stencil backend. Available backends:\n");
+        heat_list_backends(stderr);
+        exit(EXIT_FAILURE);
+    }
+    if (config.out_of_core && config.time_block > 1 &&
+        (config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC || config.bc_type[HEAT_EDGE_BOTTOM] == HEAT_BC_PERIODIC)) {
+        fprintf(stderr, "Note: periodic top/bottom edges wrap across the whole pass, using a time block of 1\n");
+        config.time_block = 1;
+    }
+    if (config.mask_path != NULL &&
+        heat_mask_load(&mask, config.mask_path, config.nx, config.ny,
+                       config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC,
+                       config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC) != 0) {
+        fprintf(stderr, "ERROR: Mask %s: %s\n", config.mask_path, mask.error);
+        exit(EXIT_FAILURE);
+    }
+    if (config.stretch[0].kind != HEAT_STRETCH_UNIFORM || config.stretch[1].kind != HEAT_STRETCH_UNIFORM) {
+        heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+        if (heat_stretched_init(&stretched, &grid, &config.stretch[0], &config.stretch[1]) != 0) {
+            fprintf(stderr, "ERROR: Stretched grid allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (config.axisymmetric) {
+        heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+        if (heat_axisym_init(&axisym, &grid) != 0) {
+            fprintf(stderr, "ERROR: Axisymmetric weights allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (config.materials_path != NULL) {
+        heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+        if (heat_materials_load(&materials, config.materials_path, config.nx, config.ny, config.alpha,
+                                config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC,
+                                config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC) != 0 ||
+            heat_materials_build(&materials, &grid, 0, config.nx, config.float_coeffs) != 0) {
+            fprintf(stderr, "ERROR: Materials %s: %s\n", config.materials_path, materials.error);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (config.jit && config.order == 4) {
+        fprintf(stderr, "WARNING: --jit only applies to the 2nd-order stencil\n");
+    } else if (config.jit) {
+        heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+        const heat_backend *jit = heat_jit_backend(&grid);
+        if (jit != NULL) {
+            backend = jit;
+        } else {
+            fprintf(stderr, "WARNING: JIT kernel unavailable, using the %s backend\n", backend->name);
+        }
+    }
+    
     // Start timing
     double start_time = get_current_time();
     
@@ -230,35 +1823,158 @@ int main() {
     // Validate simulation parameters
     validate_simulation(config);
     
+    if (config.serve_path != NULL) {
+        return serve(config, backend);
+    }
+    if (config.basis_cache != NULL) {
+        int status = run_superposed(config, backend);
+        heat_materials_free(&materials);
+        heat_stretched_free(&stretched);
+        heat_axisym_free(&axisym);
+        return status;
+    }
+    
+    // A memo entry holds the field but not the tile tracker (which tiles
+    // are idle, and for how long), so a run resumed from one would skip
+    // different tiles than a fresh run. Only runs that update every tile
+    // use the memo.
+    if (config.memo_dir != NULL && config.tile_threshold > 0.0 && !config.inplace && !config.out_of_core) {
+        printf("Memo: off, since tiles idle below %g are skipped and a resumed run would not match a fresh one\n",
+               config.tile_threshold);
+        config.memo_dir = NULL;
+    }
+
+    // Longest stored prefix of this run, if any
+    char memo_path[1024];
+    int memo_step = -1;
+    if (config.memo_dir != NULL && config.restart_path == NULL) {
+        memo_step = memo_lookup(config, memo_path, sizeof(memo_path));
+    }
+    
     // Allocate memory
     printf("Allocating memory...\n");
-    double **T = allocate_2d_array(config.nx, config.ny);
-    double **T_new = allocate_2d_array(config.nx, config.ny);
+    double **T = config.out_of_core ? map_2d_array(config.out_of_core, config.nx, config.ny)
+                                    : allocate_2d_array(config.nx, config.ny);
+    double **T_new = config.inplace || config.out_of_core ? NULL : allocate_2d_array(config.nx, config.ny);
+    TileTracker tiles;
+    tiles_init(&tiles, config);
     
     // Initialize temperature field
     printf("Initializing temperature field...\n");
     initialize(T, config);
-    save_to_file(T, config, "output_step_0000.txt");
-    printf("✓ Initial state saved to output_step_0000.txt\n\n");
+    if (mask.kind != NULL) {
+        // Fixed cells and holes are never written by the step, so both
+        // buffers carry them (a checkpoint already holds them too)
+        heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+        heat_mask_fill(&mask, 0, &grid, T[0], 0, config.nx);
+        heat_mask_fill(&mask, 0, &grid, T_new[0], 0, config.nx);
+    }
+    if (config.restart_path != NULL) {
+        load_checkpoint_data(T, config);
+        apply_boundaries(T, config);
+        printf("✓ Restarted from %s at step %d\n\n", config.restart_path, start_step);
+    } else if (memo_step >= 0) {
+        SimulationConfig stored = config;
+        stored.restart_path = memo_path;
+        load_checkpoint_data(T, stored);
+        apply_boundaries(T, config);
+        start_step = memo_step;
+        printf("✓ Memo: resumed from step %d of %d (%s), %d steps to run\n\n",
+               memo_step, config.steps, memo_path, config.steps - memo_step);
+    } else {
+        apply_boundaries(T, config);
+        save_to_file(T, config, "output_step_0000.txt");
+        printf("✓ Initial state saved to output_step_0000.txt\n\n");
+    }
+    if (stretched.x != NULL) {
+        write_coordinates("grid_x.txt", stretched.x, config.nx);
+        write_coordinates("grid_y.txt", stretched.y, config.ny);
+        printf("✓ Node coordinates saved to grid_x.txt and grid_y.txt\n\n");
+    }
+    
+    signal(SIGINT, request_stop);
+    signal(SIGTERM, request_stop);
     
     printf("Starting simulation...\n");
-    printf("Press Ctrl+C to interrupt early\n\n");
+    if (config.checkpoint_interval > 0) {
+        printf("Checkpointing every %d steps to %s\n", config.checkpoint_interval, config.checkpoint_path);
+    }
+    if (config.memo_dir != NULL) {
+        printf("Memo: storing the final state%s in %s (%d MB)\n",
+               config.checkpoint_interval > 0 ? " and checkpoints" : "", config.memo_dir, config.memo_mb);
+    }
+    if (mask.kind != NULL) {
+        printf("Mask: %s, %lld active cells in %d runs + %d rim cells (scalar loop)\n", config.mask_path,
+               mask.active_cells, mask.run_start[config.nx], mask.rim_start[config.nx]);
+    } else if (stretched.x != NULL) {
+        int mx = config.nx / 2, my = config.ny / 2;
+        printf("Stretched grid: x %s (first/middle spacing %.3g/%.3g), y %s (%.3g/%.3g)\n",
+               heat_stretch_name(config.stretch[0].kind), stretched.x[1] - stretched.x[0],
+               stretched.x[mx] - stretched.x[mx - 1], heat_stretch_name(config.stretch[1].kind),
+               stretched.y[1] - stretched.y[0], stretched.y[my] - stretched.y[my - 1]);
+    } else if (axisym.inner != NULL) {
+        printf("Axisymmetric: z down the %d rows (dz %g), r across the %d columns (dr %g, R %g), axis at column 0\n",
+               config.nx, config.dx, config.ny, config.dy, (config.ny - 1) * config.dy);
+    } else if (materials.kind != NULL) {
+        printf("Materials: %s, alpha %g to %g, %s face coefficients (flux-form loop)\n", config.materials_path,
+               materials.alpha_min, materials.alpha_max, config.float_coeffs ? "float" : "double");
+    } else if (config.order == 4) {
+        printf("Stencil: 4th-order wide cross\n");
+    } else if (config.out_of_core) {
+        printf("Out of core: T mapped from %s, %d steps per pass, %d-row slabs\n",
+               config.out_of_core, config.time_block, config.slab_rows);
+    } else {
+        printf("Stencil backend: %s (%s)\n", backend->name, backend->description);
+    }
+    if (config.inplace || config.out_of_core) {
+        printf("Updating in place with a line buffer (no second grid, no tile skipping)\n");
+    } else {
+        printf("Skipping %dx%d tiles idle for %d steps (|dT| <= %g)\n", TILE_SIZE, TILE_SIZE, TILE_IDLE_STEPS, config.tile_threshold);
+    }
+    printf("Press Ctrl+C to interrupt early (state is checkpointed to %s)\n\n", config.checkpoint_path);
     
     double residual = 0.0;
     
+    heat_energy rapl;
+    int have_rapl = heat_energy_init(&rapl) > 0;
+    heat_energy_start(&rapl);
+    double loop_start = get_current_time();
+    
+    int end_step = config.steps;
+    
     // Main simulation loop
-    for (int step = 0; step < config.steps; step++) {
-        // Update temperature
-        update_temperature(T, T_new, config);
-        
-        // Swap pointers for next iteration
-        double **temp = T;
-        T = T_new;
-        T_new = temp;
+    for (int step = start_step; step < config.steps; step++) {
+        if (config.out_of_core) {
+            // Several steps per pass over the file, stopping at every output
+            int block = stream_block(config, step);
+            heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+            heat_bc bcs[HEAT_EDGE_COUNT];
+            for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+                bcs[e] = edge_bc(config, (heat_edge)e);
+            }
+            tiles.max_change[0] = heat_stream_steps(&mapped_field, &grid, bcs, block, config.slab_rows);
+            if (tiles.max_change[0] < 0.0) {
+                fprintf(stderr, "ERROR: Out-of-core window allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+            step += block - 1;
+        } else {
+            // Update temperature
+            update_temperature(T, T_new, config, &tiles, backend);
+            
+            // Swap pointers for next iteration
+            if (T_new != NULL) {
+                update_tile_activity(T, T_new, config, &tiles);
+                double **temp = T;
+                T = T_new;
+                T_new = temp;
+            }
+            apply_boundaries(T, config);
+        }
         
         // Calculate residual every 100 steps
         if ((step + 1) % 100 == 0) {
-            residual = calculate_residual(T, config);
+            residual = calculate_residual(&tiles, config);
         }
         
         // Save output and show progress
@@ -273,10 +1989,30 @@ int main() {
             printf(" | Residual: %.2e", residual);
             fflush(stdout);
         }
+        
+        // Checkpoint periodically, and on Ctrl+C / SIGTERM before stopping
+        if (stop_requested) {
+            write_checkpoint(T, config, step + 1);
+            if (config.memo_dir != NULL) memo_store(T, config, step + 1);
+            end_step = step + 1;
+            break;
+        }
+        if (config.checkpoint_interval > 0 && (step + 1) % config.checkpoint_interval == 0) {
+            write_checkpoint(T, config, step + 1);
+            if (config.memo_dir != NULL && step + 1 < config.steps) memo_store(T, config, step + 1);
+        }
     }
+    int steps_run = end_step - start_step;
     
-    // Save final state
-    save_to_file(T, config, "output_final.txt");
+    double loop_time = get_current_time() - loop_start;
+    double pkg_joules = 0.0, dram_joules = 0.0;
+    heat_energy_stop(&rapl, &pkg_joules, &dram_joules);
+    
+    // Save final state (an interrupted run leaves only the checkpoint)
+    if (end_step == config.steps) {
+        save_to_file(T, config, "output_final.txt");
+        if (config.memo_dir != NULL && steps_run > 0) memo_store(T, config, end_step);
+    }
     
     // Calculate total time
     double total_time = get_current_time() - start_time;
@@ -284,20 +2020,56 @@ int main() {
     // Print completion message
     printf("\n\n");
     printf("╔══════════════════════════════════════════════════════════════╗\n");
-    printf("║                     SIMULATION COMPLETE                      ║\n");
+    if (end_step == config.steps) {
+        printf("║                     SIMULATION COMPLETE                      ║\n");
+    } else {
+        printf("║                   SIMULATION INTERRUPTED                     ║\n");
+    }
     printf("╠══════════════════════════════════════════════════════════════╣\n");
+    if (end_step != config.steps) {
+        printf("║ Stopped at step %d/%d, resume with --restart %s\n", end_step, config.steps, config.checkpoint_path);
+    }
     printf("║ Total time: %8.2f seconds                             ║\n", total_time);
-    printf("║ Performance: %8.2f steps/second                      ║\n", config.steps / total_time);
+    printf("║ Performance: %8.2f steps/second                      ║\n", steps_run / total_time);
     printf("║ Final residual: %.2e                            ║\n", residual);
+    printf("║ Tiles skipped: %6.2f%% of cell-updates                 ║\n",
+           steps_run > 0 ? 100.0 * tiles.skipped_updates / ((double)(config.nx - 2) * (config.ny - 2) * steps_run) : 0.0);
+    if (have_rapl) {
+        double joules = pkg_joules + dram_joules;
+        double mcell_updates = (double)(config.nx - 2) * (config.ny - 2) * steps_run * 1e-6;
+        printf("║ Energy: %8.2f J (pkg %.2f J, dram %.2f J)            ║\n", joules, pkg_joules, dram_joules);
+        printf("║ Average power: %8.2f W                               ║\n", joules / loop_time);
+        printf("║ Energy per Mcell-update: %.4f J                      ║\n", joules / mcell_updates);
+    } else {
+        printf("║ Energy: RAPL counters unavailable                           ║\n");
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("║ Peak memory (RSS): %8.1f MB                          ║\n", usage.ru_maxrss / 1024.0);
     printf("║ Output files: %d temperature snapshots              ║\n", config.steps / config.output_interval + 2);
     printf("╚══════════════════════════════════════════════════════════════╝\n");
     printf("\n");
     
     // Free memory
-    free_2d_array(T, config.nx);
-    free_2d_array(T_new, config.nx);
+    if (config.out_of_core) {
+        free(T);
+        heat_unmap_field(&mapped_field);
+    } else {
+        free_2d_array(T, config.nx);
+    }
+    if (T_new != NULL) {
+        free_2d_array(T_new, config.nx);
+    }
+    tiles_free(&tiles);
+    heat_mask_free(&mask);
+    heat_materials_free(&materials);
+    heat_stretched_free(&stretched);
+    heat_axisym_free(&axisym);
     
     printf("✓ Memory freed successfully\n");
+    if (end_step != config.steps) {
+        return EXIT_FAILURE;
+    }
     printf("✓ Simulation completed successfully!\n");
     
     return 0;
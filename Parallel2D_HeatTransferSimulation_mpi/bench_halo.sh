@@ -0,0 +1,40 @@
+#!/bin/bash
+# Head-to-head comparison of the halo exchange modes in heat_mpi.
+# Usage: ./bench_halo.sh [ranks] [repeats] [extra mpirun args...]
+
+NP=${1:-4}
+REPEATS=${2:-3}
+shift $(( $# < 2 ? $# : 2 ))
+MODES="sendrecv nonblocking rma shm"
+
+if [ ! -x ./heat_mpi ]; then
+    echo "Error: ./heat_mpi not found. Run 'make' first."
+    exit 1
+fi
+
+echo "=========================================="
+echo "Halo exchange benchmark (np=$NP, best of $REPEATS)"
+echo "=========================================="
+printf "%-12s %14s %16s\n" "mode" "steps/s" "halo us/step"
+
+for mode in $MODES; do
+    best_rate=0
+    best_halo=""
+    for run in $(seq 1 "$REPEATS"); do
+        out=$(mpirun -np "$NP" "$@" ./heat_mpi --halo "$mode" 2>&1)
+        if [ $? -ne 0 ]; then
+            echo "Error: run with --halo $mode failed"
+            echo "$out" | tail -5
+            exit 1
+        fi
+        rate=$(echo "$out" | awk '/^Throughput:/ {print $2}')
+        halo=$(echo "$out" | sed -n 's/.*(\([0-9.]*\) us\/step).*/\1/p')
+        if awk -v a="$rate" -v b="$best_rate" 'BEGIN {exit !(a > b)}'; then
+            best_rate=$rate
+            best_halo=$halo
+        fi
+    done
+    printf "%-12s %14s %16s\n" "$mode" "$best_rate" "$best_halo"
+done
+
+echo "=========================================="
@@ -0,0 +1,1015 @@
+#include <mpi.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Default configuration. The domain is the unit square discretized with
+// cell-centred patches; level L has cell size h0 / 2^L.
+#define BASE_PATCHES 2          // level-0 patches per side
+#define PATCH_SIZE 16           // cells per patch side (even)
+#define MAX_LEVEL 3
+#define DOMAIN_SIZE 1.0
+#define ALPHA 0.1
+#define DT 0.002                // level-0 step; level L uses DT / SUBCYCLES^L
+#define STEPS 50                // level-0 steps
+#define OUTPUT_INTERVAL 10
+#define REGRID_INTERVAL 2
+
+// Explicit diffusion needs dt ~ h^2, so halving h takes four substeps
+#define SUBCYCLES 4
+
+// Ranks one patch can feed: four same-level face neighbours, or up to
+// eight finer patches (two per edge) across coarse-fine edges
+#define MAX_MIRRORS 8
+
+// Gradient indicator: largest undivided jump between neighbouring cells
+#define REFINE_THRESHOLD 20.0
+#define COARSEN_THRESHOLD 10.0
+
+// Boundary temperatures
+#define TOP_TEMP 100.0
+#define BOTTOM_TEMP 100.0
+#define LEFT_TEMP 0.0
+#define RIGHT_TEMP 0.0
+
+// Patch indices double as message tags (index * 8 + kind), which keeps
+// them under the guaranteed MPI_TAG_UB of 32767
+#define MAX_PATCHES 4095
+
+#define P PATCH_SIZE
+#define PW (PATCH_SIZE + 2)
+
+// Message kinds
+#define TAG_DATA 0
+#define TAG_DATA_OLD 1
+#define TAG_RESTRICT 2
+#define TAG_REFLUX 3            // + edge (3..6)
+#define TAG_MIGRATE 7
+
+typedef struct {
+    int nx, ny;                 // finest-level equivalent grid
+    double alpha, h0, dt;
+    int steps;
+    int output_interval;
+    int regrid_interval;
+    int max_level;
+    int uniform;
+    double top_temp, bottom_temp, left_temp, right_temp;
+} SimulationConfig;
+
+// One fixed-size patch of the quadtree. Metadata is replicated on every
+// rank; field arrays exist only on the owner and on ranks mirroring it.
+typedef struct {
+    int level, pi, pj;          // patch row/column at its level
+    int parent;
+    int child[4];               // index 2*di + dj, -1 for leaves
+    int owner;
+    double *T, *T_old;          // (P+2)^2 including one ghost layer
+    double *creg[4];            // coarse side: flux*dt across edges facing a refined neighbour
+    double *freg[4];            // fine side: flux*dt summed over subcycles on coarse-fine edges
+    int send[2][MAX_MIRRORS];   // ranks mirroring this patch: [0] same-level ghosts, [1] finer levels
+    int nsend[2];
+    int recv[2];
+} Patch;
+
+typedef struct {
+    int count;
+    int depth;                  // finest level present
+    Patch patches[MAX_PATCHES];
+    int level_start[MAX_LEVEL + 2];
+    int *slot[MAX_LEVEL + 1];   // (pi, pj) -> patch index, -1 if absent
+    long long cell_updates;
+} AmrMesh;
+
+// Edges: 0 top (row -1), 1 bottom (row +1), 2 left (column -1), 3 right (column +1)
+static const int edge_di[4] = {-1, 1, 0, 0};
+static const int edge_dj[4] = {0, 0, -1, 1};
+
+static inline int cidx(int a, int b) {
+    return a * PW + b;
+}
+
+static inline int patches_per_side(int level) {
+    return BASE_PATCHES << level;
+}
+
+static inline double level_h(SimulationConfig config, int level) {
+    return config.h0 / (1 << level);
+}
+
+static inline double level_dt(SimulationConfig config, int level) {
+    double dt = config.dt;
+    for (int l = 0; l < level; l++) {
+        dt /= SUBCYCLES;
+    }
+    return dt;
+}
+
+// Ghost and first interior cell of edge e at position k (1..P)
+static void edge_cells(int e, int k, int *ghost, int *inner) {
+    switch (e) {
+        case 0: *ghost = cidx(0, k); *inner = cidx(1, k); break;
+        case 1: *ghost = cidx(P + 1, k); *inner = cidx(P, k); break;
+        case 2: *ghost = cidx(k, 0); *inner = cidx(k, 1); break;
+        default: *ghost = cidx(k, P + 1); *inner = cidx(k, P); break;
+    }
+}
+
+static double edge_temp(SimulationConfig config, int e) {
+    switch (e) {
+        case 0: return config.top_temp;
+        case 1: return config.bottom_temp;
+        case 2: return config.left_temp;
+        default: return config.right_temp;
+    }
+}
+
+static inline double minmod(double a, double b) {
+    if (a * b <= 0.0) return 0.0;
+    return fabs(a) < fabs(b) ? a : b;
+}
+
+// Patch index at (level, pi, pj); -1 if absent, -2 if outside the domain
+static int find_patch(const AmrMesh *mesh, int level, int pi, int pj) {
+    int n = patches_per_side(level);
+    if (pi < 0 || pj < 0 || pi >= n || pj >= n) return -2;
+    return mesh->slot[level][pi * n + pj];
+}
+
+static int neighbour(const AmrMesh *mesh, const Patch *p, int e) {
+    return find_patch(mesh, p->level, p->pi + edge_di[e], p->pj + edge_dj[e]);
+}
+
+// Coarse patch across the parent's edge e, used when the same-level
+// neighbour is missing (exists by the 2:1 balance rule; aborts if not)
+static int coarse_neighbour(const AmrMesh *mesh, const Patch *p, int e) {
+    int n = p->level > 0 ? find_patch(mesh, p->level - 1, p->pi / 2 + edge_di[e], p->pj / 2 + edge_dj[e]) : -1;
+    if (n == -1) {
+        fprintf(stderr, "ERROR: patch (%d, %d, %d) has no neighbour across edge %d; the mesh is not 2:1 balanced\n",
+                p->level, p->pi, p->pj, e);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return n;
+}
+
+static unsigned morton_key(int pi, int pj) {
+    unsigned key = 0;
+    for (int b = 0; b < 16; b++) {
+        key |= (unsigned)((pi >> b) & 1) << (2 * b + 1);
+        key |= (unsigned)((pj >> b) & 1) << (2 * b);
+    }
+    return key;
+}
+
+static int compare_morton(const void *a, const void *b) {
+    const Patch *pa = (const Patch *)a;
+    const Patch *pb = (const Patch *)b;
+    if (pa->level != pb->level) return pa->level - pb->level;
+    unsigned ka = morton_key(pa->pi, pa->pj);
+    unsigned kb = morton_key(pb->pi, pb->pj);
+    return (ka > kb) - (ka < kb);
+}
+
+static double *alloc_field(void) {
+    double *f = (double *)calloc(PW * PW, sizeof(double));
+    if (!f) {
+        fprintf(stderr, "ERROR: patch allocation failed\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return f;
+}
+
+static void free_patch_data(Patch *p) {
+    free(p->T);
+    free(p->T_old);
+    p->T = p->T_old = NULL;
+    for (int e = 0; e < 4; e++) {
+        free(p->creg[e]);
+        free(p->freg[e]);
+        p->creg[e] = p->freg[e] = NULL;
+    }
+}
+
+static void add_sender(Patch *p, int kind, int dest) {
+    for (int n = 0; n < p->nsend[kind]; n++) {
+        if (p->send[kind][n] == dest) return;
+    }
+    if (p->nsend[kind] == MAX_MIRRORS) {
+        fprintf(stderr, "ERROR: patch (%d, %d, %d) is mirrored to more than %d ranks\n",
+                p->level, p->pi, p->pj, MAX_MIRRORS);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    p->send[kind][p->nsend[kind]++] = dest;
+}
+
+// Build a mesh from per-level existence maps: sort each level along the
+// Z-order curve, split every level into equal contiguous chunks per rank
+// (subcycling makes levels run one after another), and wire up the
+// tree links and mirror lists.
+void build_mesh(AmrMesh *mesh, int *const *exists, SimulationConfig config, int rank, int size) {
+    mesh->count = 0;
+    mesh->depth = 0;
+    for (int level = 0; level <= config.max_level; level++) {
+        int n = patches_per_side(level);
+        for (int pi = 0; pi < n; pi++) {
+            for (int pj = 0; pj < n; pj++) {
+                if (!exists[level][pi * n + pj]) continue;
+                if (mesh->count == MAX_PATCHES) {
+                    fprintf(stderr, "ERROR: more than %d patches\n", MAX_PATCHES);
+                    MPI_Abort(MPI_COMM_WORLD, 1);
+                }
+                Patch *p = &mesh->patches[mesh->count++];
+                memset(p, 0, sizeof(*p));
+                p->level = level;
+                p->pi = pi;
+                p->pj = pj;
+                if (level > mesh->depth) mesh->depth = level;
+            }
+        }
+    }
+    qsort(mesh->patches, mesh->count, sizeof(Patch), compare_morton);
+
+    for (int level = 0; level <= config.max_level; level++) {
+        int n = patches_per_side(level);
+        for (int s = 0; s < n * n; s++) {
+            mesh->slot[level][s] = -1;
+        }
+    }
+    for (int level = 0; level <= config.max_level + 1; level++) {
+        mesh->level_start[level] = mesh->count;
+    }
+    for (int q = mesh->count - 1; q >= 0; q--) {
+        Patch *p = &mesh->patches[q];
+        mesh->level_start[p->level] = q;
+        mesh->slot[p->level][p->pi * patches_per_side(p->level) + p->pj] = q;
+    }
+    for (int level = config.max_level; level >= 0; level--) {
+        if (mesh->level_start[level] > mesh->level_start[level + 1]) {
+            mesh->level_start[level] = mesh->level_start[level + 1];
+        }
+    }
+
+    for (int q = 0; q < mesh->count; q++) {
+        Patch *p = &mesh->patches[q];
+        int first = mesh->level_start[p->level];
+        int in_level = mesh->level_start[p->level + 1] - first;
+        p->owner = (int)((long long)(q - first) * size / in_level);
+        p->parent = p->level > 0 ? find_patch(mesh, p->level - 1, p->pi / 2, p->pj / 2) : -1;
+        for (int c = 0; c < 4; c++) {
+            p->child[c] = p->level < config.max_level
+                ? find_patch(mesh, p->level + 1, 2 * p->pi + c / 2, 2 * p->pj + c % 2) : -1;
+            if (p->child[c] < 0) p->child[c] = -1;
+        }
+    }
+
+    // Mirror lists: same-level face neighbours feed ghost copies, coarse
+    // patches across coarse-fine edges feed interpolation on finer levels
+    for (int q = 0; q < mesh->count; q++) {
+        Patch *p = &mesh->patches[q];
+        for (int e = 0; e < 4; e++) {
+            int n = neighbour(mesh, p, e);
+            int kind = 0;
+            if (n == -1) {
+                n = coarse_neighbour(mesh, p, e);
+                kind = 1;
+            }
+            if (n < 0) continue;
+            Patch *src = &mesh->patches[n];
+            if (src->owner == p->owner) continue;
+            if (src->owner == rank) add_sender(src, kind, p->owner);
+            if (p->owner == rank) src->recv[kind] = 1;
+        }
+    }
+
+    for (int q = 0; q < mesh->count; q++) {
+        Patch *p = &mesh->patches[q];
+        if (p->owner == rank) {
+            for (int e = 0; e < 4; e++) {
+                p->creg[e] = (double *)calloc(P, sizeof(double));
+                p->freg[e] = (double *)calloc(P, sizeof(double));
+            }
+        }
+    }
+}
+
+// Send both time levels of every patch at this level to the ranks that
+// mirror it: kind 0 for same-level ghosts, kind 1 for finer-level interpolation
+void exchange_level(AmrMesh *mesh, int level, int kind, int rank) {
+    int first = mesh->level_start[level];
+    int last = mesh->level_start[level + 1];
+    MPI_Request *reqs = (MPI_Request *)malloc((size_t)(last - first) * 2 * MAX_MIRRORS * sizeof(MPI_Request));
+    int nreq = 0;
+
+    for (int q = first; q < last; q++) {
+        Patch *p = &mesh->patches[q];
+        if (p->owner == rank) {
+            for (int n = 0; n < p->nsend[kind]; n++) {
+                MPI_Isend(p->T, PW * PW, MPI_DOUBLE, p->send[kind][n], q * 8 + TAG_DATA, MPI_COMM_WORLD, &reqs[nreq++]);
+                MPI_Isend(p->T_old, PW * PW, MPI_DOUBLE, p->send[kind][n], q * 8 + TAG_DATA_OLD, MPI_COMM_WORLD, &reqs[nreq++]);
+            }
+        } else if (p->recv[kind]) {
+            if (!p->T) {
+                p->T = alloc_field();
+                p->T_old = alloc_field();
+            }
+            MPI_Irecv(p->T, PW * PW, MPI_DOUBLE, p->owner, q * 8 + TAG_DATA, MPI_COMM_WORLD, &reqs[nreq++]);
+            MPI_Irecv(p->T_old, PW * PW, MPI_DOUBLE, p->owner, q * 8 + TAG_DATA_OLD, MPI_COMM_WORLD, &reqs[nreq++]);
+        }
+    }
+    MPI_Waitall(nreq, reqs, MPI_STATUSES_IGNORE);
+    free(reqs);
+}
+
+// Value of the coarse patch c at the centre of fine global cell (fi, fj):
+// conservative piecewise-linear reconstruction (minmod slopes), blended
+// linearly in time between the coarse step's start (theta 0) and end (1)
+static double interpolate_coarse(const Patch *c, int fi, int fj, double theta) {
+    int ci = (fi >= 0 ? fi / 2 : (fi - 1) / 2) - c->pi * P + 1;
+    int cj = (fj >= 0 ? fj / 2 : (fj - 1) / 2) - c->pj * P + 1;
+    double oi = (fi & 1) ? 0.25 : -0.25;
+    double oj = (fj & 1) ? 0.25 : -0.25;
+
+    double value[2];
+    const double *fields[2] = {c->T_old, c->T};
+    for (int t = 0; t < 2; t++) {
+        const double *T = fields[t];
+        double centre = T[cidx(ci, cj)];
+        double si = minmod(T[cidx(ci + 1, cj)] - centre, centre - T[cidx(ci - 1, cj)]);
+        double sj = minmod(T[cidx(ci, cj + 1)] - centre, centre - T[cidx(ci, cj - 1)]);
+        value[t] = centre + si * oi + sj * oj;
+    }
+    return (1.0 - theta) * value[0] + theta * value[1];
+}
+
+// theta: where this level's current state sits inside the coarser level's step
+void fill_ghosts(AmrMesh *mesh, SimulationConfig config, int level, double theta, int rank) {
+    for (int q = mesh->level_start[level]; q < mesh->level_start[level + 1]; q++) {
+        Patch *p = &mesh->patches[q];
+        if (p->owner != rank) continue;
+
+        for (int e = 0; e < 4; e++) {
+            int n = neighbour(mesh, p, e);
+            const Patch *c = n == -1 ? &mesh->patches[coarse_neighbour(mesh, p, e)] : NULL;
+            double boundary = edge_temp(config, e);
+
+            for (int k = 1; k <= P; k++) {
+                int ghost, inner;
+                edge_cells(e, k, &ghost, &inner);
+                if (n == -2) {
+                    // Dirichlet value on the face between ghost and first cell
+                    p->T[ghost] = 2.0 * boundary - p->T[inner];
+                } else if (n >= 0) {
+                    int src_ghost, src_inner;
+                    edge_cells(e ^ 1, k, &src_ghost, &src_inner);
+                    p->T[ghost] = mesh->patches[n].T[src_inner];
+                } else {
+                    int fi = p->pi * P + ghost / PW - 1;
+                    int fj = p->pj * P + ghost % PW - 1;
+                    p->T[ghost] = interpolate_coarse(c, fi, fj, theta);
+                }
+            }
+        }
+    }
+}
+
+// Advance every owned patch of a level by one of its own steps, recording
+// interface fluxes for refluxing. Same 5-point kernel as the uniform solver.
+void step_level(AmrMesh *mesh, SimulationConfig config, int level, int rank) {
+    double h = level_h(config, level);
+    double dt = level_dt(config, level);
+    double dx2 = h * h;
+    double factor = config.alpha * dt;
+
+    for (int q = mesh->level_start[level]; q < mesh->level_start[level + 1]; q++) {
+        Patch *p = &mesh->patches[q];
+        if (p->owner != rank) continue;
+        double *T = p->T;
+        double *T_new = p->T_old;
+
+        for (int e = 0; e < 4; e++) {
+            int n = neighbour(mesh, p, e);
+            int coarse_side = n >= 0 && mesh->patches[n].child[0] >= 0;
+            int fine_side = n == -1;
+            for (int k = 1; k <= P; k++) {
+                int ghost, inner;
+                edge_cells(e, k, &ghost, &inner);
+                double flux = -factor * (T[ghost] - T[inner]);
+                if (coarse_side) p->creg[e][k - 1] = flux;
+                if (fine_side) p->freg[e][k - 1] += flux;
+            }
+        }
+
+        for (int i = 1; i <= P; i++) {
+            for (int j = 1; j <= P; j++) {
+                double d2T_dx2 = (T[cidx(i + 1, j)] - 2.0 * T[cidx(i, j)] + T[cidx(i - 1, j)]) / dx2;
+                double d2T_dy2 = (T[cidx(i, j + 1)] - 2.0 * T[cidx(i, j)] + T[cidx(i, j - 1)]) / dx2;
+                T_new[cidx(i, j)] = T[cidx(i, j)] + factor * (d2T_dx2 + d2T_dy2);
+            }
+        }
+
+        p->T_old = T;
+        p->T = T_new;
+        mesh->cell_updates += (long long)P * P;
+    }
+}
+
+// Replace parent cells covered by children with the children's averages
+void restrict_level(AmrMesh *mesh, int level, int rank) {
+    int first = mesh->level_start[level + 1];
+    int last = mesh->level_start[level + 2];
+    int half = P / 2;
+    MPI_Request *reqs = (MPI_Request *)malloc((size_t)(last - first + 1) * sizeof(MPI_Request));
+    double **blocks = (double **)calloc((size_t)(last - first + 1), sizeof(double *));
+    int nreq = 0;
+
+    for (int q = first; q < last; q++) {
+        Patch *f = &mesh->patches[q];
+        Patch *p = &mesh->patches[f->parent];
+        if (f->owner != rank && p->owner != rank) continue;
+
+        double *block = (double *)malloc((size_t)half * half * sizeof(double));
+        blocks[q - first] = block;
+        if (f->owner == rank) {
+            for (int a = 0; a < half; a++) {
+                for (int b = 0; b < half; b++) {
+                    block[a * half + b] = 0.25 * (f->T[cidx(2 * a + 1, 2 * b + 1)] + f->T[cidx(2 * a + 2, 2 * b + 1)] +
+                                                  f->T[cidx(2 * a + 1, 2 * b + 2)] + f->T[cidx(2 * a + 2, 2 * b + 2)]);
+                }
+            }
+            if (p->owner != rank) {
+                MPI_Isend(block, half * half, MPI_DOUBLE, p->owner, q * 8 + TAG_RESTRICT, MPI_COMM_WORLD, &reqs[nreq++]);
+            }
+        } else {
+            MPI_Irecv(block, half * half, MPI_DOUBLE, f->owner, q * 8 + TAG_RESTRICT, MPI_COMM_WORLD, &reqs[nreq++]);
+        }
+    }
+    MPI_Waitall(nreq, reqs, MPI_STATUSES_IGNORE);
+
+    for (int q = first; q < last; q++) {
+        Patch *f = &mesh->patches[q];
+        Patch *p = &mesh->patches[f->parent];
+        if (p->owner == rank) {
+            int a0 = (f->pi % 2) * half;
+            int b0 = (f->pj % 2) * half;
+            for (int a = 0; a < half; a++) {
+                for (int b = 0; b < half; b++) {
+                    p->T[cidx(a0 + a + 1, b0 + b + 1)] = blocks[q - first][a * half + b];
+                }
+            }
+        }
+        free(blocks[q - first]);
+    }
+    free(blocks);
+    free(reqs);
+}
+
+// Make the coarse cells next to a refined region see the fine fluxes
+// summed over the subcycles instead of their own coarse flux
+void reflux_level(AmrMesh *mesh, SimulationConfig config, int level, int rank) {
+    int first = mesh->level_start[level + 1];
+    int last = mesh->level_start[level + 2];
+    int half = P / 2;
+    double inv_h2 = 1.0 / (level_h(config, level) * level_h(config, level));
+    int count = (last - first) * 4;
+    MPI_Request *reqs = (MPI_Request *)malloc((size_t)(count + 1) * sizeof(MPI_Request));
+    double **sums = (double **)calloc((size_t)(count + 1), sizeof(double *));
+    int nreq = 0;
+
+    for (int q = first; q < last; q++) {
+        Patch *f = &mesh->patches[q];
+        for (int e = 0; e < 4; e++) {
+            if (neighbour(mesh, f, e) != -1) continue;
+            Patch *c = &mesh->patches[coarse_neighbour(mesh, f, e)];
+            if (f->owner != rank && c->owner != rank) continue;
+
+            double *sum = (double *)malloc((size_t)half * sizeof(double));
+            sums[(q - first) * 4 + e] = sum;
+            if (f->owner == rank) {
+                for (int m = 0; m < half; m++) {
+                    sum[m] = f->freg[e][2 * m] + f->freg[e][2 * m + 1];
+                }
+                if (c->owner != rank) {
+                    MPI_Isend(sum, half, MPI_DOUBLE, c->owner, q * 8 + TAG_REFLUX + e, MPI_COMM_WORLD, &reqs[nreq++]);
+                }
+            } else {
+                MPI_Irecv(sum, half, MPI_DOUBLE, f->owner, q * 8 + TAG_REFLUX + e, MPI_COMM_WORLD, &reqs[nreq++]);
+            }
+        }
+    }
+    MPI_Waitall(nreq, reqs, MPI_STATUSES_IGNORE);
+
+    for (int q = first; q < last; q++) {
+        Patch *f = &mesh->patches[q];
+        for (int e = 0; e < 4; e++) {
+            double *sum = sums[(q - first) * 4 + e];
+            if (!sum) continue;
+            Patch *c = &mesh->patches[coarse_neighbour(mesh, f, e)];
+            if (c->owner == rank) {
+                int ce = e ^ 1;
+                int offset = (e < 2 ? f->pj % 2 : f->pi % 2) * half;
+                for (int m = 0; m < half; m++) {
+                    int ghost, inner;
+                    edge_cells(ce, offset + m + 1, &ghost, &inner);
+                    c->T[inner] += (sum[m] + c->creg[ce][offset + m]) * inv_h2;
+                }
+            }
+            free(sum);
+        }
+    }
+    free(sums);
+    free(reqs);
+}
+
+// One step of `level`, followed by SUBCYCLES steps of the next finer level,
+// restriction onto this level and refluxing of the coarse-fine fluxes
+void advance_level(AmrMesh *mesh, SimulationConfig config, int level, double theta, int rank) {
+    exchange_level(mesh, level, 0, rank);
+    fill_ghosts(mesh, config, level, theta, rank);
+    step_level(mesh, config, level, rank);
+
+    if (level >= mesh->depth) return;
+
+    // Ghosts of the new state feed the finer level's interpolation
+    exchange_level(mesh, level, 0, rank);
+    fill_ghosts(mesh, config, level, theta + 1.0 / SUBCYCLES, rank);
+    exchange_level(mesh, level, 1, rank);
+
+    for (int q = mesh->level_start[level + 1]; q < mesh->level_start[level + 2]; q++) {
+        Patch *f = &mesh->patches[q];
+        if (f->owner != rank) continue;
+        for (int e = 0; e < 4; e++) {
+            memset(f->freg[e], 0, P * sizeof(double));
+        }
+    }
+
+    for (int s = 0; s < SUBCYCLES; s++) {
+        advance_level(mesh, config, level + 1, (double)s / SUBCYCLES, rank);
+    }
+    restrict_level(mesh, level, rank);
+    reflux_level(mesh, config, level, rank);
+}
+
+// Largest jump between neighbouring cells of a patch, counting the jump
+// to a Dirichlet face as twice the face-to-cell difference
+static double gradient_indicator(const Patch *p, SimulationConfig config) {
+    double max_jump = 0.0;
+    for (int i = 1; i <= P; i++) {
+        for (int j = 1; j <= P; j++) {
+            if (i < P) max_jump = fmax(max_jump, fabs(p->T[cidx(i + 1, j)] - p->T[cidx(i, j)]));
+            if (j < P) max_jump = fmax(max_jump, fabs(p->T[cidx(i, j + 1)] - p->T[cidx(i, j)]));
+        }
+    }
+    int n = patches_per_side(p->level);
+    for (int e = 0; e < 4; e++) {
+        int ni = p->pi + edge_di[e], nj = p->pj + edge_dj[e];
+        if (ni >= 0 && nj >= 0 && ni < n && nj < n) continue;
+        for (int k = 1; k <= P; k++) {
+            int ghost, inner;
+            edge_cells(e, k, &ghost, &inner);
+            max_jump = fmax(max_jump, 2.0 * fabs(edge_temp(config, e) - p->T[inner]));
+        }
+    }
+    return max_jump;
+}
+
+// Add the four children of the level-1 patch containing (level, pi, pj),
+// creating coarser ancestors first when needed
+static void ensure_patch(int **exists, int level, int pi, int pj) {
+    int n = patches_per_side(level);
+    if (exists[level][pi * n + pj]) return;
+    ensure_patch(exists, level - 1, pi / 2, pj / 2);
+    int base_i = pi & ~1, base_j = pj & ~1;
+    for (int c = 0; c < 4; c++) {
+        exists[level][(base_i + c / 2) * n + base_j + c % 2] = 1;
+    }
+}
+
+// Conservative linear prolongation of a parent quadrant into a child patch
+static void prolongate(const Patch *parent, int di, int dj, double *child) {
+    int half = P / 2;
+    for (int a = 0; a < P; a++) {
+        for (int b = 0; b < P; b++) {
+            int ca = di * half + a / 2 + 1;
+            int cb = dj * half + b / 2 + 1;
+            const double *T = parent->T;
+            double centre = T[cidx(ca, cb)];
+            double si = (ca > 1 && ca < P) ? minmod(T[cidx(ca + 1, cb)] - centre, centre - T[cidx(ca - 1, cb)]) : 0.0;
+            double sj = (cb > 1 && cb < P) ? minmod(T[cidx(ca, cb + 1)] - centre, centre - T[cidx(ca, cb - 1)]) : 0.0;
+            child[cidx(a + 1, b + 1)] = centre + si * ((a & 1) ? 0.25 : -0.25) + sj * ((b & 1) ? 0.25 : -0.25);
+        }
+    }
+}
+
+// Collective: flag patches from the gradient indicator, rebuild a 2:1
+// balanced quadtree, repartition along the Z-order curve and move data.
+// Returns 1 when the mesh changed.
+int regrid(AmrMesh **mesh_ptr, AmrMesh **spare_ptr, SimulationConfig config, int rank, int size, int refine_all) {
+    AmrMesh *old = *mesh_ptr;
+    AmrMesh *mesh = *spare_ptr;
+
+    int *flags = (int *)calloc(old->count, sizeof(int));
+    int *all_flags = (int *)calloc(old->count, sizeof(int));
+    for (int q = 0; q < old->count; q++) {
+        Patch *p = &old->patches[q];
+        if (p->owner != rank || p->child[0] >= 0) continue;
+        double indicator = gradient_indicator(p, config);
+        if ((refine_all || indicator > REFINE_THRESHOLD) && p->level < config.max_level) {
+            flags[q] = 1;
+        } else if (!refine_all && indicator < COARSEN_THRESHOLD) {
+            flags[q] = 2;
+        }
+    }
+    MPI_Allreduce(flags, all_flags, old->count, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+    int *exists[MAX_LEVEL + 1] = {NULL};
+    for (int level = 0; level <= config.max_level; level++) {
+        int n = patches_per_side(level);
+        exists[level] = (int *)calloc((size_t)n * n, sizeof(int));
+    }
+    for (int q = 0; q < old->count; q++) {
+        Patch *p = &old->patches[q];
+        exists[p->level][p->pi * patches_per_side(p->level) + p->pj] = 1;
+    }
+
+    // Coarsen families whose four leaves are all smooth, then refine
+    for (int q = 0; q < old->count; q++) {
+        Patch *p = &old->patches[q];
+        if (p->child[0] < 0) continue;
+        int smooth = 1;
+        for (int c = 0; c < 4; c++) {
+            smooth = smooth && p->child[c] >= 0 && all_flags[p->child[c]] == 2;
+        }
+        if (smooth) {
+            int n = patches_per_side(p->level + 1);
+            for (int c = 0; c < 4; c++) {
+                exists[p->level + 1][(2 * p->pi + c / 2) * n + 2 * p->pj + c % 2] = 0;
+            }
+        }
+    }
+    for (int q = 0; q < old->count; q++) {
+        Patch *p = &old->patches[q];
+        if (all_flags[q] == 1) {
+            ensure_patch(exists, p->level + 1, 2 * p->pi, 2 * p->pj);
+        }
+    }
+
+    // 2:1 balance: the coarse patches across a patch's parent edges must exist
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int level = config.max_level; level >= 2; level--) {
+            int n = patches_per_side(level);
+            int nc = patches_per_side(level - 1);
+            for (int s = 0; s < n * n; s++) {
+                if (!exists[level][s]) continue;
+                for (int e = 0; e < 4; e++) {
+                    int ci = s / n / 2 + edge_di[e], cj = s % n / 2 + edge_dj[e];
+                    if (ci < 0 || cj < 0 || ci >= nc || cj >= nc) continue;
+                    if (!exists[level - 1][ci * nc + cj]) {
+                        ensure_patch(exists, level - 1, ci, cj);
+                        changed = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    build_mesh(mesh, exists, config, rank, size);
+
+    int same = mesh->count == old->count;
+    for (int q = 0; same && q < mesh->count; q++) {
+        same = old->patches[q].level == mesh->patches[q].level &&
+               old->patches[q].pi == mesh->patches[q].pi && old->patches[q].pj == mesh->patches[q].pj;
+    }
+
+    // Carry over surviving patches, moving them to their new owners
+    MPI_Request *reqs = (MPI_Request *)malloc((size_t)(mesh->count + old->count + 1) * sizeof(MPI_Request));
+    int nreq = 0;
+    for (int q = 0; q < mesh->count; q++) {
+        Patch *p = &mesh->patches[q];
+        int o = find_patch(old, p->level, p->pi, p->pj);
+        if (o < 0) continue;
+        Patch *prev = &old->patches[o];
+        if (p->owner == rank) {
+            p->T = alloc_field();
+            p->T_old = alloc_field();
+            if (prev->owner == rank) {
+                memcpy(p->T, prev->T, PW * PW * sizeof(double));
+            } else {
+                MPI_Irecv(p->T, PW * PW, MPI_DOUBLE, prev->owner, q * 8 + TAG_MIGRATE, MPI_COMM_WORLD, &reqs[nreq++]);
+            }
+        } else if (prev->owner == rank) {
+            MPI_Isend(prev->T, PW * PW, MPI_DOUBLE, p->owner, q * 8 + TAG_MIGRATE, MPI_COMM_WORLD, &reqs[nreq++]);
+        }
+    }
+    MPI_Waitall(nreq, reqs, MPI_STATUSES_IGNORE);
+
+    // New patches are filled from their parents, coarse levels first
+    for (int level = 1; level <= mesh->depth; level++) {
+        nreq = 0;
+        double **blocks = (double **)calloc((size_t)mesh->count, sizeof(double *));
+        for (int q = mesh->level_start[level]; q < mesh->level_start[level + 1]; q++) {
+            Patch *p = &mesh->patches[q];
+            if (find_patch(old, p->level, p->pi, p->pj) >= 0) continue;
+            Patch *parent = &mesh->patches[p->parent];
+            if (p->owner == rank && !p->T) {
+                p->T = alloc_field();
+                p->T_old = alloc_field();
+            }
+            if (parent->owner == rank) {
+                double *child = p->owner == rank ? p->T : (blocks[q] = alloc_field());
+                prolongate(parent, p->pi % 2, p->pj % 2, child);
+                if (p->owner != rank) {
+                    MPI_Isend(child, PW * PW, MPI_DOUBLE, p->owner, q * 8 + TAG_MIGRATE, MPI_COMM_WORLD, &reqs[nreq++]);
+                }
+            } else if (p->owner == rank) {
+                MPI_Irecv(p->T, PW * PW, MPI_DOUBLE, parent->owner, q * 8 + TAG_MIGRATE, MPI_COMM_WORLD, &reqs[nreq++]);
+            }
+        }
+        MPI_Waitall(nreq, reqs, MPI_STATUSES_IGNORE);
+        for (int q = 0; q < mesh->count; q++) {
+            free(blocks[q]);
+        }
+        free(blocks);
+    }
+    free(reqs);
+
+    for (int q = 0; q < old->count; q++) {
+        free_patch_data(&old->patches[q]);
+    }
+    for (int level = 0; level <= config.max_level; level++) {
+        free(exists[level]);
+    }
+    free(flags);
+    free(all_flags);
+
+    mesh->cell_updates = old->cell_updates;
+    *mesh_ptr = mesh;
+    *spare_ptr = old;
+    return !same;
+}
+
+// Max |Laplacian| over leaf cells whose stencil stays inside the patch
+double compute_local_residual(const AmrMesh *mesh, SimulationConfig config, int rank) {
+    double max_res = 0.0;
+    for (int q = 0; q < mesh->count; q++) {
+        const Patch *p = &mesh->patches[q];
+        if (p->owner != rank || p->child[0] >= 0) continue;
+        double h = level_h(config, p->level);
+        double dx2 = h * h;
+        for (int i = 2; i < P; i++) {
+            for (int j = 2; j < P; j++) {
+                double laplacian = (p->T[cidx(i + 1, j)] - 2.0 * p->T[cidx(i, j)] + p->T[cidx(i - 1, j)]) / dx2 +
+                                   (p->T[cidx(i, j + 1)] - 2.0 * p->T[cidx(i, j)] + p->T[cidx(i, j - 1)]) / dx2;
+                double res = fabs(laplacian);
+                if (res > max_res) {
+                    max_res = res;
+                }
+            }
+        }
+    }
+    return max_res;
+}
+
+// Sample the composite (leaf) solution on the finest-level grid and write
+// it like the uniform solvers do; the leaf layout goes to a side file
+void write_composite(const AmrMesh *mesh, SimulationConfig config, int rank, const char *filename) {
+    size_t cells = (size_t)config.nx * config.ny;
+    double *local = (double *)calloc(cells, sizeof(double));
+    double *global = rank == 0 ? (double *)malloc(cells * sizeof(double)) : NULL;
+
+    for (int q = 0; q < mesh->count; q++) {
+        const Patch *p = &mesh->patches[q];
+        if (p->owner != rank || p->child[0] >= 0) continue;
+        int scale = 1 << (config.max_level - p->level);
+        for (int a = 0; a < P * scale; a++) {
+            for (int b = 0; b < P * scale; b++) {
+                size_t gi = (size_t)(p->pi * P * scale + a);
+                size_t gj = (size_t)(p->pj * P * scale + b);
+                local[gi * config.ny + gj] = p->T[cidx(a / scale + 1, b / scale + 1)];
+            }
+        }
+    }
+    MPI_Reduce(local, global, (int)cells, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    free(local);
+    if (rank != 0) return;
+
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "[root] ERROR: Unable to open %s for writing\n", filename);
+        free(global);
+        return;
+    }
+    for (int i = 0; i < config.nx; i++) {
+        for (int j = 0; j < config.ny; j++) {
+            fprintf(fp, "%.6f ", global[(size_t)i * config.ny + j]);
+        }
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+    free(global);
+
+    // Leaf patches as "level row col size" in finest-grid cells
+    char layout[128];
+    snprintf(layout, sizeof(layout), "patches_%s", filename);
+    fp = fopen(layout, "w");
+    if (fp) {
+        for (int q = 0; q < mesh->count; q++) {
+            const Patch *p = &mesh->patches[q];
+            if (p->child[0] >= 0) continue;
+            int scale = 1 << (config.max_level - p->level);
+            fprintf(fp, "%d %d %d %d\n", p->level, p->pi * P * scale, p->pj * P * scale, P * scale);
+        }
+        fclose(fp);
+    }
+    printf("[root] Saved %s\n", filename);
+}
+
+void print_level_summary(const AmrMesh *mesh, int rank) {
+    if (rank != 0) return;
+    printf("[root] Patches per level:");
+    for (int level = 0; level <= mesh->depth; level++) {
+        printf(" L%d=%d", level, mesh->level_start[level + 1] - mesh->level_start[level]);
+    }
+    printf("\n");
+}
+
+void print_header(SimulationConfig config, int rank, int size) {
+    if (rank != 0) return;
+    printf("==============================================\n");
+    printf("   MPI 2D Heat Equation Simulation (AMR)\n");
+    printf("==============================================\n");
+    printf("Base grid: %d x %d (%dx%d patches of %d^2 cells)\n",
+           BASE_PATCHES * P, BASE_PATCHES * P, BASE_PATCHES, BASE_PATCHES, P);
+    printf("Levels: %d (finest equivalent %d x %d)%s\n",
+           config.max_level + 1, config.nx, config.ny, config.uniform ? " [uniform]" : "");
+    printf("Level-0 steps: %d (output every %d, regrid every %d)\n",
+           config.steps, config.output_interval, config.regrid_interval);
+    printf("Diffusivity (alpha): %.3f\n", config.alpha);
+    printf("dt0 = %.6f, h0 = %.5f, subcycles per level: %d\n", config.dt, config.h0, SUBCYCLES);
+    printf("Boundary temps: top=%.1f, bottom=%.1f, left=%.1f, right=%.1f\n",
+           config.top_temp, config.bottom_temp, config.left_temp, config.right_temp);
+    printf("MPI tasks: %d\n", size);
+    printf("==============================================\n\n");
+}
+
+void validate_parameters(SimulationConfig config, int rank) {
+    // dt and h^2 shrink by the same factor per level, so level 0 decides
+    double stable_dt = 0.25 * config.h0 * config.h0 / config.alpha;
+    if (rank == 0) {
+        if (config.dt > stable_dt) {
+            printf("[root] WARNING: dt=%.6f exceeds stable dt=%.6f\n", config.dt, stable_dt);
+            printf("        Reduce dt or coarsen the base grid for stability.\n");
+        } else {
+            printf("[root] Stability check OK (dt=%.6f <= %.6f)\n\n", config.dt, stable_dt);
+        }
+    }
+}
+
+void parse_args(int argc, char **argv, SimulationConfig *config, int rank) {
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--uniform") == 0) {
+            config->uniform = 1;
+        } else if (strcmp(argv[a], "--max-level") == 0 && a + 1 < argc) {
+            config->max_level = atoi(argv[++a]);
+            if (config->max_level < 0 || config->max_level > MAX_LEVEL) {
+                if (rank == 0) {
+                    fprintf(stderr, "[root] ERROR: --max-level must be between 0 and %d\n", MAX_LEVEL);
+                }
+                MPI_Finalize();
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            if (rank == 0) {
+                fprintf(stderr, "[root] ERROR: Unknown or incomplete option %s\n", argv[a]);
+                printf("Usage: %s [--uniform] [--max-level N]\n", argv[0]);
+            }
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    SimulationConfig config = {
+        .alpha = ALPHA, .h0 = DOMAIN_SIZE / (BASE_PATCHES * P), .dt = DT,
+        .steps = STEPS,
+        .output_interval = OUTPUT_INTERVAL,
+        .regrid_interval = REGRID_INTERVAL,
+        .max_level = MAX_LEVEL,
+        .uniform = 0,
+        .top_temp = TOP_TEMP, .bottom_temp = BOTTOM_TEMP,
+        .left_temp = LEFT_TEMP, .right_temp = RIGHT_TEMP
+    };
+    parse_args(argc, argv, &config, rank);
+    config.nx = config.ny = (BASE_PATCHES * P) << config.max_level;
+
+    print_header(config, rank, size);
+    validate_parameters(config, rank);
+
+    AmrMesh *mesh = (AmrMesh *)calloc(1, sizeof(AmrMesh));
+    AmrMesh *spare = (AmrMesh *)calloc(1, sizeof(AmrMesh));
+    if (!mesh || !spare) {
+        fprintf(stderr, "[rank %d] ERROR: allocation failed\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int level = 0; level <= config.max_level; level++) {
+        int n = patches_per_side(level);
+        mesh->slot[level] = (int *)malloc((size_t)n * n * sizeof(int));
+        spare->slot[level] = (int *)malloc((size_t)n * n * sizeof(int));
+    }
+
+    // Level 0 covers the domain; the initial hierarchy grows one level per
+    // regrid from the boundary jumps of the initial state
+    int *exists[MAX_LEVEL + 1] = {NULL};
+    for (int level = 0; level <= config.max_level; level++) {
+        int n = patches_per_side(level);
+        exists[level] = (int *)calloc((size_t)n * n, sizeof(int));
+    }
+    for (int s = 0; s < BASE_PATCHES * BASE_PATCHES; s++) {
+        exists[0][s] = 1;
+    }
+    build_mesh(mesh, exists, config, rank, size);
+    for (int level = 0; level <= config.max_level; level++) {
+        free(exists[level]);
+    }
+    for (int q = 0; q < mesh->count; q++) {
+        if (mesh->patches[q].owner == rank) {
+            mesh->patches[q].T = alloc_field();
+            mesh->patches[q].T_old = alloc_field();
+        }
+    }
+    for (int level = 0; level < config.max_level; level++) {
+        regrid(&mesh, &spare, config, rank, size, config.uniform);
+    }
+    print_level_summary(mesh, rank);
+
+    write_composite(mesh, config, rank, "output_amr_step_0000.txt");
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime();
+    double residual = 0.0;
+    int regrids = 0;
+
+    for (int step = 0; step < config.steps; step++) {
+        advance_level(mesh, config, 0, 0.0, rank);
+
+        if (!config.uniform && (step + 1) % config.regrid_interval == 0) {
+            regrids += regrid(&mesh, &spare, config, rank, size, 0);
+        }
+
+        if ((step + 1) % config.output_interval == 0) {
+            double local_res = compute_local_residual(mesh, config, rank);
+            MPI_Allreduce(&local_res, &residual, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+            char fname[64];
+            snprintf(fname, sizeof(fname), "output_amr_step_%04d.txt", step + 1);
+            write_composite(mesh, config, rank, fname);
+            if (rank == 0) {
+                printf("[root] Completed step %d / %d | residual %.2e\n", step + 1, config.steps, residual);
+            }
+            print_level_summary(mesh, rank);
+        }
+    }
+
+    double local_elapsed = MPI_Wtime() - t0;
+    double max_elapsed = 0.0;
+    long long cell_updates = 0;
+    MPI_Reduce(&local_elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&mesh->cell_updates, &cell_updates, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    // Final output
+    write_composite(mesh, config, rank, "output_amr_final.txt");
+
+    if (rank == 0) {
+        double uniform_updates = (double)config.nx * config.ny * config.steps *
+                                 pow(SUBCYCLES, config.max_level);
+        printf("\nSimulation complete.\n");
+        printf("Elapsed (max across ranks): %.3f s\n", max_elapsed);
+        printf("Throughput: %.2f level-0 steps/s\n", config.steps / max_elapsed);
+        printf("Regrids that changed the mesh: %d\n", regrids);
+        printf("Cell-updates: %lld (uniform finest grid: %.0f, %.1fx fewer)\n",
+               cell_updates, uniform_updates, uniform_updates / cell_updates);
+        printf("Snapshots: output_amr_step_*.txt + output_amr_final.txt (leaf layout in patches_*.txt)\n");
+    }
+
+    for (int q = 0; q < mesh->count; q++) {
+        free_patch_data(&mesh->patches[q]);
+    }
+    for (int level = 0; level <= config.max_level; level++) {
+        free(mesh->slot[level]);
+        free(spare->slot[level]);
+    }
+    free(mesh);
+    free(spare);
+
+    MPI_Finalize();
+    return 0;
+}
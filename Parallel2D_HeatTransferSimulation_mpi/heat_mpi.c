@@ -1,8 +1,14 @@
 #include <mpi.h>
+#include <fcntl.h>
 #include <math.h>
+#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "heat.h"
 
 // Default global configuration
 #define NX 100
@@ -15,12 +21,55 @@
 #define OUTPUT_INTERVAL 100
 #define RESIDUAL_INTERVAL 100
 
+// Run configuration: these defaults < config.json (or --config FILE)
+// < --set KEY=VALUE < dedicated options such as --bc or --halo
+#define CONFIG_FILE "config.json"
+
 // Boundary temperatures
 #define TOP_TEMP 100.0
 #define BOTTOM_TEMP 100.0
 #define LEFT_TEMP 0.0
 #define RIGHT_TEMP 0.0
 
+// Checkpoint/restart (interval 0 = only on SIGINT/SIGTERM)
+#define CHECKPOINT_INTERVAL 0
+#define CHECKPOINT_FILE "checkpoint.bin"
+#define SIGNAL_POLL_INTERVAL 10
+
+// Measured-cost load balancing (interval 0 = static even split)
+#define REBALANCE_INTERVAL 0
+#define REBALANCE_THRESHOLD 1.05
+
+// Halo exchange modes
+#define HALO_SENDRECV 0
+#define HALO_SHARED 1
+#define HALO_NONBLOCKING 2
+#define HALO_RMA 3
+#define HALO_MODE_COUNT 4
+#define HALO_MODE HALO_SHARED
+
+// Spatial order of the stencil: 2 (5-point) or 4 (wide 9-point cross,
+// Dirichlet edges only). The wide cross reads two rows past the stripe,
+// so it exchanges 2-deep halos (sendrecv/nonblocking only).
+#define STENCIL_ORDER 2
+
+// Parareal time-parallel mode (1 slice = ordinary time stepping). Each
+// slice is advanced by the fine explicit step while a coarse implicit
+// Euler propagator, COARSE_STEPS steps per slice solved by CG, carries
+// corrections from slice to slice until the slice-end states move by
+// less than PARAREAL_TOL.
+#define PARAREAL_SLICES 1
+#define PARAREAL_COARSE_STEPS 10
+#define PARAREAL_TOL 1e-6
+#define PARAREAL_CG_TOL 1e-8
+
+// Parameter sweeps (--sweep FILE): world rank 0 hands out one configuration
+// at a time to groups of SWEEP_GROUP_SIZE ranks, each running it with the
+// ordinary row decomposition on its own communicator
+#define SWEEP_GROUP_SIZE 1
+#define SWEEP_NAME_MAX 64
+#define SWEEP_SUMMARY "sweep_summary.txt"
+
 typedef struct {
     int nx, ny;
     double alpha, dx, dy, dt;
@@ -28,12 +77,94 @@ typedef struct {
     int output_interval;
     int residual_interval;
     double top_temp, bottom_temp, left_temp, right_temp;
+    heat_bc_type bc_type[HEAT_EDGE_COUNT];  // per edge, dirichlet unless set with --bc
+    double bc_param[HEAT_EDGE_COUNT];       // neumann: outward dT/dn; robin: transfer coefficient
+    int checkpoint_interval;
+    const char *checkpoint_path;
+    const char *restart_path;
+    int rebalance_interval;
+    int halo_mode;
+    const char *backend_name;   // libheat stencil backend, NULL for $HEAT_BACKEND/scalar
+    int jit;                    // compile a kernel specialized for the local stripe at startup
+    int order;                  // STENCIL_ORDER unless set with --order
+    int inplace;                // update the stripe over itself, no T_new
+    const char *mask_path;      // geometry mask (holes, fixed-temperature cells), NULL for a full rectangle
+    const char *materials_path; // per-cell diffusivity map, NULL for a uniform alpha
+    int float_coeffs;           // store the materials' face coefficients as float
+    int axisymmetric;           // rows are z, columns are r with the axis at column 0
+    int time_slices;            // Parareal slices along the time axis, 1 to step sequentially
+    int coarse_steps;           // implicit Euler steps of the coarse propagator per slice
+    double parareal_tol;        // max change of the slice-end states that ends the iteration
+    const char *output_prefix;  // prepended to every snapshot name, "" for none
+    const char *sweep_path;     // --sweep configuration list, NULL for a single run
+    int group_size;             // ranks per sweep group
 } SimulationConfig;
 
+// Storage and neighbour wiring for the T/T_new stripes. In HALO_SHARED mode
+// every rank's pair lives in one MPI-3 shared window per node, laid out as
+// [T][T_new], so node-local neighbours can read each other's boundary rows
+// in place. All ranks swap buffers every step and (re)allocate together, so
+// a neighbour's current buffer always has the same index as our own.
+// In HALO_RMA mode neighbours MPI_Put their boundary rows into a fixed
+// two-row landing window, so it survives rebalancing unchanged.
+// With depth > 1 (4th order) each stripe carries depth halo rows on either
+// side, rows 1-depth .. local_nx+depth; T still points at local row 0.
+typedef struct {
+    int mode;
+    int depth;
+    MPI_Comm node_comm;
+    MPI_Win win;
+    double *segment;
+    int up_local, down_local;
+    const double *up_segment, *down_segment;
+    size_t up_stripe, down_stripe;
+    MPI_Win rma_win;
+    double *rma_halo;
+    MPI_Group rma_group;
+} HaloContext;
+
+static const char *halo_mode_names[HALO_MODE_COUNT] = {"sendrecv", "shm", "nonblocking", "rma"};
+
 static inline int idx(int i, int j, int ny) {
     return i * ny + j;
 }
 
+// Halo rows needed on each side of a stripe
+static inline int halo_depth(SimulationConfig config) {
+    return config.order == 4 ? 2 : 1;
+}
+
+static volatile sig_atomic_t stop_requested = 0;
+
+// Ranks of the running simulation: MPI_COMM_WORLD, or one sweep group
+static MPI_Comm sim_comm;
+
+// Geometry from --mask, parsed by every rank (kind == NULL for a full
+// rectangle). Rows are weighted by their active cells when partitioning.
+static heat_mask mask;
+static int *row_cells;
+
+// Diffusivity map from --materials (kind == NULL for a uniform alpha).
+// Every rank keeps the whole map but face coefficients for its own rows.
+static heat_materials materials;
+
+// Radial weights from --axisymmetric (inner == NULL on a Cartesian grid).
+// They depend only on the columns, so every stripe shares one set.
+static heat_axisym axisym;
+
+static void request_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+// Leave after an error in a run. A sweep group cannot tell the other
+// groups, so it takes the whole job down.
+static void fail_run(void) {
+    if (sim_comm != MPI_COMM_WORLD) MPI_Abort(MPI_COMM_WORLD, 1);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+}
+
 void distribute_rows(int nx, int size, int *counts, int *displs) {
     int base = nx / size;
     int extra = nx % size;
@@ -45,6 +176,77 @@ void distribute_rows(int nx, int size, int *counts, int *displs) {
     }
 }
 
+// Contiguous cuts giving rank r about speeds[r] / sum(speeds) of the total
+// row weight (active cells), with at least min_rows rows each
+static void cut_by_weight(int nx, int size, const double *speeds, const int *weights, int min_rows,
+                          int *counts) {
+    double total_speed = 0.0, total_weight = 0.0;
+    for (int r = 0; r < size; r++) total_speed += speeds[r];
+    for (int i = 0; i < nx; i++) total_weight += weights[i];
+
+    int row = 0;
+    double acc = 0.0, goal = 0.0;
+    for (int r = 0; r < size; r++) {
+        goal += total_weight * speeds[r] / total_speed;
+        int end = r == size - 1 ? nx : row + min_rows;
+        for (int i = row; i < end; i++) acc += weights[i];
+        // Take a row while that leaves us nearer the goal and the later ranks their minimum
+        while (r < size - 1 && end < nx - min_rows * (size - 1 - r) && acc + 0.5 * weights[end] <= goal) {
+            acc += weights[end++];
+        }
+        counts[r] = end - row;
+        row = end;
+    }
+}
+
+// Split rows proportionally to each rank's measured speed (rows, or with
+// `weights` active cells, per second), keeping at least `depth` rows per
+// rank when nx allows it, so every halo row comes from the direct neighbour
+void weighted_partition(int nx, int size, const double *speeds, const int *weights, int depth,
+                        int *counts, int *displs) {
+    int min_rows = nx >= depth * size ? depth : 0;
+    if (weights != NULL) {
+        cut_by_weight(nx, size, speeds, weights, min_rows, counts);
+        int offset = 0;
+        for (int r = 0; r < size; r++) {
+            displs[r] = offset;
+            offset += counts[r];
+        }
+        return;
+    }
+    int spare = nx - min_rows * size;
+    double total_speed = 0.0;
+    for (int r = 0; r < size; r++) {
+        total_speed += speeds[r];
+    }
+
+    // Largest-remainder rounding so the counts sum to nx exactly
+    int assigned = 0;
+    double *remainder = (double *)malloc(size * sizeof(double));
+    for (int r = 0; r < size; r++) {
+        double share = spare * speeds[r] / total_speed;
+        counts[r] = min_rows + (int)share;
+        remainder[r] = share - (int)share;
+        assigned += counts[r];
+    }
+    while (assigned < nx) {
+        int best = 0;
+        for (int r = 1; r < size; r++) {
+            if (remainder[r] > remainder[best]) best = r;
+        }
+        counts[best]++;
+        remainder[best] = -1.0;
+        assigned++;
+    }
+    free(remainder);
+
+    int offset = 0;
+    for (int r = 0; r < size; r++) {
+        displs[r] = offset;
+        offset += counts[r];
+    }
+}
+
 void initialize_local(double *T, SimulationConfig config, int local_nx, int start_row) {
     int ny = config.ny;
 
@@ -62,7 +264,7 @@ void initialize_local(double *T, SimulationConfig config, int local_nx, int star
                 value = config.top_temp;
             } else if (global_i == config.nx - 1) {
                 value = config.bottom_temp;
-            } else if (j == 0) {
+            } else if (j == 0 && !config.axisymmetric) {
                 value = config.left_temp;
             } else if (j == ny - 1) {
                 value = config.right_temp;
@@ -107,17 +309,18 @@ void exchange_halos(double *T, SimulationConfig config, int local_nx, int rank,
     int down = rank + 1;
     if (up < 0) up = MPI_PROC_NULL;
     if (down >= size) down = MPI_PROC_NULL;
+    int depth = halo_depth(config);
 
-    // Send first real row upward, receive bottom halo from below
+    // Send first real row(s) upward, receive bottom halo from below
     MPI_Sendrecv(
-        &T[idx(1, 0, ny)], ny, MPI_DOUBLE, up, 0,
-        &T[idx(local_nx + 1, 0, ny)], ny, MPI_DOUBLE, down, 0,
+        &T[idx(1, 0, ny)], depth * ny, MPI_DOUBLE, up, 0,
+        &T[idx(local_nx + 1, 0, ny)], depth * ny, MPI_DOUBLE, down, 0,
         comm, MPI_STATUS_IGNORE);
 
-    // Send last real row downward, receive top halo from above
+    // Send last real row(s) downward, receive top halo from above
     MPI_Sendrecv(
-        &T[idx(local_nx, 0, ny)], ny, MPI_DOUBLE, down, 1,
-        &T[idx(0, 0, ny)], ny, MPI_DOUBLE, up, 1,
+        &T[idx(local_nx - depth + 1, 0, ny)], depth * ny, MPI_DOUBLE, down, 1,
+        &T[idx(1 - depth, 0, ny)], depth * ny, MPI_DOUBLE, up, 1,
         comm, MPI_STATUS_IGNORE);
 
     // Enforce physical boundaries at global edges
@@ -133,222 +336,1644 @@ void exchange_halos(double *T, SimulationConfig config, int local_nx, int rank,
     }
 }
 
-void update_temperature(double *T, double *T_new, SimulationConfig config, int local_nx, int start_row) {
-    int ny = config.ny;
-    double dx2 = config.dx * config.dx;
-    double dy2 = config.dy * config.dy;
-    double factor = config.alpha * config.dt;
+// Allocate the T/T_new pair for counts[rank] rows (plus halos), zero-filled.
+// A NULL T_new (in-place updates) allocates T alone; HALO_SHARED always
+// needs both. Collective over node_comm in HALO_SHARED mode.
+void allocate_stripes(HaloContext *halo, const int *counts, int ny, int rank, int size,
+                      double **T, double **T_new) {
+    size_t stripe = (size_t)(counts[rank] + 2) * ny;
 
-    for (int i = 1; i <= local_nx; i++) {
-        int global_i = start_row + i - 1;
+    if (halo->mode != HALO_SHARED) {
+        size_t extra = (size_t)(halo->depth - 1) * ny;
+        double *base = (double *)calloc(stripe + 2 * extra, sizeof(double));
+        double *base_new = T_new ? (double *)calloc(stripe + 2 * extra, sizeof(double)) : NULL;
+        if (!base || (T_new && !base_new)) {
+            fprintf(stderr, "[rank %d] ERROR: allocation failed\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        *T = base + extra;
+        if (T_new) *T_new = base_new + extra;
+        return;
+    }
 
-        // Keep physical boundary rows fixed
-        if (global_i == 0) {
-            for (int j = 0; j < ny; j++) {
-                T_new[idx(i, j, ny)] = config.top_temp;
-            }
-            continue;
-        } else if (global_i == config.nx - 1) {
-            for (int j = 0; j < ny; j++) {
-                T_new[idx(i, j, ny)] = config.bottom_temp;
-            }
-            continue;
+    // Let each segment sit on pages local to its owner
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shared_noncontig", "true");
+    if (MPI_Win_allocate_shared((MPI_Aint)(2 * stripe) * sizeof(double), sizeof(double), info,
+                                halo->node_comm, &halo->segment, &halo->win) != MPI_SUCCESS) {
+        fprintf(stderr, "[rank %d] ERROR: shared window allocation failed\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Info_free(&info);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, halo->win);
+
+    memset(halo->segment, 0, 2 * stripe * sizeof(double));
+    *T = halo->segment;
+    *T_new = halo->segment + stripe;
+
+    // Map the run's neighbours into node_comm; remote ones stay -1
+    int neighbours[2] = {rank - 1, rank + 1};
+    int local[2] = {MPI_UNDEFINED, MPI_UNDEFINED};
+    MPI_Group run_group, node_group;
+    MPI_Comm_group(sim_comm, &run_group);
+    MPI_Comm_group(halo->node_comm, &node_group);
+    for (int n = 0; n < 2; n++) {
+        if (neighbours[n] >= 0 && neighbours[n] < size) {
+            MPI_Group_translate_ranks(run_group, 1, &neighbours[n], node_group, &local[n]);
         }
+    }
+    MPI_Group_free(&run_group);
+    MPI_Group_free(&node_group);
+
+    halo->up_local = local[0] == MPI_UNDEFINED ? -1 : local[0];
+    halo->down_local = local[1] == MPI_UNDEFINED ? -1 : local[1];
+    halo->up_segment = halo->down_segment = NULL;
+    halo->up_stripe = halo->down_stripe = 0;
+
+    // Segment sizes may be rounded up by the library, so stripe lengths
+    // come from the decomposition rather than the queried size
+    MPI_Aint bytes;
+    int disp_unit;
+    double *base;
+    if (halo->up_local >= 0) {
+        MPI_Win_shared_query(halo->win, halo->up_local, &bytes, &disp_unit, &base);
+        halo->up_segment = base;
+        halo->up_stripe = (size_t)(counts[rank - 1] + 2) * ny;
+    }
+    if (halo->down_local >= 0) {
+        MPI_Win_shared_query(halo->win, halo->down_local, &bytes, &disp_unit, &base);
+        halo->down_segment = base;
+        halo->down_stripe = (size_t)(counts[rank + 1] + 2) * ny;
+    }
+}
 
-        // Left/right boundaries fixed for all interior rows
-        T_new[idx(i, 0, ny)] = config.left_temp;
-        T_new[idx(i, ny - 1, ny)] = config.right_temp;
+void free_stripes(HaloContext *halo, double *T, double *T_new, int ny) {
+    if (halo->mode != HALO_SHARED) {
+        free(T - (size_t)(halo->depth - 1) * ny);
+        if (T_new != NULL) free(T_new - (size_t)(halo->depth - 1) * ny);
+        return;
+    }
+    MPI_Win_unlock_all(halo->win);
+    MPI_Win_free(&halo->win);
+}
 
-        for (int j = 1; j < ny - 1; j++) {
-            double d2T_dx2 = (T[idx(i + 1, j, ny)] - 2.0 * T[idx(i, j, ny)] + T[idx(i - 1, j, ny)]) / dx2;
-            double d2T_dy2 = (T[idx(i, j + 1, ny)] - 2.0 * T[idx(i, j, ny)] + T[idx(i, j - 1, ny)]) / dy2;
-            T_new[idx(i, j, ny)] = T[idx(i, j, ny)] + factor * (d2T_dx2 + d2T_dy2);
+static void enforce_boundary_halos(double *T, SimulationConfig config, int local_nx, int rank, int size) {
+    int ny = config.ny;
+    if (rank == 0) {
+        for (int j = 0; j < ny; j++) {
+            T[idx(0, j, ny)] = config.top_temp;
+        }
+    }
+    if (rank == size - 1) {
+        for (int j = 0; j < ny; j++) {
+            T[idx(local_nx + 1, j, ny)] = config.bottom_temp;
         }
     }
 }
 
-double compute_local_residual(double *T, SimulationConfig config, int local_nx, int start_row) {
+// Same pattern as exchange_halos, with all four transfers posted at once
+void exchange_halos_nonblocking(double *T, SimulationConfig config, int local_nx, int rank, int size,
+                                MPI_Comm comm) {
     int ny = config.ny;
-    double dx2 = config.dx * config.dx;
-    double dy2 = config.dy * config.dy;
-    double max_res = 0.0;
 
-    for (int i = 1; i <= local_nx; i++) {
-        int global_i = start_row + i - 1;
-        if (global_i == 0 || global_i == config.nx - 1) {
-            continue;
-        }
-        for (int j = 1; j < ny - 1; j++) {
-            double laplacian = (T[idx(i + 1, j, ny)] - 2.0 * T[idx(i, j, ny)] + T[idx(i - 1, j, ny)]) / dx2 +
-                                (T[idx(i, j + 1, ny)] - 2.0 * T[idx(i, j, ny)] + T[idx(i, j - 1, ny)]) / dy2;
-            double res = fabs(laplacian);
-            if (res > max_res) {
-                max_res = res;
-            }
+    if (local_nx == 0) {
+        exchange_halos(T, config, local_nx, rank, size, comm);
+        return;
+    }
+
+    int up = rank - 1;
+    int down = rank + 1;
+    if (up < 0) up = MPI_PROC_NULL;
+    if (down >= size) down = MPI_PROC_NULL;
+    int depth = halo_depth(config);
+
+    MPI_Request reqs[4];
+    MPI_Irecv(&T[idx(1 - depth, 0, ny)], depth * ny, MPI_DOUBLE, up, 1, comm, &reqs[0]);
+    MPI_Irecv(&T[idx(local_nx + 1, 0, ny)], depth * ny, MPI_DOUBLE, down, 0, comm, &reqs[1]);
+    MPI_Isend(&T[idx(1, 0, ny)], depth * ny, MPI_DOUBLE, up, 0, comm, &reqs[2]);
+    MPI_Isend(&T[idx(local_nx - depth + 1, 0, ny)], depth * ny, MPI_DOUBLE, down, 1, comm, &reqs[3]);
+    MPI_Waitall(4, reqs, MPI_STATUSES_IGNORE);
+
+    enforce_boundary_halos(T, config, local_nx, rank, size);
+}
+
+// Create the RMA landing window once: [row from up][row from down]
+void setup_rma_halos(HaloContext *halo, int ny, int rank, int size) {
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "no_locks", "true");
+    MPI_Win_allocate((MPI_Aint)2 * ny * sizeof(double), sizeof(double), info,
+                     sim_comm, &halo->rma_halo, &halo->rma_win);
+    MPI_Info_free(&info);
+
+    int neighbours[2];
+    int count = 0;
+    if (rank > 0) neighbours[count++] = rank - 1;
+    if (rank < size - 1) neighbours[count++] = rank + 1;
+    MPI_Group run_group;
+    MPI_Comm_group(sim_comm, &run_group);
+    MPI_Group_incl(run_group, count, neighbours, &halo->rma_group);
+    MPI_Group_free(&run_group);
+}
+
+void free_rma_halos(HaloContext *halo) {
+    MPI_Group_free(&halo->rma_group);
+    MPI_Win_free(&halo->rma_win);
+}
+
+// Post-start-complete-wait epoch with the two neighbours: each rank puts
+// its boundary rows into the neighbours' landing window, with no
+// rendezvous handshake per message. A neighbour's next put cannot start
+// before we post again, i.e. after the landing rows were copied out.
+void exchange_halos_rma(double *T, SimulationConfig config, int local_nx, int rank, int size,
+                        HaloContext *halo) {
+    int ny = config.ny;
+
+    MPI_Win_post(halo->rma_group, 0, halo->rma_win);
+    MPI_Win_start(halo->rma_group, 0, halo->rma_win);
+    if (local_nx > 0) {
+        if (rank > 0) {
+            MPI_Put(&T[idx(1, 0, ny)], ny, MPI_DOUBLE, rank - 1, ny, ny, MPI_DOUBLE, halo->rma_win);
+        }
+        if (rank < size - 1) {
+            MPI_Put(&T[idx(local_nx, 0, ny)], ny, MPI_DOUBLE, rank + 1, 0, ny, MPI_DOUBLE, halo->rma_win);
+        }
+    }
+    MPI_Win_complete(halo->rma_win);
+    MPI_Win_wait(halo->rma_win);
+
+    if (local_nx == 0) {
+        exchange_halos(T, config, local_nx, rank, size, sim_comm);
+        return;
+    }
+    if (rank > 0) {
+        memcpy(&T[idx(0, 0, ny)], halo->rma_halo, ny * sizeof(double));
+    }
+    if (rank < size - 1) {
+        memcpy(&T[idx(local_nx + 1, 0, ny)], halo->rma_halo + ny, ny * sizeof(double));
+    }
+
+    enforce_boundary_halos(T, config, local_nx, rank, size);
+}
+
+// Node-local neighbours are read straight out of the shared window; only
+// neighbours on other nodes go through MPI_Sendrecv.
+void exchange_halos_shared(double *T, SimulationConfig config, int local_nx, int rank, int size,
+                           HaloContext *halo) {
+    int ny = config.ny;
+
+    // Wait until every rank on the node has finished the previous update
+    // before reading its rows. The buffer read here is only overwritten by
+    // its owner after the next step's barrier.
+    size_t current = (T == halo->segment) ? 0 : 1;
+    MPI_Win_sync(halo->win);
+    MPI_Barrier(halo->node_comm);
+    MPI_Win_sync(halo->win);
+
+    if (local_nx == 0) {
+        exchange_halos(T, config, local_nx, rank, size, sim_comm);
+        return;
+    }
+
+    int up = rank - 1;
+    int down = rank + 1;
+    if (up < 0 || halo->up_local >= 0) up = MPI_PROC_NULL;
+    if (down >= size || halo->down_local >= 0) down = MPI_PROC_NULL;
+
+    if (halo->up_local >= 0) {
+        const double *neighbour = halo->up_segment + current * halo->up_stripe;
+        int up_rows = (int)(halo->up_stripe / ny) - 2;
+        memcpy(&T[idx(0, 0, ny)], &neighbour[idx(up_rows, 0, ny)], ny * sizeof(double));
+    }
+    if (halo->down_local >= 0) {
+        const double *neighbour = halo->down_segment + current * halo->down_stripe;
+        memcpy(&T[idx(local_nx + 1, 0, ny)], &neighbour[idx(1, 0, ny)], ny * sizeof(double));
+    }
+
+    MPI_Sendrecv(
+        &T[idx(1, 0, ny)], ny, MPI_DOUBLE, up, 0,
+        &T[idx(local_nx + 1, 0, ny)], ny, MPI_DOUBLE, down, 0,
+        sim_comm, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(
+        &T[idx(local_nx, 0, ny)], ny, MPI_DOUBLE, down, 1,
+        &T[idx(0, 0, ny)], ny, MPI_DOUBLE, up, 1,
+        sim_comm, MPI_STATUS_IGNORE);
+
+    enforce_boundary_halos(T, config, local_nx, rank, size);
+}
+
+void exchange_halos_mode(double *T, SimulationConfig config, int local_nx, int rank, int size,
+                         HaloContext *halo) {
+    switch (halo->mode) {
+        case HALO_SHARED:
+            exchange_halos_shared(T, config, local_nx, rank, size, halo);
+            break;
+        case HALO_NONBLOCKING:
+            exchange_halos_nonblocking(T, config, local_nx, rank, size, sim_comm);
+            break;
+        case HALO_RMA:
+            exchange_halos_rma(T, config, local_nx, rank, size, halo);
+            break;
+        default:
+            exchange_halos(T, config, local_nx, rank, size, sim_comm);
+            break;
+    }
+}
+
+// Local stripe with its halo rows as a libheat grid
+static heat_grid local_grid(SimulationConfig config, int local_nx) {
+    heat_grid grid = {local_nx + 2, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+    return grid;
+}
+
+// Owned rows that are not physical boundary rows, minus the side columns
+static heat_region local_interior(SimulationConfig config, int local_nx, int start_row) {
+    heat_region region = {1, local_nx + 1, 1, config.ny - 1};
+    if (start_row == 0) region.row_begin++;
+    if (start_row + local_nx == config.nx) region.row_end--;
+    return region;
+}
+
+// Boundary condition of one edge; the edge temperature is the Dirichlet
+// value or the Robin ambient temperature
+static heat_bc edge_bc(SimulationConfig config, heat_edge edge) {
+    double temps[HEAT_EDGE_COUNT] = {config.top_temp, config.bottom_temp, config.left_temp, config.right_temp};
+    heat_bc bc = {config.bc_type[edge], temps[edge], config.bc_param[edge]};
+    if (bc.type == HEAT_BC_NEUMANN) bc.value = config.bc_param[edge];
+    return bc;
+}
+
+static int row_owner(int row, const int *counts, const int *displs, int size) {
+    for (int r = 0; r < size; r++) {
+        if (row >= displs[r] && row < displs[r] + counts[r]) return r;
+    }
+    return size - 1;
+}
+
+// Ghost-cell pass, once per step after the halo exchange. Side columns are
+// filled on interior rows first, then the physical top/bottom rows in full,
+// so the corners keep the top/bottom values. Periodic top/bottom rows wrap
+// through the communicator: global row 0 receives row nx-2 from its owner
+// and global row nx-1 receives row 1 (tags 3 and 4).
+void apply_boundaries(double *T, SimulationConfig config, int local_nx, int start_row,
+                      const int *counts, const int *displs, int rank, int size) {
+    int ny = config.ny;
+    heat_grid grid = local_grid(config, local_nx);
+    heat_region rows = local_interior(config, local_nx, start_row);
+    heat_bc left = edge_bc(config, HEAT_EDGE_LEFT);
+    heat_bc right = edge_bc(config, HEAT_EDGE_RIGHT);
+    if (axisym.inner == NULL) heat_fill_edge(&grid, T, HEAT_EDGE_LEFT, &left, rows.row_begin, rows.row_end);
+    heat_fill_edge(&grid, T, HEAT_EDGE_RIGHT, &right, rows.row_begin, rows.row_end);
+
+    // Views whose outer row is the physical boundary row (local row 1 or local_nx)
+    heat_grid edge_grid = grid;
+    edge_grid.rows = local_nx + 1;
+
+    if (config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC) {
+        int top_owner = row_owner(0, counts, displs, size);
+        int bottom_owner = row_owner(config.nx - 1, counts, displs, size);
+        int below_top = row_owner(1, counts, displs, size);
+        int above_bottom = row_owner(config.nx - 2, counts, displs, size);
+        MPI_Request reqs[4];
+        int nreq = 0;
+        if (rank == top_owner) {
+            MPI_Irecv(&T[idx(1, 0, ny)], ny, MPI_DOUBLE, above_bottom, 3, sim_comm, &reqs[nreq++]);
+        }
+        if (rank == bottom_owner) {
+            MPI_Irecv(&T[idx(local_nx, 0, ny)], ny, MPI_DOUBLE, below_top, 4, sim_comm, &reqs[nreq++]);
         }
+        if (rank == above_bottom) {
+            MPI_Isend(&T[idx(config.nx - 2 - start_row + 1, 0, ny)], ny, MPI_DOUBLE, top_owner, 3,
+                      sim_comm, &reqs[nreq++]);
+        }
+        if (rank == below_top) {
+            MPI_Isend(&T[idx(1 - start_row + 1, 0, ny)], ny, MPI_DOUBLE, bottom_owner, 4,
+                      sim_comm, &reqs[nreq++]);
+        }
+        MPI_Waitall(nreq, reqs, MPI_STATUSES_IGNORE);
+        return;
+    }
+
+    if (start_row == 0) {
+        heat_bc top = edge_bc(config, HEAT_EDGE_TOP);
+        heat_fill_edge(&edge_grid, &T[idx(1, 0, ny)], HEAT_EDGE_TOP, &top, 0, ny);
+    }
+    if (start_row + local_nx == config.nx) {
+        heat_bc bottom = edge_bc(config, HEAT_EDGE_BOTTOM);
+        heat_fill_edge(&edge_grid, T, HEAT_EDGE_BOTTOM, &bottom, 0, ny);
+    }
+}
+
+// Physical edges next to the local interior, where the 4th-order stencil
+// switches to its Dirichlet closure; stripe edges read the 2-deep halos
+static unsigned local_edges(SimulationConfig config, int local_nx, int start_row) {
+    unsigned edges = HEAT_EDGE_BIT(HEAT_EDGE_LEFT) | HEAT_EDGE_BIT(HEAT_EDGE_RIGHT);
+    if (start_row == 0) edges |= HEAT_EDGE_BIT(HEAT_EDGE_TOP);
+    if (start_row + local_nx == config.nx) edges |= HEAT_EDGE_BIT(HEAT_EDGE_BOTTOM);
+    return edges;
+}
+
+// Interior update only; the boundary pass has already filled the ghost cells.
+// Without T_new the stripe is updated in place.
+void update_temperature(double *T, double *T_new, SimulationConfig config, int local_nx, int start_row,
+                        const heat_backend *backend) {
+    heat_grid grid = local_grid(config, local_nx);
+    heat_region region = local_interior(config, local_nx, start_row);
+    if (region.row_begin >= region.row_end) {
+        return;
+    }
+    if (T_new == NULL) {
+        heat_step_inplace(backend, &grid, T, region);
+    } else if (mask.kind != NULL) {
+        heat_mask_step(&mask, start_row - 1, &grid, T, T_new, region);
+    } else if (materials.kind != NULL) {
+        heat_materials_step(&materials, start_row - 1, &grid, T, T_new, region);
+    } else if (axisym.inner != NULL) {
+        heat_axisym_step(&axisym, &grid, T, T_new, region);
+    } else if (config.order == 4) {
+        heat_step4(&grid, T, T_new, region, local_edges(config, local_nx, start_row));
+    } else {
+        backend->step(&grid, T, T_new, region);
+    }
+}
+
+double compute_local_residual(double *T, SimulationConfig config, int local_nx, int start_row) {
+    heat_grid grid = local_grid(config, local_nx);
+    heat_region region = local_interior(config, local_nx, start_row);
+    if (region.row_begin >= region.row_end) {
+        return 0.0;
+    }
+    if (mask.kind != NULL) {
+        return heat_mask_residual(&mask, start_row - 1, &grid, T, region);
     }
-    return max_res;
+    if (materials.kind != NULL) {
+        return heat_materials_residual(&materials, start_row - 1, &grid, T, region);
+    }
+    if (axisym.inner != NULL) {
+        return heat_axisym_residual(&axisym, &grid, T, region);
+    }
+    if (config.order == 4) {
+        return heat_residual4(&grid, T, region, local_edges(config, local_nx, start_row));
+    }
+    return heat_residual(&grid, T, region);
 }
 
-void write_snapshot(const double *global_T, SimulationConfig config, const char *filename) {
+void write_snapshot(const double *global_T, SimulationConfig config, const char *name) {
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%s%s", config.output_prefix, name);
     FILE *fp = fopen(filename, "w");
     if (!fp) {
         fprintf(stderr, "[root] ERROR: Unable to open %s for writing\n", filename);
         return;
     }
 
-    for (int i = 0; i < config.nx; i++) {
-        for (int j = 0; j < config.ny; j++) {
-            fprintf(fp, "%.6f ", global_T[idx(i, j, config.ny)]);
-        }
-        fprintf(fp, "\n");
-    }
+    heat_grid grid = {config.nx, config.ny, config.ny, config.alpha, config.dx, config.dy, config.dt};
+    heat_write_rows(&grid, global_T, 0, config.nx, fp);
     fclose(fp);
     printf("[root] Saved %s\n", filename);
 }
 
 void gather_and_write(double *T, SimulationConfig config, int local_nx, int rank,
                       const int *recvcounts, const int *displs_elems,
-                      double *global_buffer, const char *filename) {
+                      double *global_buffer, const char *filename, MPI_Comm comm) {
     // Pointer to first owned row (skip top halo)
     double *sendbuf = &T[idx(1, 0, config.ny)];
     int sendcount = local_nx * config.ny;
 
     MPI_Gatherv(sendbuf, sendcount, MPI_DOUBLE,
                 global_buffer, recvcounts, displs_elems, MPI_DOUBLE,
-                0, MPI_COMM_WORLD);
+                0, comm);
 
     if (rank == 0) {
         write_snapshot(global_buffer, config, filename);
     }
 }
 
-void print_header(SimulationConfig config, int rank, int size) {
-    if (rank != 0) return;
-    printf("==============================================\n");
-    printf("   MPI 2D Heat Equation Simulation\n");
-    printf("==============================================\n");
-    printf("Grid: %d x %d\n", config.nx, config.ny);
-    printf("Steps: %d (output every %d)\n", config.steps, config.output_interval);
-    printf("Diffusivity (alpha): %.3f\n", config.alpha);
-    printf("dt = %.6f, dx = %.3f, dy = %.3f\n", config.dt, config.dx, config.dy);
-    printf("Boundary temps: top=%.1f, bottom=%.1f, left=%.1f, right=%.1f\n",
-           config.top_temp, config.bottom_temp, config.left_temp, config.right_temp);
-    printf("MPI tasks: %d\n", size);
-    printf("==============================================\n\n");
-}
+// Collective: every rank writes its owned rows at their global offset
+void write_checkpoint(double *T, SimulationConfig config, int local_nx, int start_row, int step, int rank) {
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", config.checkpoint_path);
+
+    MPI_File fh;
+    if (MPI_File_open(sim_comm, tmp_path, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                      MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) {
+            fprintf(stderr, "[root] ERROR: Unable to open %s for writing\n", tmp_path);
+        }
+        return;
+    }
 
-void validate_parameters(SimulationConfig config, int rank) {
-    double stable_dt = 0.25 * fmin(config.dx * config.dx, config.dy * config.dy) / config.alpha;
+    MPI_Offset data_bytes = (MPI_Offset)config.nx * config.ny * sizeof(double);
+    MPI_File_set_size(fh, (MPI_Offset)sizeof(heat_checkpoint_header) + data_bytes);
+
+    // heat_checkpoint_header is shared with heat_serial_advanced.c, so either
+    // solver can resume the other's run
     if (rank == 0) {
-        if (config.dt > stable_dt) {
-            printf("[root] WARNING: dt=%.6f exceeds stable dt=%.6f\n", config.dt, stable_dt);
-            printf("        Reduce dt or increase dx/dy for stability.\n");
+        heat_checkpoint_header header;
+        heat_checkpoint_init(&header);
+        header.step = step;
+        header.nx = config.nx;
+        header.ny = config.ny;
+        header.steps = config.steps;
+        header.output_interval = config.output_interval;
+        header.alpha = config.alpha;
+        header.dx = config.dx;
+        header.dy = config.dy;
+        header.dt = config.dt;
+        header.top_temp = config.top_temp;
+        header.bottom_temp = config.bottom_temp;
+        header.left_temp = config.left_temp;
+        header.right_temp = config.right_temp;
+        MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    MPI_Offset offset = (MPI_Offset)sizeof(heat_checkpoint_header) + (MPI_Offset)start_row * config.ny * sizeof(double);
+    MPI_File_write_at_all(fh, offset, &T[idx(1, 0, config.ny)], local_nx * config.ny,
+                          MPI_DOUBLE, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+
+    // Replace the previous checkpoint only once the new one is complete
+    if (rank == 0) {
+        if (rename(tmp_path, config.checkpoint_path) != 0) {
+            fprintf(stderr, "[root] ERROR: Unable to move %s to %s\n", tmp_path, config.checkpoint_path);
         } else {
-            printf("[root] Stability check OK (dt=%.6f <= %.6f)\n\n", config.dt, stable_dt);
+            printf("[root] Checkpoint at step %d saved to %s\n", step, config.checkpoint_path);
         }
     }
 }
 
-int main(int argc, char **argv) {
-    MPI_Init(&argc, &argv);
+// Collective: restores the config stored in the checkpoint and returns its step
+int load_checkpoint_header(SimulationConfig *config, int rank) {
+    MPI_File fh;
+    if (MPI_File_open(sim_comm, config->restart_path, MPI_MODE_RDONLY,
+                      MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) {
+            fprintf(stderr, "[root] ERROR: Unable to open checkpoint %s\n", config->restart_path);
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
-    int rank, size;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    heat_checkpoint_header header;
+    MPI_Offset file_size = 0;
+    MPI_File_read_at_all(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_File_get_size(fh, &file_size);
+    MPI_File_close(&fh);
 
-    SimulationConfig config = {
-        .nx = NX, .ny = NY,
-        .alpha = ALPHA, .dx = DX, .dy = DY, .dt = DT,
-        .steps = STEPS,
-        .output_interval = OUTPUT_INTERVAL,
-        .residual_interval = RESIDUAL_INTERVAL,
-        .top_temp = TOP_TEMP, .bottom_temp = BOTTOM_TEMP,
-        .left_temp = LEFT_TEMP, .right_temp = RIGHT_TEMP
-    };
+    if (!heat_checkpoint_valid(&header) || file_size != (MPI_Offset)heat_checkpoint_bytes(&header)) {
+        if (rank == 0) {
+            fprintf(stderr, "[root] ERROR: %s is not a valid checkpoint\n", config->restart_path);
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
-    print_header(config, rank, size);
-    validate_parameters(config, rank);
+    config->nx = header.nx;
+    config->ny = header.ny;
+    config->steps = header.steps;
+    config->output_interval = header.output_interval;
+    config->alpha = header.alpha;
+    config->dx = header.dx;
+    config->dy = header.dy;
+    config->dt = header.dt;
+    config->top_temp = header.top_temp;
+    config->bottom_temp = header.bottom_temp;
+    config->left_temp = header.left_temp;
+    config->right_temp = header.right_temp;
+    return header.step;
+}
 
-    int *counts = (int *)malloc(size * sizeof(int));
-    int *displs = (int *)malloc(size * sizeof(int));
-    distribute_rows(config.nx, size, counts, displs);
+// Collective: each rank reads only the rows it owns under the current decomposition
+void load_checkpoint_slice(double *T, SimulationConfig config, int local_nx, int start_row) {
+    MPI_File fh;
+    MPI_File_open(sim_comm, config.restart_path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh);
+    MPI_Offset offset = (MPI_Offset)sizeof(heat_checkpoint_header) + (MPI_Offset)start_row * config.ny * sizeof(double);
+    MPI_File_read_at_all(fh, offset, &T[idx(1, 0, config.ny)], local_nx * config.ny,
+                         MPI_DOUBLE, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+}
 
-    int local_nx = counts[rank];
-    int start_row = displs[rank];
+// Move rows between ranks after the partition changed from old_* to new_*.
+// Each overlap of an old range with a new range becomes one point-to-point
+// message; with small shifts these only involve direct neighbours.
+void migrate_rows(const double *T, double *moved, int ny,
+                  const int *old_counts, const int *old_displs,
+                  const int *new_counts, const int *new_displs,
+                  int rank, int size, MPI_Comm comm) {
+    int old_lo = old_displs[rank], old_hi = old_lo + old_counts[rank];
+    int new_lo = new_displs[rank], new_hi = new_lo + new_counts[rank];
+
+    MPI_Request *reqs = (MPI_Request *)malloc(2 * size * sizeof(MPI_Request));
+    int nreq = 0;
 
-    // Prepare Gatherv metadata (elements, not rows)
-    int *recvcounts = (int *)malloc(size * sizeof(int));
-    int *displs_elems = (int *)malloc(size * sizeof(int));
     for (int r = 0; r < size; r++) {
-        recvcounts[r] = counts[r] * config.ny;
-        displs_elems[r] = displs[r] * config.ny;
-    }
+        // Rows I hold that rank r owns under the new partition
+        int lo = old_lo > new_displs[r] ? old_lo : new_displs[r];
+        int hi = old_hi < new_displs[r] + new_counts[r] ? old_hi : new_displs[r] + new_counts[r];
+        if (lo < hi) {
+            const double *src = &T[idx(lo - old_lo + 1, 0, ny)];
+            if (r == rank) {
+                memcpy(&moved[idx(lo - new_lo + 1, 0, ny)], src, (size_t)(hi - lo) * ny * sizeof(double));
+            } else {
+                MPI_Isend(src, (hi - lo) * ny, MPI_DOUBLE, r, 2, comm, &reqs[nreq++]);
+            }
+        }
 
-    double *global_buffer = NULL;
-    if (rank == 0) {
-        global_buffer = (double *)malloc((size_t)config.nx * config.ny * sizeof(double));
-        if (!global_buffer) {
-            fprintf(stderr, "[root] ERROR: failed to allocate global buffer\n");
-            MPI_Abort(MPI_COMM_WORLD, 1);
+        // Rows rank r holds that I own under the new partition
+        if (r != rank) {
+            lo = new_lo > old_displs[r] ? new_lo : old_displs[r];
+            hi = new_hi < old_displs[r] + old_counts[r] ? new_hi : old_displs[r] + old_counts[r];
+            if (lo < hi) {
+                MPI_Irecv(&moved[idx(lo - new_lo + 1, 0, ny)], (hi - lo) * ny, MPI_DOUBLE, r, 2, comm, &reqs[nreq++]);
+            }
         }
     }
+    MPI_Waitall(nreq, reqs, MPI_STATUSES_IGNORE);
+    free(reqs);
+}
 
-    double *T = (double *)calloc((size_t)(local_nx + 2) * config.ny, sizeof(double));
-    double *T_new = (double *)calloc((size_t)(local_nx + 2) * config.ny, sizeof(double));
-    if (!T || !T_new) {
-        fprintf(stderr, "[rank %d] ERROR: allocation failed\n", rank);
+// Face coefficients for the stripe's rows and the ghost row above them
+static void build_materials(SimulationConfig config, int local_nx, int start_row) {
+    heat_grid grid = local_grid(config, local_nx);
+    if (heat_materials_build(&materials, &grid, start_row - 1, start_row + local_nx, config.float_coeffs) != 0) {
+        fprintf(stderr, "ERROR: Materials %s: %s\n", config.materials_path, materials.error);
         MPI_Abort(MPI_COMM_WORLD, 1);
     }
+}
 
-    initialize_local(T, config, local_nx, start_row);
+// Collective: share the per-step compute time of the last window and, when
+// max/avg exceeds REBALANCE_THRESHOLD, repartition by measured speed and
+// migrate rows. Updates counts/displs and the Gatherv metadata in place.
+// Returns the measured imbalance (max/avg).
+double rebalance_rows(double **T, double **T_new, HaloContext *halo, SimulationConfig config, double step_time,
+                      int *counts, int *displs, int *recvcounts, int *displs_elems,
+                      int rank, int size, int *rebalanced) {
+    double *times = (double *)malloc(size * sizeof(double));
+    MPI_Allgather(&step_time, 1, MPI_DOUBLE, times, 1, MPI_DOUBLE, sim_comm);
 
-    // Write initial state
-    gather_and_write(T, config, local_nx, rank, recvcounts, displs_elems, global_buffer, "output_step_0000.txt");
+    double max_time = 0.0, sum_time = 0.0;
+    for (int r = 0; r < size; r++) {
+        sum_time += times[r];
+        if (times[r] > max_time) max_time = times[r];
+    }
+    double imbalance = sum_time > 0.0 ? max_time * size / sum_time : 1.0;
+    *rebalanced = 0;
 
-    MPI_Barrier(MPI_COMM_WORLD);
-    double t0 = MPI_Wtime();
-    double residual = 0.0;
+    if (imbalance > REBALANCE_THRESHOLD) {
+        // Every rank derives the same partition from the same gathered
+        // times. Work is rows, or active cells with a mask.
+        double *speeds = (double *)malloc(size * sizeof(double));
+        double total_work = 0.0;
+        for (int r = 0; r < size; r++) {
+            double work = counts[r];
+            if (row_cells != NULL) {
+                work = 0.0;
+                for (int i = displs[r]; i < displs[r] + counts[r]; i++) work += row_cells[i];
+            }
+            speeds[r] = work;
+            total_work += work;
+        }
+        for (int r = 0; r < size; r++) {
+            // Empty or unmeasurable ranks get the average speed
+            speeds[r] = (speeds[r] > 0.0 && times[r] > 0.0) ? speeds[r] / times[r]
+                                                            : total_work / sum_time;
+        }
+
+        int *new_counts = (int *)malloc(size * sizeof(int));
+        int *new_displs = (int *)malloc(size * sizeof(int));
+        weighted_partition(config.nx, size, speeds, row_cells, halo->depth, new_counts, new_displs);
+        // New stripes first, then retire the old ones (and their window)
+        HaloContext old_halo = *halo;
+        double *moved, *moved_new = NULL;
+        allocate_stripes(halo, new_counts, config.ny, rank, size, &moved, *T_new ? &moved_new : NULL);
+        migrate_rows(*T, moved, config.ny, counts, displs, new_counts, new_displs, rank, size, sim_comm);
+        free_stripes(&old_halo, *T, *T_new, config.ny);
+        *T = moved;
+        *T_new = moved_new;
+        if (mask.kind != NULL && moved_new != NULL) {
+            heat_grid grid = local_grid(config, new_counts[rank]);
+            heat_mask_fill(&mask, new_displs[rank] - 1, &grid, moved_new, 1, new_counts[rank] + 1);
+        }
+        if (materials.kind != NULL) {
+            build_materials(config, new_counts[rank], new_displs[rank]);
+        }
+
+        for (int r = 0; r < size; r++) {
+            counts[r] = new_counts[r];
+            displs[r] = new_displs[r];
+            recvcounts[r] = counts[r] * config.ny;
+            displs_elems[r] = displs[r] * config.ny;
+        }
+        *rebalanced = 1;
+        free(speeds);
+        free(new_counts);
+        free(new_displs);
+    }
+
+    free(times);
+    return imbalance;
+}
+
+// Halos plus the boundary pass, so a snapshot's ghost ring matches its interior
+static void refresh_ghosts(double *T, SimulationConfig config, int local_nx, int start_row,
+                           const int *counts, const int *displs, int rank, int size, HaloContext *halo) {
+    exchange_halos_mode(T, config, local_nx, rank, size, halo);
+    apply_boundaries(T, config, local_nx, start_row, counts, displs, rank, size);
+}
+
+// Rank 0 reads a text file and broadcasts it; every rank gets its own copy
+static char *broadcast_file(const char *path, const char *what, int rank) {
+    char *text = NULL;
+    long length = -1;
+    if (rank == 0) {
+        text = heat_mask_read(path);
+        length = text ? (long)strlen(text) : -1;
+    }
+    MPI_Bcast(&length, 1, MPI_LONG, 0, sim_comm);
+    if (length < 0) {
+        if (rank == 0) fprintf(stderr, "[root] ERROR: Cannot read %s %s\n", what, path);
+        fail_run();
+    }
+    if (rank != 0) text = (char *)malloc(length + 1);
+    MPI_Bcast(text, (int)length + 1, MPI_CHAR, 0, sim_comm);
+    return text;
+}
+
+// Every rank parses the mask and derives the per-row active-cell weights
+static void load_mask(SimulationConfig config, int rank) {
+    char *text = broadcast_file(config.mask_path, "mask", rank);
+    int status = heat_mask_parse(&mask, text, config.nx, config.ny,
+                                 config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC,
+                                 config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC);
+    free(text);
+    if (status != 0) {
+        if (rank == 0) fprintf(stderr, "[root] ERROR: Mask %s: %s\n", config.mask_path, mask.error);
+        fail_run();
+    }
+    row_cells = (int *)malloc(config.nx * sizeof(int));
+    for (int i = 0; i < config.nx; i++) {
+        row_cells[i] = heat_mask_row_cells(&mask, i);
+    }
+}
+
+static void load_materials(SimulationConfig config, int rank) {
+    char *text = broadcast_file(config.materials_path, "materials", rank);
+    int status = heat_materials_parse(&materials, text, config.nx, config.ny, config.alpha,
+                                      config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC,
+                                      config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC);
+    free(text);
+    if (status != 0) {
+        if (rank == 0) fprintf(stderr, "[root] ERROR: Materials %s: %s\n", config.materials_path, materials.error);
+        fail_run();
+    }
+}
+
+void print_usage(const char *prog) {
+    printf("Usage: %s [--checkpoint-interval N] [--checkpoint FILE] [--restart FILE] [--rebalance N]\n"
+           "       [--halo sendrecv|shm|nonblocking|rma] [--backend NAME] [--jit] [--order 2|4] [--inplace]\n"
+           "       [--mask FILE] [--materials FILE [--float-coeffs]] [--axisymmetric] [--bc EDGE=TYPE[:PARAM]]...\n"
+           "       [--parareal SLICES [--coarse-steps N] [--parareal-tol TOL]] [--output-prefix PREFIX]\n"
+           "       [--sweep FILE [--group-size N]] [--config FILE] [--set KEY=VALUE]...\n",
+           prog);
+}
+
+static int parse_halo_mode(const char *name) {
+    for (int m = 0; m < HALO_MODE_COUNT; m++) {
+        if (strcmp(name, halo_mode_names[m]) == 0) return m;
+    }
+    return -1;
+}
+
+// Apply the keys present in `cfg` (named after the config.json layout,
+// e.g. simulation.nx or boundary_conditions.top_bc). -1 on a bad value.
+int apply_config(SimulationConfig *config, heat_config *cfg, int rank) {
+    const struct { const char *key; int *value; } ints[] = {
+        {"simulation.nx", &config->nx}, {"simulation.ny", &config->ny},
+        {"simulation.steps", &config->steps}, {"simulation.output_interval", &config->output_interval},
+        {"simulation.residual_interval", &config->residual_interval},
+        {"solver.rebalance_interval", &config->rebalance_interval},
+        {"solver.order", &config->order}, {"solver.time_slices", &config->time_slices},
+        {"solver.coarse_steps", &config->coarse_steps}
+    };
+    const struct { const char *key; double *value; } doubles[] = {
+        {"simulation.alpha", &config->alpha}, {"simulation.dx", &config->dx},
+        {"simulation.dy", &config->dy}, {"simulation.dt", &config->dt},
+        {"boundary_conditions.top_temp", &config->top_temp},
+        {"boundary_conditions.bottom_temp", &config->bottom_temp},
+        {"boundary_conditions.left_temp", &config->left_temp},
+        {"boundary_conditions.right_temp", &config->right_temp},
+        {"solver.parareal_tol", &config->parareal_tol}
+    };
+    int status = 0;
+    for (size_t k = 0; k < sizeof(ints) / sizeof(ints[0]); k++) {
+        if (heat_config_int(cfg, ints[k].key, ints[k].value) < 0) {
+            if (rank == 0) fprintf(stderr, "[root] ERROR: %s must be an integer\n", ints[k].key);
+            status = -1;
+        }
+    }
+    for (size_t k = 0; k < sizeof(doubles) / sizeof(doubles[0]); k++) {
+        if (heat_config_double(cfg, doubles[k].key, doubles[k].value) < 0) {
+            if (rank == 0) fprintf(stderr, "[root] ERROR: %s must be a number\n", doubles[k].key);
+            status = -1;
+        }
+    }
+    if (heat_config_bool(cfg, "solver.jit", &config->jit) < 0) {
+        if (rank == 0) fprintf(stderr, "[root] ERROR: solver.jit must be true or false\n");
+        status = -1;
+    }
+    if (heat_config_bool(cfg, "solver.inplace", &config->inplace) < 0) {
+        if (rank == 0) fprintf(stderr, "[root] ERROR: solver.inplace must be true or false\n");
+        status = -1;
+    }
+    const char *backend = heat_config_get(cfg, "solver.backend");
+    if (backend != NULL) {
+        config->backend_name = backend;
+    }
+    if (heat_config_bool(cfg, "solver.float_coeffs", &config->float_coeffs) < 0) {
+        if (rank == 0) fprintf(stderr, "[root] ERROR: solver.float_coeffs must be true or false\n");
+        status = -1;
+    }
+    if (heat_config_bool(cfg, "solver.axisymmetric", &config->axisymmetric) < 0) {
+        if (rank == 0) fprintf(stderr, "[root] ERROR: solver.axisymmetric must be true or false\n");
+        status = -1;
+    }
+    const char *materials_path = heat_config_get(cfg, "solver.materials");
+    if (materials_path != NULL) {
+        config->materials_path = materials_path[0] ? materials_path : NULL;
+    }
+    const char *mask_path = heat_config_get(cfg, "solver.mask");
+    if (mask_path != NULL) {
+        config->mask_path = mask_path[0] ? mask_path : NULL;
+    }
+    const char *halo = heat_config_get(cfg, "solver.halo");
+    if (halo != NULL) {
+        config->halo_mode = parse_halo_mode(halo);
+        if (config->halo_mode < 0) {
+            if (rank == 0) fprintf(stderr, "[root] ERROR: Unknown halo mode %s\n", halo);
+            status = -1;
+        }
+    }
+
+    // Same specs as --bc, e.g. "left_bc": "robin:5"
+    for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+        char key[64], spec[HEAT_CONFIG_VALUE_MAX + 16];
+        snprintf(key, sizeof(key), "boundary_conditions.%s_bc", heat_edge_name((heat_edge)e));
+        const char *value = heat_config_get(cfg, key);
+        if (value == NULL) continue;
+        heat_edge edge;
+        snprintf(spec, sizeof(spec), "%s=%s", heat_edge_name((heat_edge)e), value);
+        if (heat_parse_bc(spec, &edge, &config->bc_type[e], &config->bc_param[e]) != 0) {
+            if (rank == 0) fprintf(stderr, "[root] ERROR: %s: bad boundary type '%s'\n", key, value);
+            status = -1;
+        }
+    }
+    return status;
+}
+
+// Rank 0 reads the config file and broadcasts it; every rank then applies
+// it, followed by the --set overrides, before the dedicated options.
+static void load_config(int argc, char **argv, SimulationConfig *config, int rank) {
+    static heat_config file_cfg, set_cfg;   // strings stay referenced by config
+    const char *path = NULL;
+    int status = 0;
+    for (int a = 1; a + 1 < argc; a++) {
+        if (strcmp(argv[a], "--config") == 0) {
+            path = argv[++a];
+        } else if (strcmp(argv[a], "--set") == 0 && heat_config_set(&set_cfg, argv[++a]) != 0) {
+            if (rank == 0) fprintf(stderr, "[root] ERROR: --set: %s\n", set_cfg.error);
+            status = -1;
+        }
+    }
+
+    if (rank == 0) {
+        if (heat_config_load(&file_cfg, path ? path : CONFIG_FILE) == 0) {
+            printf("[root] Configuration: %s\n", path ? path : CONFIG_FILE);
+        } else if (path != NULL || access(CONFIG_FILE, F_OK) == 0) {
+            fprintf(stderr, "[root] ERROR: %s\n", file_cfg.error);
+            status = -1;
+        } else {
+            file_cfg.count = 0;
+        }
+    }
+    MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&file_cfg, sizeof(file_cfg), MPI_BYTE, 0, MPI_COMM_WORLD);
+    if (status != 0 || apply_config(config, &file_cfg, rank) != 0 || apply_config(config, &set_cfg, rank) != 0) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    if (rank == 0) {
+        heat_config_warn_unused(&file_cfg, "simulation.", stderr);
+        heat_config_warn_unused(&file_cfg, "boundary_conditions.", stderr);
+        heat_config_warn_unused(&file_cfg, "solver.", stderr);
+    }
+    for (int e = 0; e < set_cfg.count; e++) {
+        if (!set_cfg.entries[e].used) {
+            if (rank == 0) fprintf(stderr, "[root] ERROR: --set: unknown key %s\n", set_cfg.entries[e].key);
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        }
+    }
+}
 
-    for (int step = 0; step < config.steps; step++) {
-        exchange_halos(T, config, local_nx, rank, size, MPI_COMM_WORLD);
-        update_temperature(T, T_new, config, local_nx, start_row);
+void parse_args(int argc, char **argv, SimulationConfig *config, int rank) {
+    load_config(argc, argv, config, rank);
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--checkpoint-interval") == 0 && a + 1 < argc) {
+            config->checkpoint_interval = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--checkpoint") == 0 && a + 1 < argc) {
+            config->checkpoint_path = argv[++a];
+        } else if (strcmp(argv[a], "--restart") == 0 && a + 1 < argc) {
+            config->restart_path = argv[++a];
+        } else if (strcmp(argv[a], "--rebalance") == 0 && a + 1 < argc) {
+            config->rebalance_interval = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--backend") == 0 && a + 1 < argc) {
+            config->backend_name = argv[++a];
+        } else if (strcmp(argv[a], "--bc") == 0 && a + 1 < argc) {
+            heat_edge edge;
+            heat_bc_type type;
+            double param;
+            if (heat_parse_bc(argv[++a], &edge, &type, &param) != 0) {
+                if (rank == 0) {
+                    fprintf(stderr, "[root] ERROR: Bad boundary spec %s (expected EDGE=TYPE[:PARAM])\n", argv[a]);
+                }
+                MPI_Finalize();
+                exit(EXIT_FAILURE);
+            }
+            config->bc_type[edge] = type;
+            config->bc_param[edge] = param;
+        } else if (strcmp(argv[a], "--jit") == 0) {
+            config->jit = 1;
+        } else if (strcmp(argv[a], "--order") == 0 && a + 1 < argc) {
+            config->order = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--inplace") == 0) {
+            config->inplace = 1;
+        } else if (strcmp(argv[a], "--mask") == 0 && a + 1 < argc) {
+            config->mask_path = argv[++a];
+        } else if (strcmp(argv[a], "--materials") == 0 && a + 1 < argc) {
+            config->materials_path = argv[++a];
+        } else if (strcmp(argv[a], "--float-coeffs") == 0) {
+            config->float_coeffs = 1;
+        } else if (strcmp(argv[a], "--axisymmetric") == 0) {
+            config->axisymmetric = 1;
+        } else if (strcmp(argv[a], "--parareal") == 0 && a + 1 < argc) {
+            config->time_slices = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--coarse-steps") == 0 && a + 1 < argc) {
+            config->coarse_steps = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--parareal-tol") == 0 && a + 1 < argc) {
+            config->parareal_tol = atof(argv[++a]);
+        } else if (strcmp(argv[a], "--output-prefix") == 0 && a + 1 < argc) {
+            config->output_prefix = argv[++a];
+        } else if (strcmp(argv[a], "--sweep") == 0 && a + 1 < argc) {
+            config->sweep_path = argv[++a];
+        } else if (strcmp(argv[a], "--group-size") == 0 && a + 1 < argc) {
+            config->group_size = atoi(argv[++a]);
+        } else if ((strcmp(argv[a], "--config") == 0 || strcmp(argv[a], "--set") == 0) && a + 1 < argc) {
+            a++;    // applied by load_config
+        } else if (strcmp(argv[a], "--halo") == 0 && a + 1 < argc) {
+            a++;
+            config->halo_mode = parse_halo_mode(argv[a]);
+            if (config->halo_mode < 0) {
+                if (rank == 0) {
+                    fprintf(stderr, "[root] ERROR: Unknown halo mode %s\n", argv[a]);
+                }
+                MPI_Finalize();
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            if (rank == 0) {
+                fprintf(stderr, "[root] ERROR: Unknown or incomplete option %s\n", argv[a]);
+                print_usage(argv[0]);
+            }
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        }
+    }
+}
 
+void print_header(SimulationConfig config, const heat_backend *backend, int rank, int size) {
+    if (rank != 0) return;
+    printf("==============================================\n");
+    printf("   MPI 2D Heat Equation Simulation\n");
+    printf("==============================================\n");
+    printf("Grid: %d x %d\n", config.nx, config.ny);
+    printf("Steps: %d (output every %d)\n", config.steps, config.output_interval);
+    printf("Diffusivity (alpha): %.3f\n", config.alpha);
+    printf("dt = %.6f, dx = %.3f, dy = %.3f\n", config.dt, config.dx, config.dy);
+    printf("Boundary temps: top=%.1f, bottom=%.1f, left=%.1f, right=%.1f\n",
+           config.top_temp, config.bottom_temp, config.left_temp, config.right_temp);
+    printf("Boundary types: top=%s, bottom=%s, left=%s, right=%s\n",
+           heat_bc_name(config.bc_type[HEAT_EDGE_TOP]), heat_bc_name(config.bc_type[HEAT_EDGE_BOTTOM]),
+           config.axisymmetric ? "axis" : heat_bc_name(config.bc_type[HEAT_EDGE_LEFT]),
+           heat_bc_name(config.bc_type[HEAT_EDGE_RIGHT]));
+    printf("MPI tasks: %d\n", size);
+    printf("Halo exchange: %s\n", halo_mode_names[config.halo_mode]);
+    if (mask.kind != NULL) {
+        printf("Mask: %s, %lld active cells in %d runs + %d rim cells (scalar loop)\n", config.mask_path,
+               mask.active_cells, mask.run_start[config.nx], mask.rim_start[config.nx]);
+        printf("Partition: rows split by active cells\n");
+    } else if (materials.kind != NULL) {
+        printf("Materials: %s, alpha %g to %g, %s face coefficients (flux-form loop)\n", config.materials_path,
+               materials.alpha_min, materials.alpha_max, config.float_coeffs ? "float" : "double");
+    } else if (config.axisymmetric) {
+        printf("Axisymmetric: z down the %d rows (dz %g), r across the %d columns (dr %g, R %g), axis at column 0\n",
+               config.nx, config.dx, config.ny, config.dy, (config.ny - 1) * config.dy);
+    } else if (config.order == 4) {
+        printf("Stencil: 4th-order wide cross (2-deep halos)\n");
+    } else {
+        printf("Stencil backend: %s (%s)\n", backend->name, backend->description);
+    }
+    if (config.inplace) {
+        printf("Update: in place with a line buffer (no T_new)\n");
+    }
+    if (config.time_slices > 1) {
+        printf("Parareal: %d time slices x %d ranks, coarse propagator %d implicit Euler steps per slice (CG), "
+               "tolerance %.1e\n", config.time_slices, size / config.time_slices, config.coarse_steps,
+               config.parareal_tol);
+    }
+    if (config.time_slices > 1) {
+        printf("Checkpoint: off (Parareal)\n");
+    } else if (config.checkpoint_interval > 0) {
+        printf("Checkpoint: every %d steps and on SIGINT/SIGTERM -> %s\n",
+               config.checkpoint_interval, config.checkpoint_path);
+    } else {
+        printf("Checkpoint: on SIGINT/SIGTERM -> %s\n", config.checkpoint_path);
+    }
+    if (config.rebalance_interval > 0) {
+        printf("Load balancing: every %d steps (threshold max/avg %.2f)\n",
+               config.rebalance_interval, REBALANCE_THRESHOLD);
+    }
+    printf("==============================================\n\n");
+}
+
+// Why `config` cannot run on `size` ranks, or NULL if it can
+static const char *config_error(SimulationConfig config, int size) {
+    static char message[256];
+    // A periodic edge wraps onto the opposite one
+    if ((config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC) != (config.bc_type[HEAT_EDGE_BOTTOM] == HEAT_BC_PERIODIC) ||
+        (config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC) != (config.bc_type[HEAT_EDGE_RIGHT] == HEAT_BC_PERIODIC)) {
+        return "Periodic boundaries must be set on both top and bottom, or both left and right";
+    }
+
+    const char *order_error = NULL;
+    if (config.order != 2 && config.order != 4) {
+        order_error = "Stencil order must be 2 or 4";
+    } else if (config.order == 4) {
+        for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+            if (config.bc_type[e] != HEAT_BC_DIRICHLET) order_error = "The 4th-order stencil needs Dirichlet boundaries";
+        }
+        if (config.nx < 5 || config.ny < 5) {
+            order_error = "The 4th-order stencil needs at least a 5x5 grid";
+        } else if (config.nx < 2 * size) {
+            order_error = "The 4th-order stencil needs at least 2 rows per rank";
+        } else if (config.inplace) {
+            order_error = "In-place updates only support the 2nd-order stencil";
+        }
+    }
+    if (order_error == NULL && config.mask_path != NULL && (config.order == 4 || config.inplace)) {
+        order_error = "Masks need the default two-buffer 2nd-order update (no --order 4 or --inplace)";
+    }
+    if (order_error == NULL && config.materials_path != NULL &&
+        (config.mask_path != NULL || config.order == 4 || config.inplace)) {
+        order_error = "Materials need the default two-buffer 2nd-order update (no --mask, --order 4 or --inplace)";
+    }
+    if (order_error == NULL && config.axisymmetric &&
+        (config.mask_path != NULL || config.materials_path != NULL || config.order == 4 || config.inplace)) {
+        order_error = "Axisymmetric runs need the default two-buffer 2nd-order update (no --mask, --materials, --order 4 or --inplace)";
+    } else if (order_error == NULL && config.axisymmetric && config.bc_type[HEAT_EDGE_LEFT] == HEAT_BC_PERIODIC) {
+        order_error = "Axisymmetric runs cannot have periodic left/right edges (the left edge is the axis)";
+    }
+    if (config.time_slices < 1 || size % config.time_slices != 0 || config.steps < config.time_slices) {
+        snprintf(message, sizeof(message), "%d time slices need a multiple of them as the rank count (got %d) "
+                 "and at least as many steps (got %d)", config.time_slices, size, config.steps);
+        return message;
+    }
+    if (order_error == NULL && config.time_slices > 1 &&
+        (config.mask_path != NULL || config.materials_path != NULL || config.axisymmetric || config.order == 4 ||
+         config.inplace || config.bc_type[HEAT_EDGE_TOP] == HEAT_BC_PERIODIC)) {
+        order_error = "Parareal needs the plain two-buffer 2nd-order update (no --mask, --materials, --axisymmetric, --order 4, --inplace or periodic top/bottom edges)";
+    } else if (order_error == NULL && config.time_slices > 1 &&
+               (config.restart_path != NULL || config.checkpoint_interval > 0 || config.rebalance_interval > 0)) {
+        order_error = "Parareal runs do not checkpoint, restart or rebalance";
+    } else if (order_error == NULL && config.time_slices > 1 &&
+               (config.coarse_steps < 1 || !(config.parareal_tol > 0.0))) {
+        order_error = "Parareal needs at least one coarse step per slice and a positive tolerance";
+    }
+    return order_error;
+}
+
+void validate_parameters(SimulationConfig config, int rank, int size) {
+    const char *error = config_error(config, size);
+    if (error != NULL) {
+        if (rank == 0) {
+            fprintf(stderr, "[root] ERROR: %s\n", error);
+        }
+        fail_run();
+    }
+
+    // The wide cross allows 3/8 instead of 1/2 per unit of 1/dx^2 + 1/dy^2;
+    // with materials the most diffusive one sets the limit
+    double alpha = materials.kind != NULL ? materials.alpha_max : config.alpha;
+    double stable_dt = (config.order == 4 ? 0.1875 : 0.25) * fmin(config.dx * config.dx, config.dy * config.dy) / alpha;
+    if (config.axisymmetric) {
+        // The axis cell sees the radial term twice
+        heat_grid grid = local_grid(config, config.nx);
+        stable_dt = heat_axisym_stable_dt(&grid);
+    }
+    if (rank == 0) {
+        if (config.dt > stable_dt) {
+            printf("[root] WARNING: dt=%.6f exceeds stable dt=%.6f\n", config.dt, stable_dt);
+            printf("        Reduce dt or increase dx/dy for stability.\n");
+        } else {
+            printf("[root] Stability check OK (dt=%.6f <= %.6f)\n\n", config.dt, stable_dt);
+        }
+    }
+}
+
+// One Parareal time slice: its spatial group of ranks, the stripe this
+// rank owns in it, and the work vectors of the propagators
+typedef struct {
+    SimulationConfig config;
+    SimulationConfig homogeneous;   // same edges, zero temperatures and fluxes
+    MPI_Comm space_comm;
+    int space_rank, space_size;
+    int *counts, *displs;
+    int local_nx, start_row;
+    const heat_backend *backend;
+    size_t stripe;
+    double *work[5];                // fine buffer; CG iterate, residual, direction, operator image
+} PararealSlice;
+
+static void slice_refresh(PararealSlice *slice, double *T, const SimulationConfig *config) {
+    if (config->halo_mode == HALO_NONBLOCKING) {
+        exchange_halos_nonblocking(T, *config, slice->local_nx, slice->space_rank, slice->space_size,
+                                   slice->space_comm);
+    } else {
+        exchange_halos(T, *config, slice->local_nx, slice->space_rank, slice->space_size, slice->space_comm);
+    }
+    apply_boundaries(T, *config, slice->local_nx, slice->start_row, slice->counts, slice->displs,
+                     slice->space_rank, slice->space_size);
+}
+
+// Fine propagator: `steps` ordinary explicit steps from `start` into `out`
+static void fine_propagate(PararealSlice *slice, const double *start, double *out, int steps) {
+    double *T = out, *T_new = slice->work[0];
+    // Land the last step in `out`
+    if (steps % 2 == 1) {
+        T = slice->work[0];
+        T_new = out;
+    }
+    memcpy(T, start, slice->stripe * sizeof(double));
+    memcpy(T_new, start, slice->stripe * sizeof(double));
+    for (int step = 0; step < steps; step++) {
+        slice_refresh(slice, T, &slice->config);
+        update_temperature(T, T_new, slice->config, slice->local_nx, slice->start_row, slice->backend);
         double *tmp = T;
         T = T_new;
         T_new = tmp;
+    }
+}
+
+static double slice_dot(const PararealSlice *slice, const double *a, const double *b) {
+    heat_region region = local_interior(slice->config, slice->local_nx, slice->start_row);
+    int ny = slice->config.ny;
+    double local = 0.0, sum = 0.0;
+    for (int i = region.row_begin; i < region.row_end; i++) {
+        for (int j = region.col_begin; j < region.col_end; j++) {
+            local += a[idx(i, j, ny)] * b[idx(i, j, ny)];
+        }
+    }
+    MPI_Allreduce(&local, &sum, 1, MPI_DOUBLE, MPI_SUM, slice->space_comm);
+    return sum;
+}
+
+// out = v - alpha*h*Laplacian(v) on the interior, after filling v's ghost
+// cells for `config`: one explicit step with dt = -h
+static void implicit_operator(PararealSlice *slice, double *v, double *out, const SimulationConfig *config,
+                              double h) {
+    heat_grid grid = local_grid(slice->config, slice->local_nx);
+    grid.dt = -h;
+    slice_refresh(slice, v, config);
+    slice->backend->step(&grid, v, out, local_interior(slice->config, slice->local_nx, slice->start_row));
+}
+
+// Coarse propagator: `coarse_steps` implicit Euler steps over `duration`.
+// Each solves (I - alpha*h*L) x = u with the boundary conditions by
+// conjugate gradients: every supported edge makes the ghost cells an
+// affine function of the interior, so the operator stays symmetric. The
+// residual of x = u carries the boundary values; the directions see
+// homogeneous edges.
+static void coarse_propagate(PararealSlice *slice, const double *start, double *out, double duration) {
+    heat_region region = local_interior(slice->config, slice->local_nx, slice->start_row);
+    int ny = slice->config.ny;
+    int max_iterations = (slice->config.nx - 2) * (slice->config.ny - 2);
+    double h = duration / slice->config.coarse_steps;
+    double *x = slice->work[1], *r = slice->work[2], *p = slice->work[3], *Ap = slice->work[4];
+
+    memcpy(out, start, slice->stripe * sizeof(double));
+    for (int n = 0; n < slice->config.coarse_steps; n++) {
+        memcpy(x, out, slice->stripe * sizeof(double));
+        implicit_operator(slice, x, Ap, &slice->config, h);
+        memset(r, 0, slice->stripe * sizeof(double));
+        for (int i = region.row_begin; i < region.row_end; i++) {
+            for (int j = region.col_begin; j < region.col_end; j++) {
+                r[idx(i, j, ny)] = out[idx(i, j, ny)] - Ap[idx(i, j, ny)];
+            }
+        }
+        memcpy(p, r, slice->stripe * sizeof(double));
+        double rr = slice_dot(slice, r, r);
+        double stop = rr * PARAREAL_CG_TOL * PARAREAL_CG_TOL;
+        for (int it = 0; it < max_iterations && rr > stop && rr > 0.0; it++) {
+            implicit_operator(slice, p, Ap, &slice->homogeneous, h);
+            double a = rr / slice_dot(slice, p, Ap);
+            for (int i = region.row_begin; i < region.row_end; i++) {
+                for (int j = region.col_begin; j < region.col_end; j++) {
+                    x[idx(i, j, ny)] += a * p[idx(i, j, ny)];
+                    r[idx(i, j, ny)] -= a * Ap[idx(i, j, ny)];
+                }
+            }
+            double rr_new = slice_dot(slice, r, r);
+            double b = rr_new / rr;
+            rr = rr_new;
+            for (int i = region.row_begin; i < region.row_end; i++) {
+                for (int j = region.col_begin; j < region.col_end; j++) {
+                    p[idx(i, j, ny)] = r[idx(i, j, ny)] + b * p[idx(i, j, ny)];
+                }
+            }
+        }
+        memcpy(out, x, slice->stripe * sizeof(double));
+    }
+}
+
+// Parareal over the run's communicator split into time_slices groups of
+// size / time_slices ranks. Group p owns slice p of the steps and splits
+// the rows as an ordinary run would. Iteration k runs every slice's fine
+// propagator from its current start state at once, then passes the
+// corrected end states down the slices in one sequential coarse sweep:
+//   U[p+1] = G(U[p]) + F(U_old[p]) - G(U_old[p])
+// A slice whose start was already exact forwards F unchanged, so after
+// time_slices iterations the result is the sequential fine run.
+int run_parareal(SimulationConfig config, const heat_backend *backend, int rank, int size) {
+    int slices = config.time_slices;
+    PararealSlice slice = {0};
+    slice.config = config;
+    slice.backend = backend;
+    slice.space_size = size / slices;
+    int time_rank = rank / slice.space_size;
+    slice.space_rank = rank % slice.space_size;
+    MPI_Comm time_comm;
+    MPI_Comm_split(sim_comm, time_rank, slice.space_rank, &slice.space_comm);
+    MPI_Comm_split(sim_comm, slice.space_rank, time_rank, &time_comm);
+
+    slice.homogeneous = config;
+    slice.homogeneous.top_temp = slice.homogeneous.bottom_temp = 0.0;
+    slice.homogeneous.left_temp = slice.homogeneous.right_temp = 0.0;
+    for (int e = 0; e < HEAT_EDGE_COUNT; e++) {
+        if (config.bc_type[e] == HEAT_BC_NEUMANN) slice.homogeneous.bc_param[e] = 0.0;
+    }
+
+    slice.counts = (int *)malloc(slice.space_size * sizeof(int));
+    slice.displs = (int *)malloc(slice.space_size * sizeof(int));
+    distribute_rows(config.nx, slice.space_size, slice.counts, slice.displs);
+    slice.local_nx = slice.counts[slice.space_rank];
+    slice.start_row = slice.displs[slice.space_rank];
+    int *slice_steps = (int *)malloc(slices * sizeof(int));
+    int *slice_first = (int *)malloc(slices * sizeof(int));
+    distribute_rows(config.steps, slices, slice_steps, slice_first);
+    int steps = slice_steps[time_rank];
+    int end_step = slice_first[time_rank] + steps;
+
+    // Start state, end state, fine result and last coarse result of this slice
+    slice.stripe = (size_t)(slice.local_nx + 2) * config.ny;
+    double *state[4];
+    for (int v = 0; v < 4; v++) state[v] = (double *)calloc(slice.stripe, sizeof(double));
+    for (int v = 0; v < 5; v++) slice.work[v] = (double *)calloc(slice.stripe, sizeof(double));
+    double *U_start = state[0], *U_end = state[1], *F_end = state[2], *G_end = state[3];
+    double *global_buffer = NULL;
+    int *recvcounts = (int *)malloc(slice.space_size * sizeof(int));
+    int *displs_elems = (int *)malloc(slice.space_size * sizeof(int));
+    for (int r = 0; r < slice.space_size; r++) {
+        recvcounts[r] = slice.counts[r] * config.ny;
+        displs_elems[r] = slice.displs[r] * config.ny;
+    }
+    if (slice.space_rank == 0) global_buffer = (double *)malloc((size_t)config.nx * config.ny * sizeof(double));
+    int allocated = slice.space_rank != 0 || global_buffer != NULL;
+    for (int v = 0; v < 5; v++) allocated = allocated && slice.work[v] != NULL && (v == 4 || state[v] != NULL);
+    if (!allocated) {
+        fprintf(stderr, "[rank %d] ERROR: allocation failed\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    initialize_local(U_start, config, slice.local_nx, slice.start_row);
+    if (time_rank == 0) {
+        slice_refresh(&slice, U_start, &config);
+        gather_and_write(U_start, config, slice.local_nx, slice.space_rank, recvcounts, displs_elems, global_buffer,
+                         "output_step_0000.txt", slice.space_comm);
+    }
+    int rows = slice.local_nx * config.ny;
+    double duration = steps * config.dt;
+    int up = time_rank > 0 ? time_rank - 1 : MPI_PROC_NULL;
+    int down = time_rank < slices - 1 ? time_rank + 1 : MPI_PROC_NULL;
+
+    MPI_Barrier(sim_comm);
+    double t0 = MPI_Wtime();
+
+    // Iteration 0: the coarse propagator alone, slice after slice
+    MPI_Recv(&U_start[idx(1, 0, config.ny)], rows, MPI_DOUBLE, up, 0, time_comm, MPI_STATUS_IGNORE);
+    coarse_propagate(&slice, U_start, G_end, duration);
+    memcpy(U_end, G_end, slice.stripe * sizeof(double));
+    MPI_Send(&U_end[idx(1, 0, config.ny)], rows, MPI_DOUBLE, down, 0, time_comm);
+    double coarse_time = MPI_Wtime() - t0;
+
+    int iterations = 0;
+    double change = 0.0, fine_time = 0.0;
+    while (iterations < slices) {
+        iterations++;
+        double tf = MPI_Wtime();
+        fine_propagate(&slice, U_start, F_end, steps);
+        fine_time += MPI_Wtime() - tf;
+
+        // Sequential correction sweep
+        MPI_Recv(&U_start[idx(1, 0, config.ny)], rows, MPI_DOUBLE, up, 0, time_comm, MPI_STATUS_IGNORE);
+        double local_change = 0.0;
+        heat_region region = local_interior(config, slice.local_nx, slice.start_row);
+        if (time_rank < iterations) {
+            // Started from the exact state: the fine result is final
+            for (int i = region.row_begin; i < region.row_end; i++) {
+                for (int j = region.col_begin; j < region.col_end; j++) {
+                    local_change = fmax(local_change, fabs(F_end[idx(i, j, config.ny)] - U_end[idx(i, j, config.ny)]));
+                }
+            }
+            memcpy(U_end, F_end, slice.stripe * sizeof(double));
+        } else {
+            double *G_new = slice.work[0];
+            coarse_propagate(&slice, U_start, G_new, duration);
+            for (int i = region.row_begin; i < region.row_end; i++) {
+                for (int j = region.col_begin; j < region.col_end; j++) {
+                    int at = idx(i, j, config.ny);
+                    double corrected = G_new[at] + F_end[at] - G_end[at];
+                    local_change = fmax(local_change, fabs(corrected - U_end[at]));
+                    U_end[at] = corrected;
+                }
+            }
+            memcpy(G_end, G_new, slice.stripe * sizeof(double));
+        }
+        MPI_Send(&U_end[idx(1, 0, config.ny)], rows, MPI_DOUBLE, down, 0, time_comm);
+
+        MPI_Allreduce(&local_change, &change, 1, MPI_DOUBLE, MPI_MAX, sim_comm);
+        if (rank == 0) {
+            printf("[root] Parareal iteration %d: max change of the slice-end states %.2e\n", iterations, change);
+        }
+        if (change < config.parareal_tol) break;
+    }
+    double elapsed = MPI_Wtime() - t0;
+
+    // Every slice end is a snapshot; the last one is the final state
+    char fname[64];
+    snprintf(fname, sizeof(fname), "output_step_%04d.txt", end_step);
+    slice_refresh(&slice, U_end, &config);
+    gather_and_write(U_end, config, slice.local_nx, slice.space_rank, recvcounts, displs_elems, global_buffer,
+                     fname, slice.space_comm);
+    if (time_rank == slices - 1) {
+        gather_and_write(U_end, config, slice.local_nx, slice.space_rank, recvcounts, displs_elems, global_buffer,
+                         "output_final.txt", slice.space_comm);
+    }
+
+    // A slice's fine time per iteration is what a sequential run spends on it
+    double times[3] = {elapsed, fine_time / iterations, coarse_time};
+    double max_times[3], sum_fine = 0.0;
+    MPI_Reduce(times, max_times, 3, MPI_DOUBLE, MPI_MAX, 0, sim_comm);
+    double slice_fine = slice.space_rank == 0 ? times[1] : 0.0;
+    MPI_Reduce(&slice_fine, &sum_fine, 1, MPI_DOUBLE, MPI_SUM, 0, sim_comm);
+    MPI_Barrier(sim_comm);
+    if (rank == 0) {
+        printf("\nSimulation complete.\n");
+        printf("Parareal: %d slices x %d ranks, %d iterations, last change %.2e (tolerance %.1e)\n", slices,
+               slice.space_size, iterations, change, config.parareal_tol);
+        printf("Elapsed (max across ranks): %.3f s (coarse sweep %.3f s, fine slice %.3f s per iteration)\n",
+               max_times[0], max_times[2], max_times[1]);
+        printf("Sequential fine estimate: %.3f s (%.2fx)\n", sum_fine, sum_fine / max_times[0]);
+        printf("Snapshots: %soutput_step_*.txt at slice ends + %soutput_final.txt\n", config.output_prefix,
+               config.output_prefix);
+    }
+
+    for (int v = 0; v < 4; v++) free(state[v]);
+    for (int v = 0; v < 5; v++) free(slice.work[v]);
+    free(global_buffer);
+    free(recvcounts);
+    free(displs_elems);
+    free(slice_steps);
+    free(slice_first);
+    free(slice.counts);
+    free(slice.displs);
+    MPI_Comm_free(&slice.space_comm);
+    MPI_Comm_free(&time_comm);
+    return 0;
+}
+
+// One simulation on sim_comm: the whole job, or one configuration of a
+// sweep on its group. 0 once it completes, 1 if a signal stopped it.
+int run_simulation(SimulationConfig config) {
+    int rank, size;
+    MPI_Comm_rank(sim_comm, &rank);
+    MPI_Comm_size(sim_comm, &size);
+
+    // The shared-window and RMA halos move a single row per side, and
+    // shared-window halos read neighbour rows that in-place updates overwrite
+    if (config.order == 4 && (config.halo_mode == HALO_SHARED || config.halo_mode == HALO_RMA)) {
+        if (rank == 0) {
+            printf("[root] Note: %s halos are 1-deep, using nonblocking halos for the 4th-order stencil\n",
+                   halo_mode_names[config.halo_mode]);
+        }
+        config.halo_mode = HALO_NONBLOCKING;
+    } else if (config.time_slices > 1 && (config.halo_mode == HALO_SHARED || config.halo_mode == HALO_RMA)) {
+        if (rank == 0) {
+            printf("[root] Note: %s halos span the whole run, using nonblocking halos within each time slice\n",
+                   halo_mode_names[config.halo_mode]);
+        }
+        config.halo_mode = HALO_NONBLOCKING;
+    } else if (config.inplace && config.halo_mode == HALO_SHARED) {
+        if (rank == 0) {
+            printf("[root] Note: shm halos need two buffers, using nonblocking halos for in-place updates\n");
+        }
+        config.halo_mode = HALO_NONBLOCKING;
+    }
+
+    const heat_backend *backend = heat_select_backend(config.backend_name);
+    if (backend == NULL) {
+        if (rank == 0) {
+            fprintf(stderr, "[root] ERROR: Unknown stencil backend. Available backends:\n");
+            heat_list_backends(stderr);
+        }
+        fail_run();
+    }
+
+    int start_step = 0;
+    if (config.restart_path) {
+        start_step = load_checkpoint_header(&config, rank);
+    }
+
+    if (config.mask_path != NULL) {
+        load_mask(config, rank);
+    }
+    if (config.materials_path != NULL) {
+        load_materials(config, rank);
+    }
+
+    int *counts = (int *)malloc(size * sizeof(int));
+    int *displs = (int *)malloc(size * sizeof(int));
+    if (row_cells != NULL) {
+        double *equal = (double *)malloc(size * sizeof(double));
+        for (int r = 0; r < size; r++) equal[r] = 1.0;
+        weighted_partition(config.nx, size, equal, row_cells, halo_depth(config), counts, displs);
+        free(equal);
+    } else {
+        distribute_rows(config.nx, size, counts, displs);
+    }
+
+    int local_nx = counts[rank];
+    int start_row = displs[rank];
+    if (materials.kind != NULL) {
+        build_materials(config, local_nx, start_row);
+    }
+    if (config.axisymmetric) {
+        heat_grid grid = local_grid(config, local_nx);
+        if (heat_axisym_init(&axisym, &grid) != 0) {
+            fprintf(stderr, "ERROR: Axisymmetric weights allocation failed\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    // Each rank specializes for its own stripe; equal stripes share one cached build
+    if (config.jit && config.order == 4) {
+        if (rank == 0) {
+            fprintf(stderr, "[root] WARNING: --jit only applies to the 2nd-order stencil\n");
+        }
+    } else if (config.jit) {
+        heat_grid grid = local_grid(config, local_nx);
+        const heat_backend *jit = heat_jit_backend(&grid);
+        int ok = jit != NULL, all_ok = 0;
+        MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, sim_comm);
+        if (all_ok) {
+            backend = jit;
+        } else if (rank == 0) {
+            fprintf(stderr, "[root] WARNING: JIT kernel unavailable, using the %s backend\n", backend->name);
+        }
+    }
+
+    print_header(config, backend, rank, size);
+    validate_parameters(config, rank, size);
+    if (config.time_slices > 1) {
+        int status = run_parareal(config, backend, rank, size);
+        heat_axisym_free(&axisym);
+        free(counts);
+        free(displs);
+        return status;
+    }
+
+    // Prepare Gatherv metadata (elements, not rows)
+    int *recvcounts = (int *)malloc(size * sizeof(int));
+    int *displs_elems = (int *)malloc(size * sizeof(int));
+    for (int r = 0; r < size; r++) {
+        recvcounts[r] = counts[r] * config.ny;
+        displs_elems[r] = displs[r] * config.ny;
+    }
+
+    double *global_buffer = NULL;
+    if (rank == 0) {
+        global_buffer = (double *)malloc((size_t)config.nx * config.ny * sizeof(double));
+        if (!global_buffer) {
+            fprintf(stderr, "[root] ERROR: failed to allocate global buffer\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    // Ranks sharing a host: used for shared-memory halos and per-node RAPL reads
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(sim_comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    int node_rank;
+    MPI_Comm_rank(node_comm, &node_rank);
+
+    HaloContext halo = {0};
+    halo.mode = config.halo_mode;
+    halo.depth = halo_depth(config);
+    halo.node_comm = node_comm;
+
+    double *T, *T_new = NULL;
+    allocate_stripes(&halo, counts, config.ny, rank, size, &T, config.inplace ? NULL : &T_new);
+    if (halo.mode == HALO_RMA) {
+        setup_rma_halos(&halo, config.ny, rank, size);
+    }
+
+    initialize_local(T, config, local_nx, start_row);
+    if (mask.kind != NULL) {
+        // Fixed cells and holes are never written by the step, so both
+        // buffers carry them (a checkpoint already holds them too)
+        heat_grid grid = local_grid(config, local_nx);
+        heat_mask_fill(&mask, start_row - 1, &grid, T, 1, local_nx + 1);
+        heat_mask_fill(&mask, start_row - 1, &grid, T_new, 1, local_nx + 1);
+    }
+
+    if (config.restart_path) {
+        load_checkpoint_slice(T, config, local_nx, start_row);
+        if (rank == 0) {
+            printf("[root] Restarted from %s at step %d / %d\n", config.restart_path, start_step, config.steps);
+        }
+    } else {
+        // Write initial state
+        refresh_ghosts(T, config, local_nx, start_row, counts, displs, rank, size, &halo);
+        gather_and_write(T, config, local_nx, rank, recvcounts, displs_elems, global_buffer, "output_step_0000.txt",
+                         sim_comm);
+    }
+
+    // One RAPL reader per node: node-local rank 0 samples the shared sockets
+    heat_energy rapl = {0};
+    if (node_rank == 0) {
+        heat_energy_init(&rapl);
+    }
+
+    MPI_Barrier(sim_comm);
+    heat_energy_start(&rapl);
+    double t0 = MPI_Wtime();
+    double residual = 0.0;
+    int end_step = config.steps;
+    double window_compute = 0.0;
+    double imbalance = 0.0;
+    int rebalance_count = 0;
+    double halo_time = 0.0;
+
+    for (int step = start_step; step < config.steps; step++) {
+        double th = MPI_Wtime();
+        exchange_halos_mode(T, config, local_nx, rank, size, &halo);
+        double tc = MPI_Wtime();
+        halo_time += tc - th;
+        apply_boundaries(T, config, local_nx, start_row, counts, displs, rank, size);
+        update_temperature(T, T_new, config, local_nx, start_row, backend);
+        window_compute += MPI_Wtime() - tc;
+
+        if (T_new != NULL) {
+            double *tmp = T;
+            T = T_new;
+            T_new = tmp;
+        }
+
+        if (config.rebalance_interval > 0 && (step + 1) % config.rebalance_interval == 0) {
+            int rebalanced = 0;
+            imbalance = rebalance_rows(&T, &T_new, &halo, config, window_compute / config.rebalance_interval,
+                                       counts, displs, recvcounts, displs_elems, rank, size, &rebalanced);
+            window_compute = 0.0;
+            if (rebalanced) {
+                local_nx = counts[rank];
+                start_row = displs[rank];
+                rebalance_count++;
+                if (rank == 0) {
+                    printf("[root] Rebalanced at step %d (imbalance %.1f%%), rank 0 now owns %d rows\n",
+                           step + 1, (imbalance - 1.0) * 100.0, local_nx);
+                }
+            }
+        }
 
         if ((step + 1) % config.residual_interval == 0) {
             double local_res = compute_local_residual(T, config, local_nx, start_row);
-            MPI_Allreduce(&local_res, &residual, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            MPI_Allreduce(&local_res, &residual, 1, MPI_DOUBLE, MPI_MAX, sim_comm);
         }
 
         if ((step + 1) % config.output_interval == 0) {
             char fname[64];
             snprintf(fname, sizeof(fname), "output_step_%04d.txt", step + 1);
-            gather_and_write(T, config, local_nx, rank, recvcounts, displs_elems, global_buffer, fname);
+            refresh_ghosts(T, config, local_nx, start_row, counts, displs, rank, size, &halo);
+            gather_and_write(T, config, local_nx, rank, recvcounts, displs_elems, global_buffer, fname,
+                             sim_comm);
             if (rank == 0) {
                 printf("[root] Completed step %d / %d | residual %.2e\n", step + 1, config.steps, residual);
             }
         }
+
+        if (config.checkpoint_interval > 0 && (step + 1) % config.checkpoint_interval == 0) {
+            write_checkpoint(T, config, local_nx, start_row, step + 1, rank);
+        }
+
+        // Signals reach ranks at different steps, so agree on stopping collectively
+        if ((step + 1) % SIGNAL_POLL_INTERVAL == 0) {
+            int local_stop = stop_requested;
+            int any_stop = 0;
+            MPI_Allreduce(&local_stop, &any_stop, 1, MPI_INT, MPI_MAX, sim_comm);
+            if (any_stop) {
+                write_checkpoint(T, config, local_nx, start_row, step + 1, rank);
+                end_step = step + 1;
+                break;
+            }
+        }
     }
+    int steps_run = end_step - start_step;
 
     double local_elapsed = MPI_Wtime() - t0;
     double max_elapsed = 0.0;
-    MPI_Reduce(&local_elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    double max_halo_time = 0.0;
+    MPI_Reduce(&local_elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, sim_comm);
+    MPI_Reduce(&halo_time, &max_halo_time, 1, MPI_DOUBLE, MPI_MAX, 0, sim_comm);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    long max_rss_kb = 0;
+    MPI_Reduce(&usage.ru_maxrss, &max_rss_kb, 1, MPI_LONG, MPI_MAX, 0, sim_comm);
+
+    // Wait for every rank on this node before the reader samples the counters
+    MPI_Barrier(node_comm);
+    double local_energy[2] = {0.0, 0.0};
+    heat_energy_stop(&rapl, &local_energy[0], &local_energy[1]);
+    int local_nodes[2] = {node_rank == 0, rapl.count > 0};
+    double energy[2] = {0.0, 0.0};
+    int nodes[2] = {0, 0};
+    MPI_Reduce(local_energy, energy, 2, MPI_DOUBLE, MPI_SUM, 0, sim_comm);
+    MPI_Reduce(local_nodes, nodes, 2, MPI_INT, MPI_SUM, 0, sim_comm);
 
-    // Final output
-    gather_and_write(T, config, local_nx, rank, recvcounts, displs_elems, global_buffer, "output_final.txt");
+    // Final output (an interrupted run leaves only the checkpoint)
+    if (end_step == config.steps) {
+        refresh_ghosts(T, config, local_nx, start_row, counts, displs, rank, size, &halo);
+        gather_and_write(T, config, local_nx, rank, recvcounts, displs_elems, global_buffer, "output_final.txt",
+                         sim_comm);
+    }
 
     if (rank == 0) {
-        printf("\nSimulation complete.\n");
+        if (end_step == config.steps) {
+            printf("\nSimulation complete.\n");
+        } else {
+            printf("\nSimulation interrupted at step %d / %d.\n", end_step, config.steps);
+            printf("Resume with: --restart %s\n", config.checkpoint_path);
+        }
         printf("Elapsed (max across ranks): %.3f s\n", max_elapsed);
-        printf("Throughput: %.2f steps/s\n", config.steps / max_elapsed);
-        printf("Snapshots: output_step_*.txt + output_final.txt\n");
+        printf("Throughput: %.2f steps/s\n", steps_run / max_elapsed);
+        printf("Halo exchange (%s): %.3f s max across ranks (%.1f us/step)\n",
+               halo_mode_names[config.halo_mode], max_halo_time,
+               steps_run > 0 ? max_halo_time / steps_run * 1e6 : 0.0);
+        printf("Peak memory (RSS): %.1f MB max across ranks%s\n", max_rss_kb / 1024.0,
+               config.inplace ? " (updated in place)" : "");
+        if (config.rebalance_interval > 0) {
+            printf("Load balance: %d rebalances, last measured compute imbalance %.1f%%\n",
+                   rebalance_count, (imbalance - 1.0) * 100.0);
+        }
+        if (nodes[1] > 0) {
+            double joules = energy[0] + energy[1];
+            double mcell_updates = (double)(config.nx - 2) * (config.ny - 2) * steps_run * 1e-6;
+            printf("Energy (%d/%d nodes): %.2f J (pkg %.2f J, dram %.2f J)\n",
+                   nodes[1], nodes[0], joules, energy[0], energy[1]);
+            printf("Average power: %.2f W | %.4f J per Mcell-update\n",
+                   joules / max_elapsed, joules / mcell_updates);
+        } else {
+            printf("Energy: RAPL counters unavailable\n");
+        }
+        printf("Snapshots: %soutput_step_*.txt + %soutput_final.txt\n", config.output_prefix, config.output_prefix);
     }
 
-    free(T);
-    free(T_new);
+    free_stripes(&halo, T, T_new, config.ny);
+    if (halo.mode == HALO_RMA) {
+        free_rma_halos(&halo);
+    }
+    MPI_Comm_free(&node_comm);
+    heat_mask_free(&mask);
+    heat_materials_free(&materials);
+    heat_axisym_free(&axisym);
+    free(row_cells);
+    row_cells = NULL;
     free(counts);
     free(displs);
     free(recvcounts);
@@ -356,7 +1981,332 @@ int main(int argc, char **argv) {
     if (rank == 0) {
         free(global_buffer);
     }
+    return end_step == config.steps ? 0 : 1;
+}
+
+// One configuration of a sweep: a line "NAME KEY=VALUE ..." of the sweep
+// file applied over the command-line configuration. The config's strings
+// point into the overrides and the name buffers.
+typedef struct {
+    char name[SWEEP_NAME_MAX];
+    char prefix[SWEEP_NAME_MAX + 1];
+    char checkpoint_path[SWEEP_NAME_MAX + 16];
+    heat_config overrides;
+    SimulationConfig config;
+} SweepRun;
+
+// The configuration lines of a sweep file, cut in place; blank lines and
+// # comments are dropped
+static char **sweep_lines(char *text, int *count) {
+    int capacity = 1;
+    for (const char *c = text; *c; c++) capacity += *c == '\n';
+    char **lines = (char **)malloc(capacity * sizeof(char *));
+    *count = 0;
+    for (char *line = strtok(text, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+        char *comment = strchr(line, '#');
+        if (comment != NULL) *comment = '\0';
+        if (line[strspn(line, " \t\r")] != '\0') lines[(*count)++] = line;
+    }
+    return lines;
+}
 
-    MPI_Finalize();
+// -1 if the line is malformed or sets a key the solver does not know
+// (reported by rank 0)
+static int sweep_prepare(SweepRun *run, const char *line, SimulationConfig base, int rank) {
+    run->overrides.count = 0;
+    run->name[0] = '\0';
+    const char *c = line;
+    while (*(c += strspn(c, " \t\r")) != '\0') {
+        int len = (int)strcspn(c, " \t\r");
+        if (run->name[0] == '\0') {
+            if (len >= SWEEP_NAME_MAX) {
+                if (rank == 0) fprintf(stderr, "[root] ERROR: Sweep: name %.*s is too long\n", len, c);
+                return -1;
+            }
+            snprintf(run->name, sizeof(run->name), "%.*s", len, c);
+        } else {
+            char assignment[HEAT_CONFIG_KEY_MAX + HEAT_CONFIG_VALUE_MAX];
+            snprintf(assignment, sizeof(assignment), "%.*s", len, c);
+            if (heat_config_set(&run->overrides, assignment) != 0) {
+                if (rank == 0) fprintf(stderr, "[root] ERROR: Sweep %s: %s\n", run->name, run->overrides.error);
+                return -1;
+            }
+        }
+        c += len;
+    }
+
+    run->config = base;
+    if (apply_config(&run->config, &run->overrides, rank) != 0) {
+        if (rank == 0) fprintf(stderr, "[root] ERROR: Sweep %s: bad value\n", run->name);
+        return -1;
+    }
+    for (int e = 0; e < run->overrides.count; e++) {
+        if (!run->overrides.entries[e].used) {
+            if (rank == 0) {
+                fprintf(stderr, "[root] ERROR: Sweep %s: unknown key %s\n", run->name, run->overrides.entries[e].key);
+            }
+            return -1;
+        }
+    }
+    snprintf(run->prefix, sizeof(run->prefix), "%s_", run->name);
+    snprintf(run->checkpoint_path, sizeof(run->checkpoint_path), "%s_checkpoint.bin", run->name);
+    run->config.output_prefix = run->prefix;
+    run->config.checkpoint_path = run->checkpoint_path;
     return 0;
 }
+
+// Rank 0 checks every configuration before any group starts, so a typo
+// fails the sweep up front instead of aborting it hours in
+static int sweep_check(char **lines, int count, SimulationConfig base, char (*names)[SWEEP_NAME_MAX]) {
+    SweepRun *run = (SweepRun *)malloc(sizeof(SweepRun));
+    int status = 0;
+    for (int n = 0; n < count && status == 0; n++) {
+        status = sweep_prepare(run, lines[n], base, 0);
+        if (status != 0) break;
+        const char *error = config_error(run->config, base.group_size);
+        if (error == NULL && heat_select_backend(run->config.backend_name) == NULL) {
+            error = "Unknown stencil backend";
+        } else if (error == NULL && run->config.mask_path != NULL && access(run->config.mask_path, R_OK) != 0) {
+            error = "Cannot read the mask";
+        } else if (error == NULL && run->config.materials_path != NULL &&
+                   access(run->config.materials_path, R_OK) != 0) {
+            error = "Cannot read the materials";
+        }
+        for (int m = 0; m < n && error == NULL; m++) {
+            if (strcmp(names[m], run->name) == 0) error = "Name used twice (the outputs would collide)";
+        }
+        if (error != NULL) {
+            fprintf(stderr, "[root] ERROR: Sweep %s: %s\n", run->name, error);
+            status = -1;
+        }
+        memcpy(names[n], run->name, SWEEP_NAME_MAX);
+    }
+    free(run);
+    return status;
+}
+
+// Runs one configuration on `group`. The group's output goes to
+// NAME_log.txt: the leader truncates it, then every rank appends.
+static int sweep_run(SweepRun *run, const char *line, SimulationConfig base, MPI_Comm group, double *seconds) {
+    int group_rank;
+    MPI_Comm_rank(group, &group_rank);
+    sweep_prepare(run, line, base, -1);     // rank 0 has checked it
+    char log[SWEEP_NAME_MAX + 16];
+    snprintf(log, sizeof(log), "%s_log.txt", run->name);
+    fflush(stdout);
+    if (group_rank == 0) close(open(log, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    MPI_Barrier(group);
+    int saved = -1;
+    int fd = open(log, O_WRONLY | O_APPEND);
+    if (fd >= 0) {
+        saved = dup(STDOUT_FILENO);
+        dup2(fd, STDOUT_FILENO);
+        close(fd);
+    }
+    sim_comm = group;
+    double t0 = MPI_Wtime();
+    int status = run_simulation(run->config);
+    *seconds = MPI_Wtime() - t0;
+    sim_comm = MPI_COMM_WORLD;
+    if (saved >= 0) {
+        fflush(stdout);
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+    }
+    return status;
+}
+
+static void sweep_report(char (*names)[SWEEP_NAME_MAX], const int *result, const double *seconds,
+                         const int *group_of, int count, int groups, int group_size, double elapsed) {
+    int completed = 0;
+    double busy = 0.0, shortest = 0.0, longest = 0.0;
+    int *per_group = (int *)calloc(groups, sizeof(int));
+    FILE *fp = fopen(SWEEP_SUMMARY, "w");
+    if (fp) fprintf(fp, "# name group status seconds\n");
+    for (int n = 0; n < count; n++) {
+        const char *status = result[n] < 0 ? "not_run" : result[n] == 0 ? "complete" : "interrupted";
+        if (fp) fprintf(fp, "%s %d %s %.3f\n", names[n], group_of[n], status, seconds[n]);
+        if (result[n] != 0) continue;
+        shortest = completed == 0 ? seconds[n] : fmin(shortest, seconds[n]);
+        longest = fmax(longest, seconds[n]);
+        busy += seconds[n];
+        per_group[group_of[n]]++;
+        completed++;
+    }
+    if (fp) fclose(fp);
+
+    printf("\nSweep %s: %d / %d configurations on %d groups of %d ranks in %.3f s\n",
+           completed == count ? "complete" : "stopped", completed, count, groups, group_size, elapsed);
+    printf("Throughput: %.1f configurations/hour\n", completed / elapsed * 3600.0);
+    if (completed > 0) {
+        printf("Run time per configuration: mean %.3f s, min %.3f s, max %.3f s\n", busy / completed, shortest,
+               longest);
+    }
+    printf("Group utilization: %.1f%% of %d groups x elapsed\n", busy / (groups * elapsed) * 100.0, groups);
+    printf("Configurations per group:");
+    for (int g = 0; g < groups; g++) printf(" %d", per_group[g]);
+    printf("\nOutputs: NAME_output_*.txt, logs NAME_log.txt, summary %s\n", SWEEP_SUMMARY);
+    free(per_group);
+}
+
+// --sweep: rank 0 checks the list, then hands configurations to groups
+// of group_size ranks as they free up (a dynamic queue, since runs differ
+// in cost). Rank 0 only dispatches; with a single rank it runs the list
+// itself. A run stopped by a signal stops the dispatch.
+int run_sweep(SimulationConfig base, int rank, int size) {
+    char *text = broadcast_file(base.sweep_path, "sweep file", rank);
+    int count = 0;
+    char **lines = sweep_lines(text, &count);
+    int workers = size > 1 ? size - 1 : 1;
+    char (*names)[SWEEP_NAME_MAX] = NULL;
+    int status = 0;
+    if (rank == 0) {
+        names = (char (*)[SWEEP_NAME_MAX])calloc(count + 1, SWEEP_NAME_MAX);
+        if (base.group_size < 1 || workers % base.group_size != 0) {
+            fprintf(stderr, "[root] ERROR: --group-size %d must divide the %d worker ranks (all but rank 0)\n",
+                    base.group_size, workers);
+            status = -1;
+        } else if (base.restart_path != NULL) {
+            fprintf(stderr, "[root] ERROR: --restart does not apply to a sweep\n");
+            status = -1;
+        } else if (count == 0) {
+            fprintf(stderr, "[root] ERROR: No configurations in %s\n", base.sweep_path);
+            status = -1;
+        } else {
+            status = sweep_check(lines, count, base, names);
+        }
+    }
+    MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (status != 0) {
+        free(names);
+        free(lines);
+        free(text);
+        return EXIT_FAILURE;
+    }
+
+    int groups = workers / base.group_size;
+    SweepRun *run = (SweepRun *)malloc(sizeof(SweepRun));
+    int *result = (int *)malloc(count * sizeof(int));
+    int *group_of = (int *)calloc(count, sizeof(int));
+    double *seconds = (double *)calloc(count, sizeof(double));
+    for (int n = 0; n < count; n++) result[n] = -1;
+    int completed = 0;
+    if (rank == 0) {
+        printf("[root] Sweep: %d configurations from %s on %d groups of %d ranks\n", count, base.sweep_path, groups,
+               base.group_size);
+    }
+    double t0 = MPI_Wtime();
+
+    if (size == 1) {
+        for (int n = 0; n < count && !stop_requested; n++) {
+            result[n] = sweep_run(run, lines[n], base, MPI_COMM_WORLD, &seconds[n]);
+            completed++;
+            printf("[root] Sweep %s %s in %.3f s (%d / %d)\n", names[n], result[n] == 0 ? "complete" : "interrupted",
+                   seconds[n], completed, count);
+            if (result[n] != 0) break;
+        }
+    } else {
+        MPI_Comm group;
+        MPI_Comm_split(MPI_COMM_WORLD, rank == 0 ? MPI_UNDEFINED : (rank - 1) / base.group_size, rank, &group);
+        if (rank == 0) {
+            // Each report is a finished configuration (-1 at first), its status and run time
+            int next = 0, active = groups, stopping = 0;
+            while (active > 0) {
+                double report[3];
+                MPI_Status probe;
+                MPI_Recv(report, 3, MPI_DOUBLE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &probe);
+                int g = (probe.MPI_SOURCE - 1) / base.group_size;
+                int done = (int)report[0];
+                if (done >= 0) {
+                    result[done] = (int)report[1];
+                    seconds[done] = report[2];
+                    group_of[done] = g;
+                    completed++;
+                    stopping = stopping || result[done] != 0;
+                    printf("[root] Sweep %s %s on group %d in %.3f s (%d / %d)\n", names[done],
+                           result[done] == 0 ? "complete" : "interrupted", g, seconds[done], completed, count);
+                    fflush(stdout);
+                }
+                int assign = -1;
+                if (next < count && !stopping && !stop_requested) {
+                    assign = next++;
+                } else {
+                    active--;
+                }
+                MPI_Send(&assign, 1, MPI_INT, probe.MPI_SOURCE, 0, MPI_COMM_WORLD);
+            }
+        } else {
+            int group_rank;
+            MPI_Comm_rank(group, &group_rank);
+            double report[3] = {-1.0, 0.0, 0.0};
+            for (;;) {
+                int next = -1;
+                if (group_rank == 0) {
+                    MPI_Send(report, 3, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+                    MPI_Recv(&next, 1, MPI_INT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                }
+                MPI_Bcast(&next, 1, MPI_INT, 0, group);
+                if (next < 0) break;
+                report[0] = next;
+                report[1] = sweep_run(run, lines[next], base, group, &report[2]);
+            }
+            MPI_Comm_free(&group);
+        }
+    }
+
+    double elapsed = MPI_Wtime() - t0;
+    if (rank == 0) {
+        sweep_report(names, result, seconds, group_of, count, groups, base.group_size, elapsed);
+        for (int n = 0; n < count; n++) status = status || result[n] != 0;
+    }
+    free(run);
+    free(result);
+    free(group_of);
+    free(seconds);
+    free(names);
+    free(lines);
+    free(text);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    sim_comm = MPI_COMM_WORLD;
+
+    SimulationConfig config = {
+        .nx = NX, .ny = NY,
+        .alpha = ALPHA, .dx = DX, .dy = DY, .dt = DT,
+        .steps = STEPS,
+        .output_interval = OUTPUT_INTERVAL,
+        .residual_interval = RESIDUAL_INTERVAL,
+        .top_temp = TOP_TEMP, .bottom_temp = BOTTOM_TEMP,
+        .left_temp = LEFT_TEMP, .right_temp = RIGHT_TEMP,
+        .checkpoint_interval = CHECKPOINT_INTERVAL,
+        .checkpoint_path = CHECKPOINT_FILE,
+        .restart_path = NULL,
+        .rebalance_interval = REBALANCE_INTERVAL,
+        .halo_mode = HALO_MODE,
+        .backend_name = NULL,
+        .order = STENCIL_ORDER,
+        .mask_path = NULL,
+        .materials_path = NULL,
+        .time_slices = PARAREAL_SLICES,
+        .coarse_steps = PARAREAL_COARSE_STEPS,
+        .parareal_tol = PARAREAL_TOL,
+        .output_prefix = "",
+        .group_size = SWEEP_GROUP_SIZE
+    };
+
+    parse_args(argc, argv, &config, rank);
+
+    signal(SIGINT, request_stop);
+    signal(SIGTERM, request_stop);
+
+    int status = config.sweep_path != NULL ? run_sweep(config, rank, size) : run_simulation(config);
+    MPI_Finalize();
+    return status;
+}
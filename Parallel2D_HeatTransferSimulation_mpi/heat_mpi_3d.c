@@ -0,0 +1,387 @@
+#include <mpi.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Default global configuration
+#define NX 64
+#define NY 64
+#define NZ 64
+#define ALPHA 0.1
+#define DX 0.01
+#define DY 0.01
+#define DZ 0.01
+#define DT 0.0001
+#define STEPS 1000
+#define OUTPUT_INTERVAL 200
+#define RESIDUAL_INTERVAL 100
+
+// Face temperatures: top/bottom are the x faces, left/right the y faces,
+// front/back the z faces (same priority order on shared edges)
+#define TOP_TEMP 100.0
+#define BOTTOM_TEMP 100.0
+#define LEFT_TEMP 0.0
+#define RIGHT_TEMP 0.0
+#define FRONT_TEMP 50.0
+#define BACK_TEMP 50.0
+
+// Cache blocking of the 7-point stencil: tiles over (j, k), streaming in i
+#define BLOCK_J 16
+#define BLOCK_K 64
+
+typedef struct {
+    int nx, ny, nz;
+    double alpha, dx, dy, dz, dt;
+    int steps;
+    int output_interval;
+    int residual_interval;
+    double top_temp, bottom_temp, left_temp, right_temp, front_temp, back_temp;
+} SimulationConfig;
+
+// This rank's box in the Cartesian decomposition. Storage is one contiguous
+// (lx+2) x (ly+2) x (lz+2) array with a one-cell halo on every face.
+typedef struct {
+    MPI_Comm cart;
+    int dims[3];
+    int coords[3];
+    int lx, ly, lz;
+    int x0, y0, z0;
+    int lower[3], upper[3];
+    MPI_Datatype face[3];
+} Subdomain;
+
+static inline size_t idx3(int i, int j, int k, int ly, int lz) {
+    return ((size_t)i * (ly + 2) + j) * (lz + 2) + k;
+}
+
+// Same split as distribute_rows in heat_mpi.c, for one Cartesian axis
+void distribute_range(int n, int parts, int coord, int *count, int *start) {
+    int base = n / parts;
+    int extra = n % parts;
+    *count = base + (coord < extra ? 1 : 0);
+    *start = coord * base + (coord < extra ? coord : extra);
+}
+
+void setup_subdomain(Subdomain *sub, SimulationConfig config, int size) {
+    int periods[3] = {0, 0, 0};
+    sub->dims[0] = sub->dims[1] = sub->dims[2] = 0;
+    MPI_Dims_create(size, 3, sub->dims);
+    MPI_Cart_create(MPI_COMM_WORLD, 3, sub->dims, periods, 1, &sub->cart);
+
+    int cart_rank;
+    MPI_Comm_rank(sub->cart, &cart_rank);
+    MPI_Cart_coords(sub->cart, cart_rank, 3, sub->coords);
+
+    distribute_range(config.nx, sub->dims[0], sub->coords[0], &sub->lx, &sub->x0);
+    distribute_range(config.ny, sub->dims[1], sub->coords[1], &sub->ly, &sub->y0);
+    distribute_range(config.nz, sub->dims[2], sub->coords[2], &sub->lz, &sub->z0);
+
+    for (int d = 0; d < 3; d++) {
+        MPI_Cart_shift(sub->cart, d, 1, &sub->lower[d], &sub->upper[d]);
+    }
+
+    // Full padded faces, so edge and corner halos follow along in order
+    int px = sub->lx + 2, py = sub->ly + 2, pz = sub->lz + 2;
+    MPI_Type_contiguous(py * pz, MPI_DOUBLE, &sub->face[0]);
+    MPI_Type_vector(px, pz, py * pz, MPI_DOUBLE, &sub->face[1]);
+    MPI_Type_vector(px * py, 1, pz, MPI_DOUBLE, &sub->face[2]);
+    for (int d = 0; d < 3; d++) {
+        MPI_Type_commit(&sub->face[d]);
+    }
+}
+
+void free_subdomain(Subdomain *sub) {
+    for (int d = 0; d < 3; d++) {
+        MPI_Type_free(&sub->face[d]);
+    }
+    MPI_Comm_free(&sub->cart);
+}
+
+// Fixed value of a global boundary cell, or NAN for interior cells
+static double boundary_value(SimulationConfig config, int gi, int gj, int gk) {
+    if (gi == 0) return config.top_temp;
+    if (gi == config.nx - 1) return config.bottom_temp;
+    if (gj == 0) return config.left_temp;
+    if (gj == config.ny - 1) return config.right_temp;
+    if (gk == 0) return config.front_temp;
+    if (gk == config.nz - 1) return config.back_temp;
+    return NAN;
+}
+
+void initialize_local(double *T, SimulationConfig config, const Subdomain *sub) {
+    int ly = sub->ly, lz = sub->lz;
+    memset(T, 0, (size_t)(sub->lx + 2) * (ly + 2) * (lz + 2) * sizeof(double));
+
+    for (int i = 1; i <= sub->lx; i++) {
+        for (int j = 1; j <= ly; j++) {
+            for (int k = 1; k <= lz; k++) {
+                double value = boundary_value(config, sub->x0 + i - 1, sub->y0 + j - 1, sub->z0 + k - 1);
+                T[idx3(i, j, k, ly, lz)] = isnan(value) ? 0.0 : value;
+            }
+        }
+    }
+}
+
+// Owned cells that are not on a global face: [lo, hi] per axis in local indices
+static void interior_bounds(const Subdomain *sub, SimulationConfig config, int lo[3], int hi[3]) {
+    int count[3] = {sub->lx, sub->ly, sub->lz};
+    int start[3] = {sub->x0, sub->y0, sub->z0};
+    int n[3] = {config.nx, config.ny, config.nz};
+    for (int d = 0; d < 3; d++) {
+        lo[d] = start[d] == 0 ? 2 : 1;
+        hi[d] = start[d] + count[d] == n[d] ? count[d] - 1 : count[d];
+    }
+}
+
+void exchange_halos(double *T, const Subdomain *sub) {
+    int ly = sub->ly, lz = sub->lz;
+    int last[3] = {sub->lx, ly, lz};
+
+    for (int d = 0; d < 3; d++) {
+        int first_idx[3] = {0, 0, 0};
+        int last_idx[3] = {0, 0, 0};
+        int low_halo[3] = {0, 0, 0};
+        int high_halo[3] = {0, 0, 0};
+        first_idx[d] = 1;
+        last_idx[d] = last[d];
+        high_halo[d] = last[d] + 1;
+
+        // Send first owned layer down, receive the upper halo from above
+        MPI_Sendrecv(&T[idx3(first_idx[0], first_idx[1], first_idx[2], ly, lz)], 1, sub->face[d], sub->lower[d], d,
+                     &T[idx3(high_halo[0], high_halo[1], high_halo[2], ly, lz)], 1, sub->face[d], sub->upper[d], d,
+                     sub->cart, MPI_STATUS_IGNORE);
+        // Send last owned layer up, receive the lower halo from below
+        MPI_Sendrecv(&T[idx3(last_idx[0], last_idx[1], last_idx[2], ly, lz)], 1, sub->face[d], sub->upper[d], 3 + d,
+                     &T[idx3(low_halo[0], low_halo[1], low_halo[2], ly, lz)], 1, sub->face[d], sub->lower[d], 3 + d,
+                     sub->cart, MPI_STATUS_IGNORE);
+    }
+}
+
+// Global boundary cells are never written, so both buffers keep their
+// Dirichlet values and the inner loop needs no branches.
+void update_temperature(const double *T, double *T_new, SimulationConfig config, const Subdomain *sub) {
+    int ly = sub->ly, lz = sub->lz;
+    int lo[3], hi[3];
+    interior_bounds(sub, config, lo, hi);
+
+    double cx = config.alpha * config.dt / (config.dx * config.dx);
+    double cy = config.alpha * config.dt / (config.dy * config.dy);
+    double cz = config.alpha * config.dt / (config.dz * config.dz);
+    double cc = 1.0 - 2.0 * (cx + cy + cz);
+    size_t sx = (size_t)(ly + 2) * (lz + 2);
+    size_t sy = (size_t)(lz + 2);
+
+    for (int jj = lo[1]; jj <= hi[1]; jj += BLOCK_J) {
+        int j_end = jj + BLOCK_J - 1 < hi[1] ? jj + BLOCK_J - 1 : hi[1];
+        for (int kk = lo[2]; kk <= hi[2]; kk += BLOCK_K) {
+            int k_end = kk + BLOCK_K - 1 < hi[2] ? kk + BLOCK_K - 1 : hi[2];
+            for (int i = lo[0]; i <= hi[0]; i++) {
+                for (int j = jj; j <= j_end; j++) {
+                    const double *c = &T[idx3(i, j, 0, ly, lz)];
+                    double *out = &T_new[idx3(i, j, 0, ly, lz)];
+                    for (int k = kk; k <= k_end; k++) {
+                        out[k] = cc * c[k]
+                               + cx * (c[k - sx] + c[k + sx])
+                               + cy * (c[k - sy] + c[k + sy])
+                               + cz * (c[k - 1] + c[k + 1]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+double compute_local_residual(const double *T, SimulationConfig config, const Subdomain *sub) {
+    int ly = sub->ly, lz = sub->lz;
+    int lo[3], hi[3];
+    interior_bounds(sub, config, lo, hi);
+
+    double rx = 1.0 / (config.dx * config.dx);
+    double ry = 1.0 / (config.dy * config.dy);
+    double rz = 1.0 / (config.dz * config.dz);
+    size_t sx = (size_t)(ly + 2) * (lz + 2);
+    size_t sy = (size_t)(lz + 2);
+    double max_res = 0.0;
+
+    for (int i = lo[0]; i <= hi[0]; i++) {
+        for (int j = lo[1]; j <= hi[1]; j++) {
+            const double *c = &T[idx3(i, j, 0, ly, lz)];
+            for (int k = lo[2]; k <= hi[2]; k++) {
+                double laplacian = (c[k - sx] - 2.0 * c[k] + c[k + sx]) * rx +
+                                   (c[k - sy] - 2.0 * c[k] + c[k + sy]) * ry +
+                                   (c[k - 1] - 2.0 * c[k] + c[k + 1]) * rz;
+                double res = fabs(laplacian);
+                if (res > max_res) {
+                    max_res = res;
+                }
+            }
+        }
+    }
+    return max_res;
+}
+
+// Collective MPI-IO write: a 16-byte header (int32 nx, ny, nz, 0) followed
+// by the global nx*ny*nz field in C order (z fastest)
+void write_snapshot(const double *T, SimulationConfig config, const Subdomain *sub, int rank, const char *filename) {
+    MPI_File fh;
+    if (MPI_File_open(sub->cart, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                      MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) {
+            fprintf(stderr, "[root] ERROR: Unable to open %s for writing\n", filename);
+        }
+        return;
+    }
+
+    int32_t header[4] = {config.nx, config.ny, config.nz, 0};
+    MPI_Offset header_bytes = sizeof(header);
+    MPI_File_set_size(fh, header_bytes + (MPI_Offset)config.nx * config.ny * config.nz * sizeof(double));
+    if (rank == 0) {
+        MPI_File_write_at(fh, 0, header, 4, MPI_INT32_T, MPI_STATUS_IGNORE);
+    }
+
+    int global_sizes[3] = {config.nx, config.ny, config.nz};
+    int local_sizes[3] = {sub->lx, sub->ly, sub->lz};
+    int global_starts[3] = {sub->x0, sub->y0, sub->z0};
+    int padded_sizes[3] = {sub->lx + 2, sub->ly + 2, sub->lz + 2};
+    int padded_starts[3] = {1, 1, 1};
+
+    MPI_Datatype file_type, mem_type;
+    MPI_Type_create_subarray(3, global_sizes, local_sizes, global_starts, MPI_ORDER_C, MPI_DOUBLE, &file_type);
+    MPI_Type_create_subarray(3, padded_sizes, local_sizes, padded_starts, MPI_ORDER_C, MPI_DOUBLE, &mem_type);
+    MPI_Type_commit(&file_type);
+    MPI_Type_commit(&mem_type);
+
+    MPI_File_set_view(fh, header_bytes, MPI_DOUBLE, file_type, "native", MPI_INFO_NULL);
+    MPI_File_write_all(fh, T, 1, mem_type, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+
+    MPI_Type_free(&file_type);
+    MPI_Type_free(&mem_type);
+
+    if (rank == 0) {
+        printf("[root] Saved %s\n", filename);
+    }
+}
+
+void print_header(SimulationConfig config, const Subdomain *sub, int rank, int size) {
+    if (rank != 0) return;
+    printf("==============================================\n");
+    printf("   MPI 3D Heat Equation Simulation\n");
+    printf("==============================================\n");
+    printf("Grid: %d x %d x %d\n", config.nx, config.ny, config.nz);
+    printf("Steps: %d (output every %d)\n", config.steps, config.output_interval);
+    printf("Diffusivity (alpha): %.3f\n", config.alpha);
+    printf("dt = %.6f, dx = %.3f, dy = %.3f, dz = %.3f\n", config.dt, config.dx, config.dy, config.dz);
+    printf("Face temps: top=%.1f, bottom=%.1f, left=%.1f, right=%.1f, front=%.1f, back=%.1f\n",
+           config.top_temp, config.bottom_temp, config.left_temp, config.right_temp,
+           config.front_temp, config.back_temp);
+    printf("MPI tasks: %d (%d x %d x %d Cartesian grid)\n", size, sub->dims[0], sub->dims[1], sub->dims[2]);
+    printf("Stencil blocking: %d x %d (j x k)\n", BLOCK_J, BLOCK_K);
+    printf("==============================================\n\n");
+}
+
+void validate_parameters(SimulationConfig config, int rank) {
+    double inv_h2 = 1.0 / (config.dx * config.dx) + 1.0 / (config.dy * config.dy) + 1.0 / (config.dz * config.dz);
+    double stable_dt = 0.5 / (config.alpha * inv_h2);
+    if (rank == 0) {
+        if (config.dt > stable_dt) {
+            printf("[root] WARNING: dt=%.6f exceeds stable dt=%.6f\n", config.dt, stable_dt);
+            printf("        Reduce dt or increase dx/dy/dz for stability.\n");
+        } else {
+            printf("[root] Stability check OK (dt=%.6f <= %.6f)\n\n", config.dt, stable_dt);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    SimulationConfig config = {
+        .nx = NX, .ny = NY, .nz = NZ,
+        .alpha = ALPHA, .dx = DX, .dy = DY, .dz = DZ, .dt = DT,
+        .steps = STEPS,
+        .output_interval = OUTPUT_INTERVAL,
+        .residual_interval = RESIDUAL_INTERVAL,
+        .top_temp = TOP_TEMP, .bottom_temp = BOTTOM_TEMP,
+        .left_temp = LEFT_TEMP, .right_temp = RIGHT_TEMP,
+        .front_temp = FRONT_TEMP, .back_temp = BACK_TEMP
+    };
+
+    Subdomain sub;
+    setup_subdomain(&sub, config, size);
+    MPI_Comm_rank(sub.cart, &rank);
+
+    print_header(config, &sub, rank, size);
+    validate_parameters(config, rank);
+
+    size_t local_cells = (size_t)(sub.lx + 2) * (sub.ly + 2) * (sub.lz + 2);
+    double *T = (double *)malloc(local_cells * sizeof(double));
+    double *T_new = (double *)malloc(local_cells * sizeof(double));
+    if (!T || !T_new) {
+        fprintf(stderr, "[rank %d] ERROR: allocation failed\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    initialize_local(T, config, &sub);
+    memcpy(T_new, T, local_cells * sizeof(double));
+
+    // Write initial state
+    write_snapshot(T, config, &sub, rank, "output3d_step_0000.bin");
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime();
+    double residual = 0.0;
+
+    for (int step = 0; step < config.steps; step++) {
+        exchange_halos(T, &sub);
+        update_temperature(T, T_new, config, &sub);
+
+        double *tmp = T;
+        T = T_new;
+        T_new = tmp;
+
+        if ((step + 1) % config.residual_interval == 0) {
+            exchange_halos(T, &sub);
+            double local_res = compute_local_residual(T, config, &sub);
+            MPI_Allreduce(&local_res, &residual, 1, MPI_DOUBLE, MPI_MAX, sub.cart);
+        }
+
+        if ((step + 1) % config.output_interval == 0) {
+            char fname[64];
+            snprintf(fname, sizeof(fname), "output3d_step_%04d.bin", step + 1);
+            write_snapshot(T, config, &sub, rank, fname);
+            if (rank == 0) {
+                printf("[root] Completed step %d / %d | residual %.2e\n", step + 1, config.steps, residual);
+            }
+        }
+    }
+
+    double local_elapsed = MPI_Wtime() - t0;
+    double max_elapsed = 0.0;
+    MPI_Reduce(&local_elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, sub.cart);
+
+    // Final output
+    write_snapshot(T, config, &sub, rank, "output3d_final.bin");
+
+    if (rank == 0) {
+        double mcell_updates = (double)(config.nx - 2) * (config.ny - 2) * (config.nz - 2) * config.steps * 1e-6;
+        printf("\nSimulation complete.\n");
+        printf("Elapsed (max across ranks): %.3f s\n", max_elapsed);
+        printf("Throughput: %.2f steps/s (%.1f Mcell-updates/s)\n",
+               config.steps / max_elapsed, mcell_updates / max_elapsed);
+        printf("Snapshots: output3d_step_*.bin + output3d_final.bin\n");
+    }
+
+    free(T);
+    free(T_new);
+    free_subdomain(&sub);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,62 @@
+import numpy as np
+import matplotlib.pyplot as plt
+import os
+import sys
+
+def read_volume(filename):
+    """Read a heat_mpi_3d snapshot: int32 nx, ny, nz, 0 header + float64 field"""
+    try:
+        with open(filename, 'rb') as f:
+            nx, ny, nz, _ = np.fromfile(f, dtype=np.int32, count=4)
+            data = np.fromfile(f, dtype=np.float64, count=nx * ny * nz)
+        volume = data.reshape((nx, ny, nz))
+        print(f"Loaded data from {filename}, shape: {volume.shape}")
+        return volume
+    except Exception as e:
+        print(f"Error reading {filename}: {e}")
+        return None
+
+def plot_mid_slices(T, title, output_file):
+    """Save the three mid-plane slices of a volume side by side"""
+    nx, ny, nz = T.shape
+    slices = [
+        (T[nx // 2, :, :], f'x = {nx // 2}', 'Z', 'Y'),
+        (T[:, ny // 2, :], f'y = {ny // 2}', 'Z', 'X'),
+        (T[:, :, nz // 2], f'z = {nz // 2}', 'Y', 'X'),
+    ]
+
+    fig, axes = plt.subplots(1, 3, figsize=(18, 6))
+    for ax, (plane, label, xlabel, ylabel) in zip(axes, slices):
+        im = ax.imshow(plane, cmap='hot', origin='lower', vmin=0, vmax=100)
+        ax.set_title(f'{title} ({label})')
+        ax.set_xlabel(xlabel)
+        ax.set_ylabel(ylabel)
+    fig.colorbar(im, ax=axes, label='Temperature (°C)', shrink=0.8)
+
+    plt.savefig(output_file, dpi=150, bbox_inches='tight')
+    plt.close()
+    print(f"Saved plot: {output_file}")
+
+def main():
+    output_dir = "plots"
+    if not os.path.exists(output_dir):
+        os.makedirs(output_dir)
+
+    files = sys.argv[1:]
+    if not files:
+        files = sorted(f for f in os.listdir('.') if f.startswith('output3d_step_') and f.endswith('.bin'))
+        if os.path.exists('output3d_final.bin'):
+            files.append('output3d_final.bin')
+    if not files:
+        print("No output3d_*.bin files found. Run heat_mpi_3d first.")
+        return
+
+    for filename in files:
+        T = read_volume(filename)
+        if T is None:
+            continue
+        name = os.path.splitext(os.path.basename(filename))[0]
+        plot_mid_slices(T, name, f"{output_dir}/{name}_slices.png")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,507 @@
+#ifndef HEAT_H
+#define HEAT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// libheat: the 2D explicit heat-equation kernels shared by the local and
+// MPI drivers. Fields are row-major doubles; a grid descriptor says how
+// the caller's array is laid out, a region says which cells to update.
+
+#define HEAT_API_VERSION 1
+#define HEAT_MAX_BACKENDS 16
+
+// Name of the environment variable consulted by heat_select_backend
+#define HEAT_BACKEND_ENV "HEAT_BACKEND"
+#define HEAT_DEFAULT_BACKEND "scalar"
+
+// Layout and physics of one (local) array, including boundary/halo cells
+typedef struct {
+    int rows, cols;             // allocated extent
+    int stride;                 // doubles between the starts of consecutive rows (>= cols)
+    double alpha, dx, dy, dt;
+} heat_grid;
+
+// Half-open cell range [row_begin, row_end) x [col_begin, col_end). Every
+// cell in it needs its four neighbours inside the grid.
+typedef struct {
+    int row_begin, row_end;
+    int col_begin, col_end;
+} heat_region;
+
+// One explicit step over `region`: T_new = T + alpha*dt*Laplacian(T).
+// Cells outside the region are not written. Returns max |T_new - T|.
+typedef double (*heat_step_fn)(const heat_grid *grid, const double *T, double *T_new, heat_region region);
+
+// The same step written back over T. Old values of the rows around the
+// one being updated are kept in a small line buffer, so no second field
+// is needed and the result is bit-identical to `step`.
+typedef double (*heat_step_inplace_fn)(const heat_grid *grid, double *T, heat_region region);
+
+typedef struct {
+    const char *name;
+    const char *description;
+    heat_step_fn step;
+    heat_step_inplace_fn step_inplace;  // optional; NULL uses the serial sweep in heat_step_inplace
+} heat_backend;
+
+// Backend registry. The built-in backends (scalar, simd, threaded, tiled)
+// are registered on first use. Returns 0, or -1 if the name is taken or
+// the registry is full.
+int heat_register_backend(const heat_backend *backend);
+const heat_backend *heat_get_backend(const char *name);
+int heat_backend_count(void);
+const heat_backend *heat_backend_at(int index);
+
+// `name` if given, else $HEAT_BACKEND, else "scalar". NULL if unknown.
+const heat_backend *heat_select_backend(const char *name);
+void heat_list_backends(FILE *fp);
+
+// All cells except the outermost ring
+heat_region heat_interior(const heat_grid *grid);
+
+// In-place step with `backend` (NULL: scalar). Drivers that set
+// $HEAT_INPLACE, or take --inplace, allocate only T.
+#define HEAT_INPLACE_ENV "HEAT_INPLACE"
+double heat_step_inplace(const heat_backend *backend, const heat_grid *grid, double *T, heat_region region);
+
+// Max |Laplacian(T)| over the region (the convergence residual)
+double heat_residual(const heat_grid *grid, const double *T, heat_region region);
+
+// Boundary conditions are applied by filling the outer ring of a grid
+// (the ghost cells) once per step, before the interior update. Dirichlet
+// fixes the ring to `value`. Neumann and Robin hold on the face between
+// the ring and the first interior row/column. Periodic copies the
+// opposite interior row/column, so the period is rows-2 (or cols-2).
+typedef enum {
+    HEAT_BC_DIRICHLET,
+    HEAT_BC_NEUMANN,
+    HEAT_BC_ROBIN,
+    HEAT_BC_PERIODIC,
+    HEAT_BC_COUNT
+} heat_bc_type;
+
+typedef enum {
+    HEAT_EDGE_TOP,              // row 0
+    HEAT_EDGE_BOTTOM,           // row rows-1
+    HEAT_EDGE_LEFT,             // column 0
+    HEAT_EDGE_RIGHT,            // column cols-1
+    HEAT_EDGE_COUNT
+} heat_edge;
+
+typedef struct {
+    heat_bc_type type;
+    double value;               // dirichlet: temperature; neumann: outward dT/dn; robin: ambient temperature
+    double coeff;               // robin: transfer coefficient over conductivity (1/length)
+} heat_bc;
+
+const char *heat_bc_name(heat_bc_type type);
+const char *heat_edge_name(heat_edge edge);
+
+// Parse "EDGE=TYPE[:PARAM]" (e.g. "left=neumann", "right=robin:5").
+// Returns 0 on success, -1 on a malformed spec.
+int heat_parse_bc(const char *spec, heat_edge *edge, heat_bc_type *type, double *param);
+
+// Fill the ghost cells of `edge` for positions [begin, end) along it
+// (columns for top/bottom, rows for left/right)
+void heat_fill_edge(const heat_grid *grid, double *T, heat_edge edge, const heat_bc *bc, int begin, int end);
+
+// 4th-order step and residual: the wide 9-point cross (two cells each
+// way), so the grid needs two rows/columns of halo around `region`
+// except on sides flagged in `edges` (HEAT_EDGE_BIT of each side whose
+// neighbouring row/column is a Dirichlet boundary). Those use a one-sided
+// closure that reads only the boundary value. Stable for
+// alpha*dt*(1/dx^2 + 1/dy^2) <= 3/8.
+#define HEAT_EDGE_BIT(edge) (1u << (edge))
+#define HEAT_ALL_EDGES 0xfu
+double heat_step4(const heat_grid *grid, const double *T, double *T_new, heat_region region, unsigned edges);
+double heat_residual4(const heat_grid *grid, const double *T, heat_region region, unsigned edges);
+
+// Solver configuration: a JSON file (config.json) flattened to dotted
+// keys such as "simulation.nx", plus "KEY=VALUE" command-line overrides.
+// Values are kept as text; the drivers convert the keys they know.
+#define HEAT_CONFIG_MAX_ENTRIES 128
+#define HEAT_CONFIG_KEY_MAX 64
+#define HEAT_CONFIG_VALUE_MAX 128
+
+typedef struct {
+    char key[HEAT_CONFIG_KEY_MAX];
+    char value[HEAT_CONFIG_VALUE_MAX];
+    int used;                   // set by the typed getters
+} heat_config_entry;
+
+typedef struct {
+    int count;
+    heat_config_entry entries[HEAT_CONFIG_MAX_ENTRIES];
+    char error[256];            // reason for the last failed load/set
+} heat_config;
+
+// 0 on success, -1 on I/O or syntax errors (see cfg->error)
+int heat_config_load(heat_config *cfg, const char *path);
+// The same for JSON text already in memory; `name` prefixes errors
+int heat_config_parse(heat_config *cfg, const char *text, const char *name);
+// "section.key=value", replacing an existing entry. 0 or -1.
+int heat_config_set(heat_config *cfg, const char *assignment);
+const char *heat_config_get(heat_config *cfg, const char *key);
+
+// Typed getters: 1 if the key was found and converted, 0 if absent,
+// -1 if present but malformed. `out` is only written on success.
+int heat_config_int(heat_config *cfg, const char *key, int *out);
+int heat_config_double(heat_config *cfg, const char *key, double *out);
+int heat_config_bool(heat_config *cfg, const char *key, int *out);
+
+// Warn about entries under `prefix` that no getter asked for; returns how many
+int heat_config_warn_unused(const heat_config *cfg, const char *prefix, FILE *fp);
+
+// JIT backend: writes a C kernel with this grid's columns, stride and
+// stencil coefficients as literals, compiles it with $HEAT_JIT_CC (default
+// "cc") into a cached shared object under $HEAT_JIT_CACHE (default
+// $TMPDIR/libheat-jit-<uid>), loads it with dlopen and registers it as
+// backend "jit". Grids it was not built for fall back to the scalar loop.
+// NULL (with a message on stderr) if compiling or loading fails.
+#define HEAT_JIT_CC_ENV "HEAT_JIT_CC"
+#define HEAT_JIT_CACHE_ENV "HEAT_JIT_CACHE"
+const heat_backend *heat_jit_backend(const heat_grid *grid);
+
+// Rows [row_begin, row_end), all columns, as "%.6f " text lines
+void heat_write_rows(const heat_grid *grid, const double *T, int row_begin, int row_end, FILE *fp);
+
+// Field storage. Row-major puts the cells above and below a point a full
+// row apart. The tiled layouts store HEAT_LAYOUT_TILE x HEAT_LAYOUT_TILE
+// blocks contiguously (one 64-byte line per tile row), in row-major or
+// Z (Morton) order, so a stencil's neighbours share a few pages. Cells
+// are addressed with HEAT_AT; grids are padded to whole tiles.
+#define HEAT_LAYOUT_ENV "HEAT_LAYOUT"
+#define HEAT_LAYOUT_TILE 8
+
+typedef enum {
+    HEAT_LAYOUT_ROW_MAJOR,
+    HEAT_LAYOUT_TILED,
+    HEAT_LAYOUT_MORTON,
+    HEAT_LAYOUT_COUNT
+} heat_layout_kind;
+
+typedef struct {
+    heat_layout_kind kind;
+    int rows, cols;
+    int tiles_down, tiles_across;
+    size_t *tile_offset;        // start of tile (ti, tj) at [ti * tiles_across + tj]; NULL for row-major
+    size_t size;                // doubles to allocate
+} heat_layout;
+
+const char *heat_layout_name(heat_layout_kind kind);
+// "rowmajor", "tiled" or "morton"; NULL or "" is row-major. -1 if unknown.
+int heat_parse_layout(const char *name);
+// 0, or -1 if the tile table cannot be allocated
+int heat_layout_init(heat_layout *layout, heat_layout_kind kind, int rows, int cols);
+void heat_layout_free(heat_layout *layout);
+
+static inline size_t heat_layout_index(const heat_layout *layout, int i, int j) {
+    if (layout->tile_offset == NULL) return (size_t)i * layout->cols + j;
+    return layout->tile_offset[(i / HEAT_LAYOUT_TILE) * layout->tiles_across + j / HEAT_LAYOUT_TILE] +
+           (size_t)(i % HEAT_LAYOUT_TILE) * HEAT_LAYOUT_TILE + j % HEAT_LAYOUT_TILE;
+}
+#define HEAT_AT(layout, T, i, j) ((T)[heat_layout_index((layout), (i), (j))])
+
+// Step, residual and text output for a field stored in `layout`. `grid`
+// supplies the physics (its rows/cols must match the layout). Row-major
+// fields go through `backend` (NULL: scalar) and the functions above. The
+// tiled kernels do the same per-cell arithmetic, so every layout produces
+// bit-identical fields. Output is streamed back in row-major order.
+double heat_layout_step(const heat_layout *layout, const heat_backend *backend, const heat_grid *grid,
+                        const double *T, double *T_new, heat_region region);
+double heat_layout_residual(const heat_layout *layout, const heat_grid *grid, const double *T, heat_region region);
+void heat_layout_write_rows(const heat_layout *layout, const double *T, int row_begin, int row_end, FILE *fp);
+
+// Masked geometries. A mask file has one line per grid row and one
+// character per cell: '.' active, '#' hole (no material; faces towards it
+// are insulated), 'A'-'Z' fixed at the temperature set by an earlier
+// "temp LETTER VALUE" line. Lines starting with ';' are comments. The
+// outer ring follows the boundary conditions whatever the map says.
+// Active interior cells are stored per row as runs whose neighbours all
+// hold temperatures (updated with the plain 5-point loop) and rim cells
+// next to a hole (their hole neighbours are replaced by the cell itself).
+#define HEAT_CELL_ACTIVE '.'
+#define HEAT_CELL_HOLE '#'
+
+typedef struct {
+    int col_begin, col_end;
+} heat_run;
+
+typedef struct {
+    int col;
+    int up, down, left, right;  // 1 if that neighbour holds a temperature, 0 if it is a hole
+} heat_rim_cell;
+
+typedef struct {
+    int rows, cols;
+    unsigned char *kind;        // rows*cols map characters
+    double fixed_temp[26];      // per letter; NaN if unset
+    int *run_start;             // runs of row i are runs[run_start[i] .. run_start[i+1])
+    heat_run *runs;
+    int *rim_start;             // likewise for rim
+    heat_rim_cell *rim;
+    long long active_cells;
+    char error[256];            // reason for the last failed parse/load
+} heat_mask;
+
+// 0, or -1 with mask->error set. With wrap_rows/wrap_cols (periodic
+// edges) a hole on the far side counts as a neighbour across the seam.
+int heat_mask_parse(heat_mask *mask, const char *text, int rows, int cols, int wrap_rows, int wrap_cols);
+int heat_mask_load(heat_mask *mask, const char *path, int rows, int cols, int wrap_rows, int wrap_cols);
+// Whole file as a NUL-terminated string (free() it), NULL if unreadable
+char *heat_mask_read(const char *path);
+void heat_mask_free(heat_mask *mask);
+// Active cells in one row (the row weight for load balancing)
+int heat_mask_row_cells(const heat_mask *mask, int row);
+
+// Row i of `grid` is mask row i + row_offset (MPI stripes pass their
+// start row minus one). heat_mask_fill writes the fixed temperatures, and
+// NaN into holes, for rows [row_begin, row_end); both time levels need it
+// since the step never writes those cells. The step and residual cover
+// the active cells inside `region`.
+void heat_mask_fill(const heat_mask *mask, int row_offset, const heat_grid *grid, double *T,
+                    int row_begin, int row_end);
+double heat_mask_step(const heat_mask *mask, int row_offset, const heat_grid *grid, const double *T,
+                      double *T_new, heat_region region);
+double heat_mask_residual(const heat_mask *mask, int row_offset, const heat_grid *grid, const double *T,
+                          heat_region region);
+
+// Multi-material plates. A materials file has one line per grid row and
+// one character per cell naming its material; "alpha SYMBOL VALUE" lines
+// set each material's diffusivity before its first use, and '.' is the
+// solver's own alpha unless redefined. Lines starting with ';' are
+// comments. The step is the conservative flux form: each face carries
+// dt * k / h^2 * (T_neighbour - T), with k the harmonic mean of the two
+// cells' alpha. These face coefficients are computed once by
+// heat_materials_build into two arrays (the face below and the face to
+// the right of every cell), so the loop has no divisions or means. A
+// uniform map gives the plain stencil to rounding.
+#define HEAT_MATERIAL_BASE '.'
+
+typedef struct {
+    int rows, cols;
+    int wrap_rows, wrap_cols;   // periodic edges: ghost cells take the opposite cell's material
+    unsigned char *kind;        // rows*cols map characters
+    double alpha[256];          // per character; NaN if undefined
+    double alpha_min, alpha_max;
+    int row_begin, row_end;     // map rows covered by the coefficients
+    int single;                 // coefficients stored as float (half the extra bandwidth)
+    double *down, *right;       // per cell of those rows, double storage
+    float *down_f, *right_f;    // likewise, float storage
+    char error[256];            // reason for the last failed parse/load/build
+} heat_materials;
+
+// 0, or -1 with materials->error set
+int heat_materials_parse(heat_materials *materials, const char *text, int rows, int cols, double base_alpha,
+                         int wrap_rows, int wrap_cols);
+int heat_materials_load(heat_materials *materials, const char *path, int rows, int cols, double base_alpha,
+                        int wrap_rows, int wrap_cols);
+// Face coefficients of map rows [row_begin, row_end) for grid->dt, dx
+// and dy (rebuilding replaces them). Updating row i needs rows i-1 and i.
+int heat_materials_build(heat_materials *materials, const heat_grid *grid, int row_begin, int row_end,
+                         int single);
+void heat_materials_free(heat_materials *materials);
+// Row i of `grid` is map row i + row_offset, as for masks. The residual
+// is max |div(k grad T)| / grid->alpha, which is heat_residual for a
+// uniform map at the grid's alpha.
+double heat_materials_step(const heat_materials *materials, int row_offset, const heat_grid *grid,
+                           const double *T, double *T_new, heat_region region);
+double heat_materials_residual(const heat_materials *materials, int row_offset, const heat_grid *grid,
+                               const double *T, heat_region region);
+
+// Stretched grids: tensor-product node spacing that clusters rows (x)
+// and/or columns (y) toward chosen edges. The domain keeps its uniform
+// extent, (rows-1)*dx by (cols-1)*dy. "tanh:B" maps evenly spaced
+// parameters through tanh with strength B; "geometric:R" grows each
+// interval by R away from the clustered edge. Either clusters toward
+// both edges, or only the start (top/left) or end (bottom/right).
+typedef enum {
+    HEAT_STRETCH_UNIFORM,
+    HEAT_STRETCH_TANH,
+    HEAT_STRETCH_GEOMETRIC,
+    HEAT_STRETCH_COUNT
+} heat_stretch_kind;
+
+typedef enum {
+    HEAT_CLUSTER_BOTH,
+    HEAT_CLUSTER_START,
+    HEAT_CLUSTER_END
+} heat_cluster_side;
+
+typedef struct {
+    heat_stretch_kind kind;
+    double param;               // tanh strength or geometric ratio
+    heat_cluster_side side;
+} heat_stretch;
+
+const char *heat_stretch_name(heat_stretch_kind kind);
+// Parse "AXIS=KIND[:PARAM[:SIDE]]" (e.g. "x=tanh:2.5", "y=geometric:1.05:start"),
+// axis 0 for x (rows), 1 for y (columns). 0, or -1 on a malformed spec.
+int heat_parse_stretch(const char *spec, int *axis, heat_stretch *stretch);
+// n node coordinates from 0 to length
+void heat_stretch_coords(const heat_stretch *stretch, int n, double length, double *coord);
+
+// Node coordinates and the 5-point weights of each row and column, with
+// alpha * dt folded in, so the step does four multiply-adds per cell
+// like the uniform loop. Neighbour weights come from the non-uniform
+// second difference 2 / (h- + h+) * (slope+ - slope-).
+typedef struct {
+    int rows, cols;
+    double *x, *y;              // node coordinates down the rows / across the columns
+    double *up, *down;          // per row: weights of the row above and below
+    double *left, *right;       // per column
+} heat_stretched;
+
+// 0, or -1 if allocation fails. Rebuild if grid->dt or alpha change.
+int heat_stretched_init(heat_stretched *st, const heat_grid *grid, const heat_stretch *sx, const heat_stretch *sy);
+void heat_stretched_free(heat_stretched *st);
+// Largest stable dt for diffusivity alpha (set by the finest cell)
+double heat_stretched_stable_dt(const heat_stretched *st, double alpha);
+double heat_stretched_step(const heat_stretched *st, const heat_grid *grid, const double *T, double *T_new,
+                           heat_region region);
+// heat_fill_edge with that edge's first spacing for Neumann and Robin
+void heat_stretched_fill_edge(const heat_stretched *st, const heat_grid *grid, double *T, heat_edge edge,
+                              const heat_bc *bc, int begin, int end);
+
+// Axisymmetric (r-z) grids: rows are z, columns are r, and column 0 is
+// the axis r = 0. Interior columns use the conservative cylindrical
+// Laplacian, alpha dt / dy^2 * r_{j-/+1/2} / r_j towards the inner/outer
+// neighbour, so the weight into the axis vanishes. The axis column is a
+// real node updated from the regularity condition dT/dr = 0, where the
+// radial term becomes 2 d2T/dr2, i.e. weight 4 alpha dt / dy^2 towards
+// column 1; the left edge therefore takes no boundary condition.
+typedef struct {
+    int cols;
+    double axial;   // alpha * dt / dx^2, up and down
+    double *inner;  // per column, towards j - 1 (0 on the axis)
+    double *outer;  // per column, towards j + 1
+} heat_axisym;
+
+// 0, or -1 when out of memory
+int heat_axisym_init(heat_axisym *ax, const heat_grid *grid);
+void heat_axisym_free(heat_axisym *ax);
+// The axis cell has the largest weights: dt <= 1 / (alpha (2/dx^2 + 4/dy^2))
+double heat_axisym_stable_dt(const heat_grid *grid);
+// As backend->step; a region starting at column 1 also updates the axis
+double heat_axisym_step(const heat_axisym *ax, const heat_grid *grid, const double *T, double *T_new,
+                        heat_region region);
+// Max |cylindrical Laplacian|, comparable with heat_residual
+double heat_axisym_residual(const heat_axisym *ax, const heat_grid *grid, const double *T, heat_region region);
+
+// Boundary superposition. With fixed coefficients and a zero initial
+// interior, every snapshot of a run is linear in the edge temperatures
+// (Dirichlet values and Robin ambients):
+//   T = F + sum over edges e of temp_e * B_e
+// B_e is the run with edge e at 1 and every other temperature and flux
+// at 0; F is the run with all temperatures at 0, needed only when a
+// Neumann flux is non-zero. A heat_basis holds those fields for every
+// snapshot of a run, so any set of edge temperatures costs one pass over
+// them instead of a simulation. Edges whose temperature is unused
+// (Neumann, periodic) need no field.
+#define HEAT_BASIS_MAX (HEAT_EDGE_COUNT + 1)
+#define HEAT_BASIS_FIXED -1         // source of F
+#define HEAT_HASH_INIT 14695981039346656037ULL
+
+typedef struct {
+    int rows, cols;
+    int snapshots;
+    int count;                      // fields per snapshot
+    int source[HEAT_BASIS_MAX];     // edge whose temperature scales each field, or HEAT_BASIS_FIXED
+    unsigned long long key;         // heat_hash of whatever else the run depends on
+    double *fields;                 // [snapshot][field][rows * cols], row-major
+} heat_basis;
+
+// FNV-1a over `size` bytes, continuing from `hash` (HEAT_HASH_INIT to start)
+unsigned long long heat_hash(unsigned long long hash, const void *data, size_t size);
+// 0, or -1 when out of memory
+int heat_basis_init(heat_basis *basis, int rows, int cols, int snapshots, int count, const int *source,
+                    unsigned long long key);
+void heat_basis_free(heat_basis *basis);
+double *heat_basis_field(const heat_basis *basis, int snapshot, int field);
+// 0, or -1 with a message on stderr
+int heat_basis_save(const heat_basis *basis, const char *path);
+// 0, or -1 (quietly) if the file is missing, unreadable or saved for another key
+int heat_basis_load(heat_basis *basis, const char *path, unsigned long long key);
+// One snapshot for edge temperatures temp[HEAT_EDGE_*] into T (rows * cols),
+// a vectorized scale-and-add of each field, blocked so T stays in cache
+void heat_basis_combine(const heat_basis *basis, int snapshot, const double temp[HEAT_EDGE_COUNT], double *T);
+
+// Out-of-core fields: a row-major field in a file mapped MAP_SHARED, so
+// the page cache holds whatever part of it fits and snapshots are written
+// straight from the mapping. heat_map_field creates (or truncates) the
+// file, zero-filled; 0, or -1 with a message on stderr.
+typedef struct {
+    double *T;
+    int rows, cols;
+    size_t bytes;
+    int fd;
+} heat_mapped_field;
+
+int heat_map_field(heat_mapped_field *field, const char *path, int rows, int cols);
+void heat_unmap_field(heat_mapped_field *field);
+// Write back rows [row_begin, row_end) and drop them from the resident set
+void heat_release_rows(heat_mapped_field *field, int row_begin, int row_end);
+
+// Advance a mapped field `steps` steps (with `bc` applied after each) in
+// one streaming pass: rows go through a window of 3 rows per step, the
+// result is written back over the field, and finished slabs of
+// `slab_rows` rows are released while the next slab is prefetched. The
+// field's ghost ring must be filled on entry; it is filled on return.
+// Bit-identical to `steps` calls of a backend step plus heat_fill_edge.
+// Returns max |dT| of the last step, or -1 if the window cannot be
+// allocated or steps > 1 with periodic top/bottom edges (those wrap onto
+// rows that are not available until the pass ends).
+double heat_stream_steps(heat_mapped_field *field, const heat_grid *grid, const heat_bc bc[HEAT_EDGE_COUNT],
+                         int steps, int slab_rows);
+
+// Checkpoints: a fixed header followed by nx*ny doubles in row-major
+// order. Both solvers write them (checkpoint/restart, the result memo and
+// the daemon's shared results), so either can resume the other's run, and
+// heat_pod reads them as snapshots.
+#define HEAT_CHECKPOINT_MAGIC "HEATCKPT"
+#define HEAT_CHECKPOINT_VERSION 1
+
+typedef struct {
+    char magic[8];
+    int32_t version;
+    int32_t step;
+    int32_t nx, ny;
+    int32_t steps, output_interval;
+    double alpha, dx, dy, dt;
+    double top_temp, bottom_temp, left_temp, right_temp;
+} heat_checkpoint_header;
+
+// Zero the header and set its magic and version; the caller fills the rest
+void heat_checkpoint_init(heat_checkpoint_header *header);
+// 1 if the magic and version match and the grid is at least 3x3
+int heat_checkpoint_valid(const heat_checkpoint_header *header);
+// Size of the complete checkpoint file the header describes
+size_t heat_checkpoint_bytes(const heat_checkpoint_header *header);
+// Header I/O at the current position of fp; 0, or -1 on a short
+// write/read or (load) a header that is not valid
+int heat_checkpoint_save_header(FILE *fp, const heat_checkpoint_header *header);
+int heat_checkpoint_load_header(FILE *fp, heat_checkpoint_header *header);
+
+// Energy metering: the package and DRAM RAPL counters under
+// /sys/class/powercap, sampled around a timed loop. The counters are
+// usually root-readable only; heat_energy_init then finds no domains and
+// heat_energy_stop reports zero.
+#define HEAT_ENERGY_MAX_DOMAINS 16
+#define HEAT_ENERGY_PATH_MAX 512
+
+typedef struct {
+    int count;
+    int is_dram[HEAT_ENERGY_MAX_DOMAINS];
+    char energy_path[HEAT_ENERGY_MAX_DOMAINS][HEAT_ENERGY_PATH_MAX];
+    unsigned long long max_range_uj[HEAT_ENERGY_MAX_DOMAINS];
+    unsigned long long start_uj[HEAT_ENERGY_MAX_DOMAINS];
+} heat_energy;
+
+// Discover readable domains; returns the number found
+int heat_energy_init(heat_energy *energy);
+void heat_energy_start(heat_energy *energy);
+// Joules since heat_energy_start, split into package and DRAM (one counter wrap tolerated)
+void heat_energy_stop(const heat_energy *energy, double *pkg_joules, double *dram_joules);
+
+#endif
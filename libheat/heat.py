@@ -0,0 +1,59 @@
+"""ctypes binding for libheat.so (build it with `make` in this folder).
+
+    import heat
+    new = heat.step(u, alpha=1.0, dx=1.0, dy=1.0, dt=0.15, backend="simd")
+
+Raises OSError at import time when libheat.so has not been built.
+"""
+import ctypes
+import os
+
+import numpy as np
+
+_LIB_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "libheat.so")
+_lib = ctypes.CDLL(_LIB_PATH)
+
+
+class Grid(ctypes.Structure):
+    _fields_ = [("rows", ctypes.c_int), ("cols", ctypes.c_int), ("stride", ctypes.c_int),
+                ("alpha", ctypes.c_double), ("dx", ctypes.c_double),
+                ("dy", ctypes.c_double), ("dt", ctypes.c_double)]
+
+
+class Region(ctypes.Structure):
+    _fields_ = [("row_begin", ctypes.c_int), ("row_end", ctypes.c_int),
+                ("col_begin", ctypes.c_int), ("col_end", ctypes.c_int)]
+
+
+_DOUBLE_P = ctypes.POINTER(ctypes.c_double)
+_STEP_FN = ctypes.CFUNCTYPE(ctypes.c_double, ctypes.POINTER(Grid), _DOUBLE_P, _DOUBLE_P, Region)
+
+
+class Backend(ctypes.Structure):
+    _fields_ = [("name", ctypes.c_char_p), ("description", ctypes.c_char_p), ("step", _STEP_FN)]
+
+
+_lib.heat_select_backend.restype = ctypes.POINTER(Backend)
+_lib.heat_select_backend.argtypes = [ctypes.c_char_p]
+_lib.heat_backend_count.restype = ctypes.c_int
+_lib.heat_backend_at.restype = ctypes.POINTER(Backend)
+_lib.heat_backend_at.argtypes = [ctypes.c_int]
+
+
+def backends():
+    """Names of the registered backends"""
+    return [_lib.heat_backend_at(b).contents.name.decode() for b in range(_lib.heat_backend_count())]
+
+
+def step(u, alpha=1.0, dx=1.0, dy=1.0, dt=0.1, backend=None):
+    """One explicit step of the interior of `u`; the outer ring is copied unchanged"""
+    chosen = _lib.heat_select_backend(backend.encode() if backend else None)
+    if not chosen:
+        raise ValueError(f"unknown libheat backend {backend!r}; available: {backends()}")
+    src = np.ascontiguousarray(u, dtype=np.float64)
+    new = src.copy()
+    rows, cols = src.shape
+    grid = Grid(rows, cols, cols, alpha, dx, dy, dt)
+    chosen.contents.step(ctypes.byref(grid), src.ctypes.data_as(_DOUBLE_P),
+                         new.ctypes.data_as(_DOUBLE_P), Region(1, rows - 1, 1, cols - 1))
+    return new
@@ -0,0 +1,15 @@
+#include "heat_backends.h"
+
+// Row by row, the loop every driver used to carry
+static double scalar_step(const heat_grid *grid, const double *T, double *T_new, heat_region region) {
+    double max_change = 0.0;
+    for (int i = region.row_begin; i < region.row_end; i++) {
+        double change = heat_update_span(grid, T, T_new, i, region.col_begin, region.col_end);
+        if (change > max_change) max_change = change;
+    }
+    return max_change;
+}
+
+const heat_backend heat_backend_scalar = {
+    "scalar", "reference row-by-row loop", scalar_step, NULL
+};
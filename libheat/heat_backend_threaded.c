@@ -0,0 +1,187 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "heat_backends.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Thread count: $HEAT_THREADS, else the online CPUs
+#define HEAT_THREADS_ENV "HEAT_THREADS"
+#define HEAT_MAX_THREADS 64
+
+// Regions with fewer rows per thread than this run on the caller alone
+#define HEAT_MIN_ROWS_PER_THREAD 8
+
+// Persistent workers, woken once per step through a generation counter.
+// The caller takes share 0. One step at a time per process.
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t start, done;
+    int nthreads;
+    unsigned long generation;
+    int pending;
+    const heat_grid *grid;
+    const double *T;
+    double *T_new;
+    double *field;              // in-place steps: T, overwritten share by share
+    double *rows;               // in-place steps: 4 rows per share (old edge rows above/below, line buffer)
+    size_t rows_size;
+    heat_region region;
+    double max_change[HEAT_MAX_THREADS];
+} pool;
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+static void share_rows(int id, int *begin, int *end) {
+    heat_region r = pool.region;
+    int rows = r.row_end - r.row_begin;
+    *begin = r.row_begin + (int)((long long)rows * id / pool.nthreads);
+    *end = r.row_begin + (int)((long long)rows * (id + 1) / pool.nthreads);
+}
+
+static double run_share(int id) {
+    heat_region r = pool.region;
+    int begin, end;
+    share_rows(id, &begin, &end);
+    if (pool.field != NULL) {
+        size_t cols = pool.grid->cols;
+        double *rows = pool.rows + 4 * cols * id;
+        return heat_inplace_rows(pool.grid, pool.field, begin, end, r.col_begin, r.col_end,
+                                 id > 0 ? rows : NULL, id < pool.nthreads - 1 ? rows + cols : NULL, rows + 2 * cols);
+    }
+    double max_change = 0.0;
+    for (int i = begin; i < end; i++) {
+        double change = heat_update_span(pool.grid, pool.T, pool.T_new, i, r.col_begin, r.col_end);
+        if (change > max_change) max_change = change;
+    }
+    return max_change;
+}
+
+static void *worker(void *arg) {
+    int id = (int)(intptr_t)arg;
+    unsigned long seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool.lock);
+        while (pool.generation == seen) {
+            pthread_cond_wait(&pool.start, &pool.lock);
+        }
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+
+        double change = run_share(id);
+
+        pthread_mutex_lock(&pool.lock);
+        pool.max_change[id] = change;
+        if (--pool.pending == 0) {
+            pthread_cond_signal(&pool.done);
+        }
+        pthread_mutex_unlock(&pool.lock);
+    }
+    return NULL;
+}
+
+static void pool_init(void) {
+    const char *env = getenv(HEAT_THREADS_ENV);
+    long n = env ? atol(env) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > HEAT_MAX_THREADS) n = HEAT_MAX_THREADS;
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.start, NULL);
+    pthread_cond_init(&pool.done, NULL);
+    pool.nthreads = 1;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for (long t = 1; t < n; t++) {
+        pthread_t thread;
+        if (pthread_create(&thread, &attr, worker, (void *)(intptr_t)t) != 0) break;
+        pool.nthreads++;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+// Wake the workers on pool.grid/region, take share 0, wait for the rest
+static double run_pool(void) {
+    pthread_mutex_lock(&pool.lock);
+    pool.pending = pool.nthreads - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    double max_change = run_share(0);
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.pending > 0) {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    for (int t = 1; t < pool.nthreads; t++) {
+        if (pool.max_change[t] > max_change) max_change = pool.max_change[t];
+    }
+    return max_change;
+}
+
+static double threaded_step(const heat_grid *grid, const double *T, double *T_new, heat_region region) {
+    pthread_once(&pool_once, pool_init);
+
+    int rows = region.row_end - region.row_begin;
+    if (pool.nthreads == 1 || rows < pool.nthreads * HEAT_MIN_ROWS_PER_THREAD) {
+        double max_change = 0.0;
+        for (int i = region.row_begin; i < region.row_end; i++) {
+            double change = heat_update_span(grid, T, T_new, i, region.col_begin, region.col_end);
+            if (change > max_change) max_change = change;
+        }
+        return max_change;
+    }
+
+    pool.grid = grid;
+    pool.T = T;
+    pool.T_new = T_new;
+    pool.field = NULL;
+    pool.region = region;
+    return run_pool();
+}
+
+// Each share sweeps its rows in place. The rows just outside a share are
+// overwritten by its neighbours, so their old values are saved first:
+// one row above and one below per share boundary.
+static double threaded_step_inplace(const heat_grid *grid, double *T, heat_region region) {
+    pthread_once(&pool_once, pool_init);
+
+    int rows = region.row_end - region.row_begin;
+    size_t cols = grid->cols;
+    size_t needed = 4 * cols * pool.nthreads;
+    if (pool.nthreads > 1 && rows >= pool.nthreads * HEAT_MIN_ROWS_PER_THREAD && needed > pool.rows_size) {
+        double *grown = (double *)realloc(pool.rows, needed * sizeof(double));
+        if (grown != NULL) {
+            pool.rows = grown;
+            pool.rows_size = needed;
+        }
+    }
+    if (pool.nthreads == 1 || rows < pool.nthreads * HEAT_MIN_ROWS_PER_THREAD || needed > pool.rows_size) {
+        return heat_step_inplace(NULL, grid, T, region);
+    }
+
+    pool.grid = grid;
+    pool.field = T;
+    pool.region = region;
+    for (int id = 0; id < pool.nthreads; id++) {
+        int begin, end;
+        share_rows(id, &begin, &end);
+        double *saved = pool.rows + 4 * cols * id;
+        if (id > 0) memcpy(saved, T + (size_t)(begin - 1) * grid->stride, cols * sizeof(double));
+        if (id < pool.nthreads - 1) memcpy(saved + cols, T + (size_t)end * grid->stride, cols * sizeof(double));
+    }
+    double max_change = run_pool();
+    pool.field = NULL;
+    return max_change;
+}
+
+const heat_backend heat_backend_threaded = {
+    "threaded", "persistent pthread pool over row blocks ($HEAT_THREADS)", threaded_step, threaded_step_inplace
+};
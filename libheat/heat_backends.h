@@ -0,0 +1,43 @@
+#ifndef HEAT_BACKENDS_H
+#define HEAT_BACKENDS_H
+
+#include "heat.h"
+
+// Built-in backends, registered by heat_registry.c
+extern const heat_backend heat_backend_scalar;
+extern const heat_backend heat_backend_simd;
+extern const heat_backend heat_backend_threaded;
+extern const heat_backend heat_backend_tiled;
+
+// Reference update of row i, columns [j0, j1); the other backends
+// reorganize the loops but keep this per-cell arithmetic, so every
+// backend produces bit-identical fields. Returns max |dT| over the span.
+static inline double heat_update_span(const heat_grid *grid, const double *T, double *T_new,
+                                      int i, int j0, int j1) {
+    int s = grid->stride;
+    double dx2 = grid->dx * grid->dx;
+    double dy2 = grid->dy * grid->dy;
+    double factor = grid->alpha * grid->dt;
+    const double *row = T + (size_t)i * s;
+    double *out = T_new + (size_t)i * s;
+    double max_change = 0.0;
+
+    for (int j = j0; j < j1; j++) {
+        double d2T_dx2 = (row[j + s] - 2.0 * row[j] + row[j - s]) / dx2;
+        double d2T_dy2 = (row[j + 1] - 2.0 * row[j] + row[j - 1]) / dy2;
+        double change = factor * (d2T_dx2 + d2T_dy2);
+        out[j] = row[j] + change;
+        if (change < 0.0) change = -change;
+        if (change > max_change) max_change = change;
+    }
+    return max_change;
+}
+
+// In-place sweep of rows [i0, i1), columns [j0, j1), with the rolling
+// two-row buffer `lines` (2 * grid->cols doubles). `above`/`below` are the
+// old rows i0-1 and i1 when another sweep may already have overwritten
+// them, else NULL to read them from T. Returns max |dT|.
+double heat_inplace_rows(const heat_grid *grid, double *T, int i0, int i1, int j0, int j1,
+                         const double *above, const double *below, double *lines);
+
+#endif
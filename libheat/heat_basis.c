@@ -0,0 +1,141 @@
+#include "heat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define HEAT_LANES 4
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define HEAT_LANES 2
+#else
+#define HEAT_LANES 1
+#endif
+
+#define BASIS_MAGIC "HEATBASE"
+#define BASIS_VERSION 1
+
+// Cells combined per block: the output block stays in L1 while every
+// field streams past it once
+#define BASIS_BLOCK 2048
+
+// On-disk header, followed by the fields in memory order
+typedef struct {
+    char magic[8];
+    int version;
+    int rows, cols, snapshots, count;
+    int source[HEAT_BASIS_MAX];
+    unsigned long long key;
+} basis_header;
+
+unsigned long long heat_hash(unsigned long long hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t k = 0; k < size; k++) {
+        hash ^= bytes[k];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+int heat_basis_init(heat_basis *basis, int rows, int cols, int snapshots, int count, const int *source,
+                    unsigned long long key) {
+    memset(basis, 0, sizeof(*basis));
+    if (count < 1 || count > HEAT_BASIS_MAX) return -1;
+    basis->rows = rows;
+    basis->cols = cols;
+    basis->snapshots = snapshots;
+    basis->count = count;
+    memcpy(basis->source, source, count * sizeof(int));
+    basis->key = key;
+    basis->fields = (double *)malloc((size_t)snapshots * count * rows * cols * sizeof(double));
+    return basis->fields ? 0 : -1;
+}
+
+void heat_basis_free(heat_basis *basis) {
+    free(basis->fields);
+    memset(basis, 0, sizeof(*basis));
+}
+
+double *heat_basis_field(const heat_basis *basis, int snapshot, int field) {
+    size_t cells = (size_t)basis->rows * basis->cols;
+    return basis->fields + ((size_t)snapshot * basis->count + field) * cells;
+}
+
+int heat_basis_save(const heat_basis *basis, const char *path) {
+    basis_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BASIS_MAGIC, 8);
+    header.version = BASIS_VERSION;
+    header.rows = basis->rows;
+    header.cols = basis->cols;
+    header.snapshots = basis->snapshots;
+    header.count = basis->count;
+    memcpy(header.source, basis->source, sizeof(header.source));
+    header.key = basis->key;
+
+    size_t values = (size_t)basis->snapshots * basis->count * basis->rows * basis->cols;
+    FILE *fp = fopen(path, "wb");
+    if (!fp || fwrite(&header, sizeof(header), 1, fp) != 1 ||
+        fwrite(basis->fields, sizeof(double), values, fp) != values) {
+        fprintf(stderr, "ERROR: Unable to write basis cache %s\n", path);
+        if (fp) fclose(fp);
+        return -1;
+    }
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+int heat_basis_load(heat_basis *basis, const char *path, unsigned long long key) {
+    memset(basis, 0, sizeof(*basis));
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+    basis_header header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 || memcmp(header.magic, BASIS_MAGIC, 8) != 0 ||
+        header.version != BASIS_VERSION || header.key != key || header.rows < 1 || header.cols < 1 ||
+        header.snapshots < 1 || heat_basis_init(basis, header.rows, header.cols, header.snapshots, header.count,
+                                                header.source, header.key) != 0) {
+        fclose(fp);
+        return -1;
+    }
+    size_t values = (size_t)basis->snapshots * basis->count * basis->rows * basis->cols;
+    int status = fread(basis->fields, sizeof(double), values, fp) == values ? 0 : -1;
+    fclose(fp);
+    if (status != 0) heat_basis_free(basis);
+    return status;
+}
+
+// out = a * x (add == 0) or out += a * x
+static void axpy(double *out, const double *x, double a, int n, int add) {
+    int k = 0;
+#if HEAT_LANES == 4
+    __m256d va = _mm256_set1_pd(a);
+    for (; k + 4 <= n; k += 4) {
+        __m256d term = _mm256_mul_pd(va, _mm256_loadu_pd(x + k));
+        _mm256_storeu_pd(out + k, add ? _mm256_add_pd(_mm256_loadu_pd(out + k), term) : term);
+    }
+#elif HEAT_LANES == 2
+    __m128d va = _mm_set1_pd(a);
+    for (; k + 2 <= n; k += 2) {
+        __m128d term = _mm_mul_pd(va, _mm_loadu_pd(x + k));
+        _mm_storeu_pd(out + k, add ? _mm_add_pd(_mm_loadu_pd(out + k), term) : term);
+    }
+#endif
+    for (; k < n; k++) {
+        out[k] = add ? out[k] + a * x[k] : a * x[k];
+    }
+}
+
+void heat_basis_combine(const heat_basis *basis, int snapshot, const double temp[HEAT_EDGE_COUNT], double *T) {
+    size_t cells = (size_t)basis->rows * basis->cols;
+    double weight[HEAT_BASIS_MAX];
+    for (int f = 0; f < basis->count; f++) {
+        weight[f] = basis->source[f] == HEAT_BASIS_FIXED ? 1.0 : temp[basis->source[f]];
+    }
+    const double *first = heat_basis_field(basis, snapshot, 0);
+    for (size_t start = 0; start < cells; start += BASIS_BLOCK) {
+        int n = cells - start < BASIS_BLOCK ? (int)(cells - start) : BASIS_BLOCK;
+        for (int f = 0; f < basis->count; f++) {
+            axpy(T + start, first + f * cells + start, weight[f], n, f > 0);
+        }
+    }
+}
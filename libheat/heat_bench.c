@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "heat.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Runs every registered backend on the same problem and checks it
+// against the scalar reference: max |difference| and Mcell-updates/s.
+// The runtime-compiled "jit" backend is included when it can be built.
+// Each backend also runs in place (one field, line-buffered rows).
+// Usage: heat_bench [rows cols steps]
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Hot top/bottom, cold sides, zero interior (the drivers' setup)
+static void initialize(const heat_grid *grid, double *T) {
+    for (int i = 0; i < grid->rows; i++) {
+        for (int j = 0; j < grid->cols; j++) {
+            double value = 0.0;
+            if (i == 0 || i == grid->rows - 1) value = 100.0;
+            if (j == 0 || j == grid->cols - 1) value = 0.0;
+            T[(size_t)i * grid->stride + j] = value;
+        }
+    }
+}
+
+static double *run(const heat_backend *backend, const heat_grid *grid, int steps, int inplace, double *seconds) {
+    size_t cells = (size_t)grid->rows * grid->stride;
+    double *T = (double *)malloc(cells * sizeof(double));
+    double *T_new = inplace ? NULL : (double *)malloc(cells * sizeof(double));
+    if (!T || (!inplace && !T_new)) {
+        fprintf(stderr, "ERROR: allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    initialize(grid, T);
+    if (T_new) memcpy(T_new, T, cells * sizeof(double));
+
+    heat_region interior = heat_interior(grid);
+    double start = now();
+    for (int step = 0; step < steps; step++) {
+        if (inplace) {
+            heat_step_inplace(backend, grid, T, interior);
+            continue;
+        }
+        backend->step(grid, T, T_new, interior);
+        double *tmp = T;
+        T = T_new;
+        T_new = tmp;
+    }
+    *seconds = now() - start;
+    free(T_new);
+    return T;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 1024;
+    int cols = argc > 2 ? atoi(argv[2]) : 1024;
+    int steps = argc > 3 ? atoi(argv[3]) : 100;
+    if (rows < 3 || cols < 3 || steps < 1) {
+        fprintf(stderr, "Usage: %s [rows cols steps]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    double h = 1.0 / (cols - 1);
+    heat_grid grid = {rows, cols, cols, 0.1, h, h, 0.2 * h * h / 0.1};
+
+    // The JIT backend joins the comparison when a compiler is available
+    if (heat_jit_backend(&grid) == NULL) {
+        printf("(jit backend unavailable, skipped)\n");
+    }
+
+    printf("libheat %d backends, %dx%d grid, %d steps\n", heat_backend_count(), rows, cols, steps);
+    printf("%-16s %10s %14s %12s\n", "backend", "time (s)", "Mcell-upd/s", "max |diff|");
+
+    double seconds;
+    double *reference = run(heat_get_backend("scalar"), &grid, steps, 0, &seconds);
+    double mcells = (double)(rows - 2) * (cols - 2) * steps * 1e-6;
+    int mismatches = 0;
+
+    for (int b = 0; b < heat_backend_count(); b++) {
+        const heat_backend *backend = heat_backend_at(b);
+        for (int inplace = 0; inplace < 2; inplace++) {
+            double *T = run(backend, &grid, steps, inplace, &seconds);
+            double max_diff = 0.0;
+            for (size_t c = 0; c < (size_t)rows * cols; c++) {
+                max_diff = fmax(max_diff, fabs(T[c] - reference[c]));
+            }
+            if (max_diff != 0.0) mismatches++;
+            char label[32];
+            snprintf(label, sizeof(label), "%s%s", backend->name, inplace ? "/inplace" : "");
+            printf("%-16s %10.4f %14.1f %12.3e\n", label, seconds, mcells / seconds, max_diff);
+            free(T);
+        }
+    }
+    free(reference);
+
+    if (mismatches) {
+        printf("%d backend(s) differ from the scalar reference\n", mismatches);
+        return EXIT_FAILURE;
+    }
+    printf("All backends match the scalar reference\n");
+    return 0;
+}
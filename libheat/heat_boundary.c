@@ -0,0 +1,142 @@
+#include "heat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char *bc_names[HEAT_BC_COUNT] = {"dirichlet", "neumann", "robin", "periodic"};
+static const char *edge_names[HEAT_EDGE_COUNT] = {"top", "bottom", "left", "right"};
+
+typedef void (*fill_fn)(double *ghost, const double *inner, const double *wrap,
+                        int count, int step, double a, double c);
+
+// One instantiation per condition and orientation: rows are unit-stride,
+// columns step by the grid stride. The loops carry no type checks;
+// heat_fill_edge picks the instantiation once per edge.
+#define HEAT_DEFINE_FILL(NAME, EXPR)                                                   \
+    static void fill_##NAME##_row(double *ghost, const double *inner, const double *wrap, \
+                                  int count, int step, double a, double c) {         \
+        (void)inner; (void)wrap; (void)step; (void)a; (void)c;                        \
+        for (size_t k = 0; k < (size_t)count; k++) {                                  \
+            ghost[k] = (EXPR);                                                        \
+        }                                                                             \
+    }                                                                                 \
+    static void fill_##NAME##_col(double *ghost, const double *inner, const double *wrap, \
+                                  int count, int step, double a, double c) {         \
+        (void)inner; (void)wrap; (void)a; (void)c;                                    \
+        for (int n = 0; n < count; n++) {                                             \
+            size_t k = (size_t)n * step;                                              \
+            ghost[k] = (EXPR);                                                        \
+        }                                                                             \
+    }
+
+HEAT_DEFINE_FILL(dirichlet, c)
+HEAT_DEFINE_FILL(neumann, inner[k] + c)
+HEAT_DEFINE_FILL(robin, a * inner[k] + c)
+HEAT_DEFINE_FILL(periodic, wrap[k])
+
+static const fill_fn row_fills[HEAT_BC_COUNT] = {
+    fill_dirichlet_row, fill_neumann_row, fill_robin_row, fill_periodic_row
+};
+static const fill_fn col_fills[HEAT_BC_COUNT] = {
+    fill_dirichlet_col, fill_neumann_col, fill_robin_col, fill_periodic_col
+};
+
+const char *heat_bc_name(heat_bc_type type) {
+    return (type >= 0 && type < HEAT_BC_COUNT) ? bc_names[type] : "unknown";
+}
+
+const char *heat_edge_name(heat_edge edge) {
+    return (edge >= 0 && edge < HEAT_EDGE_COUNT) ? edge_names[edge] : "unknown";
+}
+
+int heat_parse_bc(const char *spec, heat_edge *edge, heat_bc_type *type, double *param) {
+    const char *eq = strchr(spec, '=');
+    if (eq == NULL) return -1;
+
+    int e = -1;
+    for (int n = 0; n < HEAT_EDGE_COUNT; n++) {
+        if (strlen(edge_names[n]) == (size_t)(eq - spec) && strncmp(spec, edge_names[n], eq - spec) == 0) e = n;
+    }
+    const char *name = eq + 1;
+    const char *colon = strchr(name, ':');
+    size_t len = colon ? (size_t)(colon - name) : strlen(name);
+    int t = -1;
+    for (int n = 0; n < HEAT_BC_COUNT; n++) {
+        if (strlen(bc_names[n]) == len && strncmp(name, bc_names[n], len) == 0) t = n;
+    }
+    if (e < 0 || t < 0) return -1;
+
+    double value = 0.0;
+    if (colon) {
+        char *end;
+        value = strtod(colon + 1, &end);
+        if (end == colon + 1 || *end != '\0') return -1;
+    }
+    *edge = (heat_edge)e;
+    *type = (heat_bc_type)t;
+    *param = value;
+    return 0;
+}
+
+void heat_fill_edge(const heat_grid *grid, double *T, heat_edge edge, const heat_bc *bc, int begin, int end) {
+    if (end <= begin) return;
+    size_t s = (size_t)grid->stride;
+    int last_row = grid->rows - 1, last_col = grid->cols - 1;
+    double *ghost;
+    const double *inner, *wrap;
+    double h;
+
+    switch (edge) {
+        case HEAT_EDGE_TOP:
+            ghost = T + begin;
+            inner = T + s + begin;
+            wrap = T + (last_row - 1) * s + begin;
+            h = grid->dx;
+            break;
+        case HEAT_EDGE_BOTTOM:
+            ghost = T + last_row * s + begin;
+            inner = T + (last_row - 1) * s + begin;
+            wrap = T + s + begin;
+            h = grid->dx;
+            break;
+        case HEAT_EDGE_LEFT:
+            ghost = T + begin * s;
+            inner = T + begin * s + 1;
+            wrap = T + begin * s + last_col - 1;
+            h = grid->dy;
+            break;
+        default:
+            ghost = T + begin * s + last_col;
+            inner = T + begin * s + last_col - 1;
+            wrap = T + begin * s + 1;
+            h = grid->dy;
+            break;
+    }
+
+    // ghost = a * inner + c for the three local conditions
+    double a = 0.0, c = 0.0;
+    switch (bc->type) {
+        case HEAT_BC_DIRICHLET:
+            c = bc->value;
+            break;
+        case HEAT_BC_NEUMANN:
+            a = 1.0;
+            c = bc->value * h;
+            break;
+        case HEAT_BC_ROBIN: {
+            // -dT/dn = coeff * (T_face - ambient), T_face = (ghost + inner) / 2
+            double half = 0.5 * bc->coeff * h;
+            a = (1.0 - half) / (1.0 + half);
+            c = bc->coeff * h * bc->value / (1.0 + half);
+            break;
+        }
+        default:
+            break;
+    }
+
+    if (edge == HEAT_EDGE_TOP || edge == HEAT_EDGE_BOTTOM) {
+        row_fills[bc->type](ghost, inner, wrap, end - begin, 1, a, c);
+    } else {
+        col_fills[bc->type](ghost, inner, wrap, end - begin, grid->stride, a, c);
+    }
+}
@@ -0,0 +1,29 @@
+#include "heat.h"
+
+#include <string.h>
+
+void heat_checkpoint_init(heat_checkpoint_header *header) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, HEAT_CHECKPOINT_MAGIC, sizeof(header->magic));
+    header->version = HEAT_CHECKPOINT_VERSION;
+}
+
+int heat_checkpoint_valid(const heat_checkpoint_header *header) {
+    return memcmp(header->magic, HEAT_CHECKPOINT_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == HEAT_CHECKPOINT_VERSION && header->nx >= 3 && header->ny >= 3;
+}
+
+size_t heat_checkpoint_bytes(const heat_checkpoint_header *header) {
+    return sizeof(*header) + (size_t)header->nx * header->ny * sizeof(double);
+}
+
+int heat_checkpoint_save_header(FILE *fp, const heat_checkpoint_header *header) {
+    return fwrite(header, sizeof(*header), 1, fp) == 1 ? 0 : -1;
+}
+
+int heat_checkpoint_load_header(FILE *fp, heat_checkpoint_header *header) {
+    if (fread(header, sizeof(*header), 1, fp) != 1) {
+        return -1;
+    }
+    return heat_checkpoint_valid(header) ? 0 : -1;
+}
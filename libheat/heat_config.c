@@ -0,0 +1,252 @@
+#include "heat.h"
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Largest config file accepted (config.json is well under 1 KB)
+#define HEAT_CONFIG_FILE_MAX (64 * 1024)
+
+// Recursive-descent reader for the JSON subset config files use: objects,
+// strings, numbers, true/false/null. Arrays are skipped. Leaves become
+// "outer.inner" entries.
+typedef struct {
+    const char *text;
+    size_t pos;
+    int line;
+    heat_config *cfg;
+} json_reader;
+
+static int fail(heat_config *cfg, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(cfg->error, sizeof(cfg->error), fmt, args);
+    va_end(args);
+    return -1;
+}
+
+static void skip_space(json_reader *r) {
+    while (isspace((unsigned char)r->text[r->pos])) {
+        if (r->text[r->pos] == '\n') r->line++;
+        r->pos++;
+    }
+}
+
+static int store(heat_config *cfg, const char *key, const char *value) {
+    if (strlen(key) >= HEAT_CONFIG_KEY_MAX || strlen(value) >= HEAT_CONFIG_VALUE_MAX) {
+        return fail(cfg, "entry %s is too long", key);
+    }
+    heat_config_entry *entry = NULL;
+    for (int e = 0; e < cfg->count; e++) {
+        if (strcmp(cfg->entries[e].key, key) == 0) entry = &cfg->entries[e];
+    }
+    if (entry == NULL) {
+        if (cfg->count == HEAT_CONFIG_MAX_ENTRIES) return fail(cfg, "more than %d entries", HEAT_CONFIG_MAX_ENTRIES);
+        entry = &cfg->entries[cfg->count++];
+        strcpy(entry->key, key);
+    }
+    strcpy(entry->value, value);
+    entry->used = 0;
+    return 0;
+}
+
+// String body after the opening quote; simple escapes only
+static int read_string(json_reader *r, char *out, size_t size) {
+    size_t n = 0;
+    for (;;) {
+        char c = r->text[r->pos++];
+        if (c == '\0' || c == '\n') return fail(r->cfg, "line %d: unterminated string", r->line);
+        if (c == '"') break;
+        if (c == '\\') {
+            c = r->text[r->pos++];
+            if (c == 'n') c = '\n';
+            else if (c == 't') c = '\t';
+            else if (c != '"' && c != '\\' && c != '/') return fail(r->cfg, "line %d: unsupported escape", r->line);
+        }
+        if (n + 1 >= size) return fail(r->cfg, "line %d: string too long", r->line);
+        out[n++] = c;
+    }
+    out[n] = '\0';
+    return 0;
+}
+
+static int read_value(json_reader *r, const char *key, int depth);
+
+static int read_object(json_reader *r, const char *prefix, int depth) {
+    r->pos++;   // '{'
+    skip_space(r);
+    if (r->text[r->pos] == '}') {
+        r->pos++;
+        return 0;
+    }
+    for (;;) {
+        skip_space(r);
+        if (r->text[r->pos] != '"') return fail(r->cfg, "line %d: expected a key", r->line);
+        r->pos++;
+        char name[HEAT_CONFIG_KEY_MAX];
+        if (read_string(r, name, sizeof(name)) != 0) return -1;
+        char key[2 * HEAT_CONFIG_KEY_MAX];
+        snprintf(key, sizeof(key), "%s%s%s", prefix, prefix[0] ? "." : "", name);
+
+        skip_space(r);
+        if (r->text[r->pos] != ':') return fail(r->cfg, "line %d: expected ':' after \"%s\"", r->line, name);
+        r->pos++;
+        if (read_value(r, key, depth + 1) != 0) return -1;
+
+        skip_space(r);
+        char c = r->text[r->pos++];
+        if (c == '}') return 0;
+        if (c != ',') return fail(r->cfg, "line %d: expected ',' or '}'", r->line);
+    }
+}
+
+static int skip_array(json_reader *r, int depth) {
+    r->pos++;   // '['
+    skip_space(r);
+    if (r->text[r->pos] == ']') {
+        r->pos++;
+        return 0;
+    }
+    for (;;) {
+        if (read_value(r, NULL, depth + 1) != 0) return -1;
+        skip_space(r);
+        char c = r->text[r->pos++];
+        if (c == ']') return 0;
+        if (c != ',') return fail(r->cfg, "line %d: expected ',' or ']'", r->line);
+    }
+}
+
+// Stores leaves under `key`; NULL discards them (array elements)
+static int read_value(json_reader *r, const char *key, int depth) {
+    if (depth > 16) return fail(r->cfg, "line %d: nested too deeply", r->line);
+    skip_space(r);
+    char c = r->text[r->pos];
+    char value[HEAT_CONFIG_VALUE_MAX];
+
+    if (c == '{') {
+        if (key == NULL) return fail(r->cfg, "line %d: objects inside arrays are not supported", r->line);
+        return read_object(r, key, depth);
+    }
+    if (c == '[') return skip_array(r, depth);
+    if (c == '"') {
+        r->pos++;
+        if (read_string(r, value, sizeof(value)) != 0) return -1;
+    } else {
+        size_t n = 0;
+        while (r->text[r->pos] && strchr(",}] \t\r\n", r->text[r->pos]) == NULL) {
+            if (n + 1 >= sizeof(value)) return fail(r->cfg, "line %d: value too long", r->line);
+            value[n++] = r->text[r->pos++];
+        }
+        value[n] = '\0';
+        char *end;
+        strtod(value, &end);
+        if (n == 0 || (*end != '\0' && strcmp(value, "true") != 0 && strcmp(value, "false") != 0 &&
+                       strcmp(value, "null") != 0)) {
+            return fail(r->cfg, "line %d: bad value '%s'", r->line, value);
+        }
+    }
+    return key ? store(r->cfg, key, value) : 0;
+}
+
+int heat_config_parse(heat_config *cfg, const char *text, const char *name) {
+    json_reader r = {text, 0, 1, cfg};
+    skip_space(&r);
+    int status = text[r.pos] == '{' ? read_object(&r, "", 0) : fail(cfg, "expected a JSON object");
+    if (status == 0) {
+        skip_space(&r);
+        if (text[r.pos] != '\0') status = fail(cfg, "line %d: trailing characters", r.line);
+    }
+    if (status != 0) {
+        char reason[sizeof(cfg->error)];
+        strcpy(reason, cfg->error);
+        snprintf(cfg->error, sizeof(cfg->error), "%s: %.200s", name, reason);
+    }
+    return status;
+}
+
+int heat_config_load(heat_config *cfg, const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return fail(cfg, "cannot open %s", path);
+    char *text = (char *)malloc(HEAT_CONFIG_FILE_MAX + 1);
+    if (!text) {
+        fclose(fp);
+        return fail(cfg, "out of memory");
+    }
+    size_t length = fread(text, 1, HEAT_CONFIG_FILE_MAX + 1, fp);
+    fclose(fp);
+    if (length > HEAT_CONFIG_FILE_MAX) {
+        free(text);
+        return fail(cfg, "%s is larger than %d bytes", path, HEAT_CONFIG_FILE_MAX);
+    }
+    text[length] = '\0';
+
+    int status = heat_config_parse(cfg, text, path);
+    free(text);
+    return status;
+}
+
+int heat_config_set(heat_config *cfg, const char *assignment) {
+    const char *eq = strchr(assignment, '=');
+    if (eq == NULL || eq == assignment || (size_t)(eq - assignment) >= HEAT_CONFIG_KEY_MAX) {
+        return fail(cfg, "expected KEY=VALUE, got '%s'", assignment);
+    }
+    char key[HEAT_CONFIG_KEY_MAX];
+    memcpy(key, assignment, eq - assignment);
+    key[eq - assignment] = '\0';
+    return store(cfg, key, eq + 1);
+}
+
+const char *heat_config_get(heat_config *cfg, const char *key) {
+    for (int e = 0; e < cfg->count; e++) {
+        if (strcmp(cfg->entries[e].key, key) == 0) {
+            cfg->entries[e].used = 1;
+            return cfg->entries[e].value;
+        }
+    }
+    return NULL;
+}
+
+int heat_config_int(heat_config *cfg, const char *key, int *out) {
+    const char *text = heat_config_get(cfg, key);
+    if (text == NULL) return 0;
+    char *end;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0') return -1;
+    *out = (int)value;
+    return 1;
+}
+
+int heat_config_double(heat_config *cfg, const char *key, double *out) {
+    const char *text = heat_config_get(cfg, key);
+    if (text == NULL) return 0;
+    char *end;
+    double value = strtod(text, &end);
+    if (end == text || *end != '\0') return -1;
+    *out = value;
+    return 1;
+}
+
+int heat_config_bool(heat_config *cfg, const char *key, int *out) {
+    const char *text = heat_config_get(cfg, key);
+    if (text == NULL) return 0;
+    if (strcmp(text, "true") == 0 || strcmp(text, "1") == 0) {
+        *out = 1;
+    } else if (strcmp(text, "false") == 0 || strcmp(text, "0") == 0) {
+        *out = 0;
+    } else {
+        return -1;
+    }
+    return 1;
+}
+
+int heat_config_warn_unused(const heat_config *cfg, const char *prefix, FILE *fp) {
+    int unused = 0;
+    for (int e = 0; e < cfg->count; e++) {
+        if (!cfg->entries[e].used && strncmp(cfg->entries[e].key, prefix, strlen(prefix)) == 0) {
+            fprintf(fp, "WARNING: Unknown config key %s ignored\n", cfg->entries[e].key);
+            unused++;
+        }
+    }
+    return unused;
+}
@@ -0,0 +1,96 @@
+#define _DEFAULT_SOURCE
+
+#include "heat.h"
+
+#include <dirent.h>
+#include <string.h>
+
+// Linux powercap RAPL energy counters
+#define HEAT_RAPL_ROOT "/sys/class/powercap"
+
+static int read_counter_file(const char *path, unsigned long long *value) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return 0;
+    }
+    int ok = fscanf(fp, "%llu", value) == 1;
+    fclose(fp);
+    return ok;
+}
+
+int heat_energy_init(heat_energy *energy) {
+    energy->count = 0;
+    DIR *dir = opendir(HEAT_RAPL_ROOT);
+    if (dir == NULL) {
+        return 0;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && energy->count < HEAT_ENERGY_MAX_DOMAINS) {
+        // Zones are intel-rapl:<pkg> and subzones intel-rapl:<pkg>:<n>
+        if (strncmp(entry->d_name, "intel-rapl:", 11) != 0) {
+            continue;
+        }
+
+        char path[HEAT_ENERGY_PATH_MAX];
+        char name[64];
+        snprintf(path, sizeof(path), HEAT_RAPL_ROOT "/%s/name", entry->d_name);
+        FILE *fp = fopen(path, "r");
+        if (fp == NULL) {
+            continue;
+        }
+        int named = fscanf(fp, "%63s", name) == 1;
+        fclose(fp);
+        if (!named) {
+            continue;
+        }
+
+        int is_package = strncmp(name, "package", 7) == 0;
+        int is_dram = strcmp(name, "dram") == 0;
+        if (!is_package && !is_dram) {
+            continue;
+        }
+
+        // energy_uj is root-only on recent kernels, so probe it now
+        int n = energy->count;
+        unsigned long long probe;
+        snprintf(energy->energy_path[n], sizeof(energy->energy_path[n]), HEAT_RAPL_ROOT "/%s/energy_uj",
+                 entry->d_name);
+        snprintf(path, sizeof(path), HEAT_RAPL_ROOT "/%s/max_energy_range_uj", entry->d_name);
+        if (!read_counter_file(path, &energy->max_range_uj[n]) ||
+            !read_counter_file(energy->energy_path[n], &probe)) {
+            continue;
+        }
+        energy->is_dram[n] = is_dram;
+        energy->count++;
+    }
+    closedir(dir);
+    return energy->count;
+}
+
+void heat_energy_start(heat_energy *energy) {
+    for (int n = 0; n < energy->count; n++) {
+        if (!read_counter_file(energy->energy_path[n], &energy->start_uj[n])) {
+            energy->start_uj[n] = 0;
+        }
+    }
+}
+
+void heat_energy_stop(const heat_energy *energy, double *pkg_joules, double *dram_joules) {
+    *pkg_joules = 0.0;
+    *dram_joules = 0.0;
+    for (int n = 0; n < energy->count; n++) {
+        unsigned long long now;
+        if (!read_counter_file(energy->energy_path[n], &now)) {
+            continue;
+        }
+        unsigned long long delta = now >= energy->start_uj[n]
+            ? now - energy->start_uj[n]
+            : energy->max_range_uj[n] - energy->start_uj[n] + now;
+        if (energy->is_dram[n]) {
+            *dram_joules += delta * 1e-6;
+        } else {
+            *pkg_joules += delta * 1e-6;
+        }
+    }
+}
@@ -0,0 +1,202 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "heat_backends.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// -ffp-contract=off keeps a*b+c as two roundings, so the generated kernel
+// stays bit-identical to heat_update_span on FMA hardware. The finite-math
+// flags only let GCC vectorize the max |dT| reduction (fields are finite).
+#define HEAT_JIT_DEFAULT_CC "cc"
+#define HEAT_JIT_CFLAGS "-O3 -march=native -ffp-contract=off -fno-trapping-math -ffinite-math-only -fno-signed-zeros -fPIC -shared"
+#define HEAT_JIT_SYMBOL "heat_jit_step"
+#define HEAT_JIT_PATH_MAX 1024
+
+typedef double (*jit_kernel_fn)(const double *T, double *T_new, int row_begin, int row_end,
+                                int col_begin, int col_end);
+
+// The kernel currently loaded and the grid it was generated for
+static struct {
+    jit_kernel_fn kernel;
+    void *handle;
+    int rows, cols, stride;
+    double dx2, dy2, factor;
+} jit;
+
+static double jit_step(const heat_grid *grid, const double *T, double *T_new, heat_region region) {
+    if (jit.kernel == NULL || grid->stride != jit.stride || grid->cols != jit.cols ||
+        grid->dx * grid->dx != jit.dx2 || grid->dy * grid->dy != jit.dy2 ||
+        grid->alpha * grid->dt != jit.factor) {
+        return heat_backend_scalar.step(grid, T, T_new, region);
+    }
+    return jit.kernel(T, T_new, region.row_begin, region.row_end, region.col_begin, region.col_end);
+}
+
+static const heat_backend heat_backend_jit = {
+    "jit", "kernel compiled at runtime for the grid size and coefficients", jit_step, NULL
+};
+
+// Same per-cell arithmetic as heat_update_span. Coefficients are printed
+// as hex floats so the literals are exact. The full interior and the
+// full-width row loop get compile-time trip counts.
+static char *generate_source(const heat_grid *grid, double dx2, double dy2, double factor) {
+    static const char *body =
+        "static inline double span(const double *restrict row, double *restrict out, int j0, int j1) {\n"
+        "    double max_change = 0.0;\n"
+        "    for (int j = j0; j < j1; j++) {\n"
+        "        double d2T_dx2 = (row[j + S] - 2.0 * row[j] + row[j - S]) / DX2;\n"
+        "        double d2T_dy2 = (row[j + 1] - 2.0 * row[j] + row[j - 1]) / DY2;\n"
+        "        double change = FACTOR * (d2T_dx2 + d2T_dy2);\n"
+        "        out[j] = row[j] + change;\n"
+        "        if (change < 0.0) change = -change;\n"
+        "        if (change > max_change) max_change = change;\n"
+        "    }\n"
+        "    return max_change;\n"
+        "}\n\n"
+        "double " HEAT_JIT_SYMBOL "(const double *T, double *T_new, int row_begin, int row_end,\n"
+        "                     int col_begin, int col_end) {\n"
+        "    double max_change = 0.0, change;\n"
+        "    if (row_begin == 1 && row_end == ROWS - 1 && col_begin == 1 && col_end == COLS - 1) {\n"
+        "        for (int i = 1; i < ROWS - 1; i++) {\n"
+        "            change = span(T + (long)i * S, T_new + (long)i * S, 1, COLS - 1);\n"
+        "            if (change > max_change) max_change = change;\n"
+        "        }\n"
+        "    } else if (col_begin == 1 && col_end == COLS - 1) {\n"
+        "        for (int i = row_begin; i < row_end; i++) {\n"
+        "            change = span(T + (long)i * S, T_new + (long)i * S, 1, COLS - 1);\n"
+        "            if (change > max_change) max_change = change;\n"
+        "        }\n"
+        "    } else {\n"
+        "        for (int i = row_begin; i < row_end; i++) {\n"
+        "            change = span(T + (long)i * S, T_new + (long)i * S, col_begin, col_end);\n"
+        "            if (change > max_change) max_change = change;\n"
+        "        }\n"
+        "    }\n"
+        "    return max_change;\n"
+        "}\n";
+
+    size_t size = strlen(body) + 512;
+    char *source = (char *)malloc(size);
+    if (source == NULL) return NULL;
+    snprintf(source, size,
+             "// Generated by libheat for a %dx%d grid (stride %d)\n"
+             "#define ROWS %d\n#define COLS %d\n#define S %d\n"
+             "#define DX2 %a\n#define DY2 %a\n#define FACTOR %a\n\n%s",
+             grid->rows, grid->cols, grid->stride, grid->rows, grid->cols, grid->stride,
+             dx2, dy2, factor, body);
+    return source;
+}
+
+// FNV-1a over the source and the compile command
+static uint64_t hash_text(uint64_t hash, const char *text) {
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static int cache_dir(char *dir, size_t size) {
+    const char *env = getenv(HEAT_JIT_CACHE_ENV);
+    if (env && env[0]) {
+        snprintf(dir, size, "%s", env);
+    } else {
+        const char *tmp = getenv("TMPDIR");
+        snprintf(dir, size, "%s/libheat-jit-%ld", tmp && tmp[0] ? tmp : "/tmp", (long)getuid());
+    }
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+        fprintf(stderr, "libheat: cannot create JIT cache %s: %s\n", dir, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+// Build `library` from `source` unless it is already cached. Concurrent
+// callers (MPI ranks) compile to private names and rename into place.
+static int compile_kernel(const char *source, const char *cc, const char *library) {
+    if (access(library, R_OK) == 0) return 0;
+
+    char src_path[HEAT_JIT_PATH_MAX + 32], tmp_path[HEAT_JIT_PATH_MAX + 32];
+    snprintf(src_path, sizeof(src_path), "%s.%ld.c", library, (long)getpid());
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", library, (long)getpid());
+    FILE *fp = fopen(src_path, "w");
+    if (!fp) {
+        fprintf(stderr, "libheat: cannot write %s: %s\n", src_path, strerror(errno));
+        return -1;
+    }
+    fputs(source, fp);
+    fclose(fp);
+
+    char command[3 * HEAT_JIT_PATH_MAX + 256];
+    snprintf(command, sizeof(command), "%s " HEAT_JIT_CFLAGS " -o '%s' '%s'", cc, tmp_path, src_path);
+    int status = system(command);
+    remove(src_path);
+    if (status != 0) {
+        fprintf(stderr, "libheat: JIT compile failed (%s)\n", command);
+        remove(tmp_path);
+        return -1;
+    }
+    if (rename(tmp_path, library) != 0) {
+        fprintf(stderr, "libheat: cannot install %s: %s\n", library, strerror(errno));
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+const heat_backend *heat_jit_backend(const heat_grid *grid) {
+    double dx2 = grid->dx * grid->dx;
+    double dy2 = grid->dy * grid->dy;
+    double factor = grid->alpha * grid->dt;
+    if (jit.kernel && jit.rows == grid->rows && jit.cols == grid->cols && jit.stride == grid->stride &&
+        jit.dx2 == dx2 && jit.dy2 == dy2 && jit.factor == factor) {
+        return heat_get_backend(heat_backend_jit.name);
+    }
+
+    const char *cc = getenv(HEAT_JIT_CC_ENV);
+    if (cc == NULL || cc[0] == '\0') cc = HEAT_JIT_DEFAULT_CC;
+    char *source = generate_source(grid, dx2, dy2, factor);
+    char dir[HEAT_JIT_PATH_MAX / 2], library[HEAT_JIT_PATH_MAX];
+    if (source == NULL || cache_dir(dir, sizeof(dir)) != 0) {
+        free(source);
+        return NULL;
+    }
+    uint64_t hash = hash_text(hash_text(14695981039346656037ULL, source), cc);
+    snprintf(library, sizeof(library), "%s/heat_jit_%016llx.so", dir, (unsigned long long)hash);
+    int status = compile_kernel(source, cc, library);
+    free(source);
+    if (status != 0) return NULL;
+
+    void *handle = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        fprintf(stderr, "libheat: dlopen %s failed: %s\n", library, dlerror());
+        return NULL;
+    }
+    jit_kernel_fn kernel;
+    *(void **)(&kernel) = dlsym(handle, HEAT_JIT_SYMBOL);
+    if (kernel == NULL) {
+        fprintf(stderr, "libheat: %s has no %s\n", library, HEAT_JIT_SYMBOL);
+        dlclose(handle);
+        return NULL;
+    }
+
+    if (jit.handle) dlclose(jit.handle);
+    jit.kernel = kernel;
+    jit.handle = handle;
+    jit.rows = grid->rows;
+    jit.cols = grid->cols;
+    jit.stride = grid->stride;
+    jit.dx2 = dx2;
+    jit.dy2 = dy2;
+    jit.factor = factor;
+
+    if (heat_get_backend(heat_backend_jit.name) == NULL) {
+        heat_register_backend(&heat_backend_jit);
+    }
+    return heat_get_backend(heat_backend_jit.name);
+}
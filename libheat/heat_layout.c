@@ -0,0 +1,187 @@
+#include "heat.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TILE HEAT_LAYOUT_TILE
+#define TILE_CELLS (TILE * TILE)
+
+static const char *layout_names[HEAT_LAYOUT_COUNT] = {"rowmajor", "tiled", "morton"};
+
+const char *heat_layout_name(heat_layout_kind kind) {
+    return kind >= 0 && kind < HEAT_LAYOUT_COUNT ? layout_names[kind] : "?";
+}
+
+int heat_parse_layout(const char *name) {
+    if (name == NULL || name[0] == '\0') return HEAT_LAYOUT_ROW_MAJOR;
+    for (int k = 0; k < HEAT_LAYOUT_COUNT; k++) {
+        if (strcmp(name, layout_names[k]) == 0) return k;
+    }
+    return -1;
+}
+
+// Interleave the bits of the tile coordinates: row bits odd, column bits even
+static uint64_t morton_code(uint32_t ti, uint32_t tj) {
+    uint64_t code = 0;
+    for (int b = 0; b < 32; b++) {
+        code |= (uint64_t)((tj >> b) & 1u) << (2 * b);
+        code |= (uint64_t)((ti >> b) & 1u) << (2 * b + 1);
+    }
+    return code;
+}
+
+typedef struct {
+    uint64_t code;
+    int tile;
+} tile_key;
+
+static int compare_keys(const void *a, const void *b) {
+    uint64_t ka = ((const tile_key *)a)->code, kb = ((const tile_key *)b)->code;
+    return (ka > kb) - (ka < kb);
+}
+
+// Z order over a rectangular tile grid: sort by Morton code and pack, so
+// no storage is spent on the codes that fall outside the grid
+int heat_layout_init(heat_layout *layout, heat_layout_kind kind, int rows, int cols) {
+    layout->kind = kind;
+    layout->rows = rows;
+    layout->cols = cols;
+    layout->tiles_down = (rows + TILE - 1) / TILE;
+    layout->tiles_across = (cols + TILE - 1) / TILE;
+    layout->tile_offset = NULL;
+    if (kind == HEAT_LAYOUT_ROW_MAJOR) {
+        layout->size = (size_t)rows * cols;
+        return 0;
+    }
+
+    int tiles = layout->tiles_down * layout->tiles_across;
+    layout->size = (size_t)tiles * TILE_CELLS;
+    layout->tile_offset = (size_t *)malloc(tiles * sizeof(size_t));
+    if (layout->tile_offset == NULL) return -1;
+    if (kind == HEAT_LAYOUT_TILED) {
+        for (int t = 0; t < tiles; t++) {
+            layout->tile_offset[t] = (size_t)t * TILE_CELLS;
+        }
+        return 0;
+    }
+
+    tile_key *keys = (tile_key *)malloc(tiles * sizeof(tile_key));
+    if (keys == NULL) {
+        heat_layout_free(layout);
+        return -1;
+    }
+    for (int t = 0; t < tiles; t++) {
+        keys[t].code = morton_code(t / layout->tiles_across, t % layout->tiles_across);
+        keys[t].tile = t;
+    }
+    qsort(keys, tiles, sizeof(tile_key), compare_keys);
+    for (int n = 0; n < tiles; n++) {
+        layout->tile_offset[keys[n].tile] = (size_t)n * TILE_CELLS;
+    }
+    free(keys);
+    return 0;
+}
+
+void heat_layout_free(heat_layout *layout) {
+    free(layout->tile_offset);
+    layout->tile_offset = NULL;
+}
+
+// Columns [c0, c1) of one tile row. ext holds the row with its left and
+// right neighbours at ext[0] and ext[TILE + 1]. Same arithmetic as
+// heat_update_span; without `out` it returns max |Laplacian| instead.
+static inline double tile_row(const double *up, const double *ext, const double *down, double *out,
+                              int c0, int c1, double dx2, double dy2, double factor) {
+    double max_value = 0.0;
+    if (out == NULL) {
+        for (int c = c0; c < c1; c++) {
+            double res = fabs((down[c] - 2.0 * ext[c + 1] + up[c]) / dx2 +
+                              (ext[c + 2] - 2.0 * ext[c + 1] + ext[c]) / dy2);
+            if (res > max_value) max_value = res;
+        }
+        return max_value;
+    }
+    for (int c = c0; c < c1; c++) {
+        double d2T_dx2 = (down[c] - 2.0 * ext[c + 1] + up[c]) / dx2;
+        double d2T_dy2 = (ext[c + 2] - 2.0 * ext[c + 1] + ext[c]) / dy2;
+        double change = factor * (d2T_dx2 + d2T_dy2);
+        out[c] = ext[c + 1] + change;
+        if (change < 0.0) change = -change;
+        if (change > max_value) max_value = change;
+    }
+    return max_value;
+}
+
+// Tile by tile over the region. Neighbour tiles are only read across an
+// edge the region does not touch, so missing ones are never dereferenced.
+static double tiled_sweep(const heat_layout *layout, const heat_grid *grid, const double *T, double *T_new,
+                          heat_region region) {
+    double dx2 = grid->dx * grid->dx;
+    double dy2 = grid->dy * grid->dy;
+    double factor = grid->alpha * grid->dt;
+    double max_value = 0.0;
+    double ext[TILE + 2];
+
+    for (int ti = region.row_begin / TILE; ti <= (region.row_end - 1) / TILE; ti++) {
+        int r0 = region.row_begin > ti * TILE ? region.row_begin - ti * TILE : 0;
+        int r1 = region.row_end < (ti + 1) * TILE ? region.row_end - ti * TILE : TILE;
+        for (int tj = region.col_begin / TILE; tj <= (region.col_end - 1) / TILE; tj++) {
+            int c0 = region.col_begin > tj * TILE ? region.col_begin - tj * TILE : 0;
+            int c1 = region.col_end < (tj + 1) * TILE ? region.col_end - tj * TILE : TILE;
+            const size_t *offset = &layout->tile_offset[ti * layout->tiles_across + tj];
+            const double *tile = T + offset[0];
+            const double *above = ti > 0 ? T + offset[-layout->tiles_across] : tile;
+            const double *below = ti < layout->tiles_down - 1 ? T + offset[layout->tiles_across] : tile;
+            const double *left = tj > 0 ? T + offset[-1] : tile;
+            const double *right = tj < layout->tiles_across - 1 ? T + offset[1] : tile;
+            double *out = T_new ? T_new + offset[0] : NULL;
+
+            for (int r = r0; r < r1; r++) {
+                const double *row = tile + r * TILE;
+                const double *up = r > 0 ? row - TILE : above + (TILE - 1) * TILE;
+                const double *down = r < TILE - 1 ? row + TILE : below;
+                ext[0] = left[r * TILE + TILE - 1];
+                memcpy(ext + 1, row, TILE * sizeof(double));
+                ext[TILE + 1] = right[r * TILE];
+                double value = tile_row(up, ext, down, out ? out + r * TILE : NULL, c0, c1, dx2, dy2, factor);
+                if (value > max_value) max_value = value;
+            }
+        }
+    }
+    return max_value;
+}
+
+double heat_layout_step(const heat_layout *layout, const heat_backend *backend, const heat_grid *grid,
+                        const double *T, double *T_new, heat_region region) {
+    if (region.row_begin >= region.row_end || region.col_begin >= region.col_end) return 0.0;
+    if (layout->tile_offset == NULL) {
+        if (backend == NULL) backend = heat_get_backend(HEAT_DEFAULT_BACKEND);
+        return backend->step(grid, T, T_new, region);
+    }
+    return tiled_sweep(layout, grid, T, T_new, region);
+}
+
+double heat_layout_residual(const heat_layout *layout, const heat_grid *grid, const double *T, heat_region region) {
+    if (region.row_begin >= region.row_end || region.col_begin >= region.col_end) return 0.0;
+    if (layout->tile_offset == NULL) return heat_residual(grid, T, region);
+    return tiled_sweep(layout, grid, T, NULL, region);
+}
+
+// One tile row at a time, so the text comes out in row-major order
+void heat_layout_write_rows(const heat_layout *layout, const double *T, int row_begin, int row_end, FILE *fp) {
+    if (layout->tile_offset == NULL) {
+        heat_grid grid = {layout->rows, layout->cols, layout->cols, 0.0, 0.0, 0.0, 0.0};
+        heat_write_rows(&grid, T, row_begin, row_end, fp);
+        return;
+    }
+    for (int i = row_begin; i < row_end; i++) {
+        const size_t *offset = &layout->tile_offset[(i / TILE) * layout->tiles_across];
+        int r = i % TILE;
+        for (int j = 0; j < layout->cols; j++) {
+            fprintf(fp, "%.6f ", T[offset[j / TILE] + r * TILE + j % TILE]);
+        }
+        fprintf(fp, "\n");
+    }
+}
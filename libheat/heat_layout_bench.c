@@ -0,0 +1,112 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "heat.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Row-major versus tiled and Z-ordered tiled storage at several grid
+// sizes, including a wide one where consecutive rows sit on different
+// pages. Every layout must reproduce the row-major field exactly.
+// Usage: heat_layout_bench [Mcell-updates per run]
+
+static const int grid_sizes[][2] = {{128, 128}, {512, 512}, {1024, 1024}, {2048, 2048}, {4096, 4096}, {256, 65536}};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Hot top/bottom, cold sides, zero interior (the drivers' setup); returns
+// the field converted to row-major
+static double *run(heat_layout_kind kind, const heat_grid *grid, int steps, double *seconds) {
+    heat_layout layout;
+    if (heat_layout_init(&layout, kind, grid->rows, grid->cols) != 0) {
+        fprintf(stderr, "ERROR: layout allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    double *T = (double *)calloc(layout.size, sizeof(double));
+    double *T_new = (double *)calloc(layout.size, sizeof(double));
+    double *result = (double *)malloc((size_t)grid->rows * grid->cols * sizeof(double));
+    if (!T || !T_new || !result) {
+        fprintf(stderr, "ERROR: allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int j = 0; j < grid->cols; j++) {
+        HEAT_AT(&layout, T, 0, j) = HEAT_AT(&layout, T_new, 0, j) = 100.0;
+        HEAT_AT(&layout, T, grid->rows - 1, j) = HEAT_AT(&layout, T_new, grid->rows - 1, j) = 100.0;
+    }
+
+    const heat_backend *scalar = heat_get_backend("scalar");
+    heat_region interior = heat_interior(grid);
+    double start = now();
+    for (int step = 0; step < steps; step++) {
+        heat_layout_step(&layout, scalar, grid, T, T_new, interior);
+        double *tmp = T;
+        T = T_new;
+        T_new = tmp;
+    }
+    *seconds = now() - start;
+
+    for (int i = 0; i < grid->rows; i++) {
+        for (int j = 0; j < grid->cols; j++) {
+            result[(size_t)i * grid->cols + j] = HEAT_AT(&layout, T, i, j);
+        }
+    }
+    free(T);
+    free(T_new);
+    heat_layout_free(&layout);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    double budget = argc > 1 ? atof(argv[1]) : 200.0;
+    if (budget <= 0.0) {
+        fprintf(stderr, "Usage: %s [Mcell-updates per run]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("Tile %dx%d doubles, about %.0f Mcell-updates per run (scalar kernel for row-major)\n",
+           HEAT_LAYOUT_TILE, HEAT_LAYOUT_TILE, budget);
+    printf("%12s %6s %-9s %10s %14s %12s\n", "grid", "steps", "layout", "time (s)", "Mcell-upd/s", "max |diff|");
+
+    int mismatches = 0;
+    int count = (int)(sizeof(grid_sizes) / sizeof(grid_sizes[0]));
+    for (int g = 0; g < count; g++) {
+        int rows = grid_sizes[g][0], cols = grid_sizes[g][1];
+        double h = 1.0 / (cols - 1);
+        heat_grid grid = {rows, cols, cols, 0.1, h, h, 0.2 * h * h / 0.1};
+        double mcells_per_step = (double)(rows - 2) * (cols - 2) * 1e-6;
+        int steps = (int)ceil(budget / mcells_per_step);
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d", rows, cols);
+
+        double *reference = NULL;
+        for (int k = 0; k < HEAT_LAYOUT_COUNT; k++) {
+            double seconds;
+            double *field = run((heat_layout_kind)k, &grid, steps, &seconds);
+            double max_diff = 0.0;
+            if (reference == NULL) {
+                reference = field;
+            } else {
+                for (size_t c = 0; c < (size_t)rows * cols; c++) {
+                    max_diff = fmax(max_diff, fabs(field[c] - reference[c]));
+                }
+                free(field);
+            }
+            if (max_diff != 0.0) mismatches++;
+            printf("%12s %6d %-9s %10.4f %14.1f %12.3g\n", label, steps, heat_layout_name((heat_layout_kind)k),
+                   seconds, mcells_per_step * steps / seconds, max_diff);
+        }
+        free(reference);
+    }
+    if (mismatches > 0) {
+        printf("%d layout(s) differ from row-major\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
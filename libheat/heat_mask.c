@@ -0,0 +1,262 @@
+#include "heat_backends.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int fail(heat_mask *mask, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(mask->error, sizeof(mask->error), fmt, args);
+    va_end(args);
+    heat_mask_free(mask);
+    return -1;
+}
+
+static int is_fixed(unsigned char c) {
+    return c >= 'A' && c <= 'Z';
+}
+
+// Cell (i, j) as seen from an interior neighbour: with periodic edges the
+// ghost ring mirrors the opposite interior row/column
+static unsigned char kind_at(const heat_mask *mask, int i, int j, int wrap_rows, int wrap_cols) {
+    if (wrap_rows && i == 0) i = mask->rows - 2;
+    if (wrap_rows && i == mask->rows - 1) i = 1;
+    if (wrap_cols && j == 0) j = mask->cols - 2;
+    if (wrap_cols && j == mask->cols - 1) j = 1;
+    if (i == 0 || i == mask->rows - 1 || j == 0 || j == mask->cols - 1) return HEAT_CELL_ACTIVE;  // ghost cell
+    return mask->kind[(size_t)i * mask->cols + j];
+}
+
+// Split every interior row into maximal runs of active cells whose four
+// neighbours all hold a temperature, plus single rim cells next to a hole
+static int build_lists(heat_mask *mask, int wrap_rows, int wrap_cols) {
+    int rows = mask->rows, cols = mask->cols;
+    mask->run_start = (int *)calloc(rows + 1, sizeof(int));
+    mask->rim_start = (int *)calloc(rows + 1, sizeof(int));
+    // Worst case: alternating cells, so at most half the interior is runs
+    size_t interior = (size_t)(rows - 2) * (cols - 2);
+    mask->runs = (heat_run *)malloc((interior / 2 + rows) * sizeof(heat_run));
+    mask->rim = (heat_rim_cell *)malloc((interior + 1) * sizeof(heat_rim_cell));
+    if (!mask->run_start || !mask->rim_start || !mask->runs || !mask->rim) {
+        return fail(mask, "out of memory");
+    }
+
+    int runs = 0, rim = 0;
+    mask->active_cells = 0;
+    for (int i = 0; i < rows; i++) {
+        mask->run_start[i] = runs;
+        mask->rim_start[i] = rim;
+        if (i == 0 || i == rows - 1) continue;
+        int open = -1;
+        for (int j = 1; j < cols; j++) {
+            int bulk = 0;
+            if (j < cols - 1 && mask->kind[(size_t)i * cols + j] == HEAT_CELL_ACTIVE) {
+                heat_rim_cell cell = {j, kind_at(mask, i - 1, j, wrap_rows, wrap_cols) != HEAT_CELL_HOLE,
+                                      kind_at(mask, i + 1, j, wrap_rows, wrap_cols) != HEAT_CELL_HOLE,
+                                      kind_at(mask, i, j - 1, wrap_rows, wrap_cols) != HEAT_CELL_HOLE,
+                                      kind_at(mask, i, j + 1, wrap_rows, wrap_cols) != HEAT_CELL_HOLE};
+                bulk = cell.up && cell.down && cell.left && cell.right;
+                if (!bulk) mask->rim[rim++] = cell;
+                mask->active_cells++;
+            }
+            if (bulk && open < 0) open = j;
+            if (!bulk && open >= 0) {
+                mask->runs[runs].col_begin = open;
+                mask->runs[runs].col_end = j;
+                runs++;
+                open = -1;
+            }
+        }
+    }
+    mask->run_start[rows] = runs;
+    mask->rim_start[rows] = rim;
+    return 0;
+}
+
+int heat_mask_parse(heat_mask *mask, const char *text, int rows, int cols, int wrap_rows, int wrap_cols) {
+    memset(mask, 0, sizeof(*mask));
+    mask->rows = rows;
+    mask->cols = cols;
+    for (int k = 0; k < 26; k++) mask->fixed_temp[k] = NAN;
+    mask->kind = (unsigned char *)malloc((size_t)rows * cols);
+    if (mask->kind == NULL) return fail(mask, "out of memory");
+
+    int row = 0, line_no = 0;
+    const char *p = text;
+    while (*p != '\0') {
+        const char *end = strchr(p, '\n');
+        size_t length = end ? (size_t)(end - p) : strlen(p);
+        const char *next = end ? end + 1 : p + length;
+        line_no++;
+        while (length > 0 && (p[length - 1] == '\r' || p[length - 1] == ' ' || p[length - 1] == '\t')) length--;
+
+        if (length == 0 || p[0] == ';') {
+            // blank line or comment
+        } else if (strncmp(p, "temp ", 5) == 0) {
+            char letter;
+            double value;
+            if (sscanf(p + 5, " %c %lf", &letter, &value) != 2 || !is_fixed((unsigned char)letter)) {
+                return fail(mask, "line %d: expected 'temp LETTER VALUE' with LETTER in A-Z", line_no);
+            }
+            mask->fixed_temp[letter - 'A'] = value;
+        } else {
+            if (row == rows) return fail(mask, "line %d: more than %d map rows", line_no, rows);
+            if (length != (size_t)cols) {
+                return fail(mask, "line %d: map row has %zu cells, expected %d", line_no, length, cols);
+            }
+            for (int j = 0; j < cols; j++) {
+                unsigned char c = (unsigned char)p[j];
+                if (c != HEAT_CELL_ACTIVE && c != HEAT_CELL_HOLE && !is_fixed(c)) {
+                    return fail(mask, "line %d: unknown cell '%c' (use '.', '#' or A-Z)", line_no, c);
+                }
+                if (is_fixed(c) && isnan(mask->fixed_temp[c - 'A'])) {
+                    return fail(mask, "line %d: no 'temp %c VALUE' before its first use", line_no, c);
+                }
+                mask->kind[(size_t)row * cols + j] = c;
+            }
+            row++;
+        }
+        p = next;
+    }
+    if (row != rows) return fail(mask, "%d map rows, expected %d", row, rows);
+    return build_lists(mask, wrap_rows, wrap_cols);
+}
+
+int heat_mask_load(heat_mask *mask, const char *path, int rows, int cols, int wrap_rows, int wrap_cols) {
+    char *text = heat_mask_read(path);
+    if (text == NULL) {
+        memset(mask, 0, sizeof(*mask));
+        snprintf(mask->error, sizeof(mask->error), "cannot read %s", path);
+        return -1;
+    }
+    int status = heat_mask_parse(mask, text, rows, cols, wrap_rows, wrap_cols);
+    free(text);
+    return status;
+}
+
+char *heat_mask_read(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) return NULL;
+    char *text = NULL;
+    long length = -1;
+    if (fseek(fp, 0, SEEK_END) == 0 && (length = ftell(fp)) >= 0 && fseek(fp, 0, SEEK_SET) == 0) {
+        text = (char *)malloc((size_t)length + 1);
+    }
+    if (text != NULL && fread(text, 1, (size_t)length, fp) != (size_t)length) {
+        free(text);
+        text = NULL;
+    }
+    fclose(fp);
+    if (text != NULL) text[length] = '\0';
+    return text;
+}
+
+void heat_mask_free(heat_mask *mask) {
+    free(mask->kind);
+    free(mask->run_start);
+    free(mask->runs);
+    free(mask->rim_start);
+    free(mask->rim);
+    mask->kind = NULL;
+    mask->run_start = mask->rim_start = NULL;
+    mask->runs = NULL;
+    mask->rim = NULL;
+}
+
+int heat_mask_row_cells(const heat_mask *mask, int row) {
+    int cells = mask->rim_start[row + 1] - mask->rim_start[row];
+    for (int k = mask->run_start[row]; k < mask->run_start[row + 1]; k++) {
+        cells += mask->runs[k].col_end - mask->runs[k].col_begin;
+    }
+    return cells;
+}
+
+void heat_mask_fill(const heat_mask *mask, int row_offset, const heat_grid *grid, double *T,
+                    int row_begin, int row_end) {
+    for (int i = row_begin; i < row_end; i++) {
+        int mi = i + row_offset;
+        if (mi <= 0 || mi >= mask->rows - 1) continue;
+        const unsigned char *kind = mask->kind + (size_t)mi * mask->cols;
+        double *row = T + (size_t)i * grid->stride;
+        for (int j = 1; j < mask->cols - 1; j++) {
+            if (kind[j] == HEAT_CELL_HOLE) {
+                row[j] = NAN;
+            } else if (is_fixed(kind[j])) {
+                row[j] = mask->fixed_temp[kind[j] - 'A'];
+            }
+        }
+    }
+}
+
+// Rim cells: a hole neighbour is replaced by the cell itself, which makes
+// that face insulated without a branch. With all four flags set this is
+// exactly heat_update_span's arithmetic.
+static inline double rim_laplacian(const double *c, const heat_rim_cell *cell, int s, double dx2, double dy2,
+                                   double *centre) {
+    double mid = c[0];
+    *centre = mid;
+    double d2T_dx2 = (c[cell->down * s] - 2.0 * mid + c[-cell->up * s]) / dx2;
+    double d2T_dy2 = (c[cell->right] - 2.0 * mid + c[-cell->left]) / dy2;
+    return d2T_dx2 + d2T_dy2;
+}
+
+double heat_mask_step(const heat_mask *mask, int row_offset, const heat_grid *grid, const double *T,
+                      double *T_new, heat_region region) {
+    int s = grid->stride;
+    double dx2 = grid->dx * grid->dx;
+    double dy2 = grid->dy * grid->dy;
+    double factor = grid->alpha * grid->dt;
+    double max_change = 0.0;
+
+    for (int i = region.row_begin; i < region.row_end; i++) {
+        int mi = i + row_offset;
+        for (int k = mask->run_start[mi]; k < mask->run_start[mi + 1]; k++) {
+            int j0 = mask->runs[k].col_begin > region.col_begin ? mask->runs[k].col_begin : region.col_begin;
+            int j1 = mask->runs[k].col_end < region.col_end ? mask->runs[k].col_end : region.col_end;
+            if (j0 >= j1) continue;
+            double change = heat_update_span(grid, T, T_new, i, j0, j1);
+            if (change > max_change) max_change = change;
+        }
+        for (int k = mask->rim_start[mi]; k < mask->rim_start[mi + 1]; k++) {
+            const heat_rim_cell *cell = &mask->rim[k];
+            if (cell->col < region.col_begin || cell->col >= region.col_end) continue;
+            size_t at = (size_t)i * s + cell->col;
+            double mid;
+            double change = factor * rim_laplacian(T + at, cell, s, dx2, dy2, &mid);
+            T_new[at] = mid + change;
+            if (change < 0.0) change = -change;
+            if (change > max_change) max_change = change;
+        }
+    }
+    return max_change;
+}
+
+double heat_mask_residual(const heat_mask *mask, int row_offset, const heat_grid *grid, const double *T,
+                          heat_region region) {
+    int s = grid->stride;
+    double dx2 = grid->dx * grid->dx;
+    double dy2 = grid->dy * grid->dy;
+    double max_res = 0.0;
+
+    for (int i = region.row_begin; i < region.row_end; i++) {
+        int mi = i + row_offset;
+        for (int k = mask->run_start[mi]; k < mask->run_start[mi + 1]; k++) {
+            heat_region run = {i, i + 1, mask->runs[k].col_begin, mask->runs[k].col_end};
+            if (run.col_begin < region.col_begin) run.col_begin = region.col_begin;
+            if (run.col_end > region.col_end) run.col_end = region.col_end;
+            if (run.col_begin >= run.col_end) continue;
+            double res = heat_residual(grid, T, run);
+            if (res > max_res) max_res = res;
+        }
+        for (int k = mask->rim_start[mi]; k < mask->rim_start[mi + 1]; k++) {
+            const heat_rim_cell *cell = &mask->rim[k];
+            if (cell->col < region.col_begin || cell->col >= region.col_end) continue;
+            double mid;
+            double res = fabs(rim_laplacian(T + (size_t)i * s + cell->col, cell, s, dx2, dy2, &mid));
+            if (res > max_res) max_res = res;
+        }
+    }
+    return max_res;
+}
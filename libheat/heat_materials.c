@@ -0,0 +1,222 @@
+#include "heat.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int fail(heat_materials *materials, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(materials->error, sizeof(materials->error), fmt, args);
+    va_end(args);
+    heat_materials_free(materials);
+    return -1;
+}
+
+int heat_materials_parse(heat_materials *materials, const char *text, int rows, int cols, double base_alpha,
+                         int wrap_rows, int wrap_cols) {
+    memset(materials, 0, sizeof(*materials));
+    materials->rows = rows;
+    materials->cols = cols;
+    materials->wrap_rows = wrap_rows;
+    materials->wrap_cols = wrap_cols;
+    for (int c = 0; c < 256; c++) materials->alpha[c] = NAN;
+    materials->alpha[HEAT_MATERIAL_BASE] = base_alpha;
+    materials->kind = (unsigned char *)malloc((size_t)rows * cols);
+    if (materials->kind == NULL) return fail(materials, "out of memory");
+
+    int row = 0, line_no = 0;
+    const char *p = text;
+    while (*p != '\0') {
+        const char *end = strchr(p, '\n');
+        size_t length = end ? (size_t)(end - p) : strlen(p);
+        const char *next = end ? end + 1 : p + length;
+        line_no++;
+        while (length > 0 && (p[length - 1] == '\r' || p[length - 1] == ' ' || p[length - 1] == '\t')) length--;
+
+        if (length == 0 || p[0] == ';') {
+            // blank line or comment
+        } else if (strncmp(p, "alpha ", 6) == 0) {
+            char symbol;
+            double value;
+            if (sscanf(p + 6, " %c %lf", &symbol, &value) != 2 || symbol == ';') {
+                return fail(materials, "line %d: expected 'alpha SYMBOL VALUE'", line_no);
+            }
+            if (!(value >= 0.0)) {
+                return fail(materials, "line %d: diffusivity must be non-negative (got %g)", line_no, value);
+            }
+            materials->alpha[(unsigned char)symbol] = value;
+        } else {
+            if (row == rows) return fail(materials, "line %d: more than %d map rows", line_no, rows);
+            if (length != (size_t)cols) {
+                return fail(materials, "line %d: map row has %zu cells, expected %d", line_no, length, cols);
+            }
+            for (int j = 0; j < cols; j++) {
+                unsigned char c = (unsigned char)p[j];
+                if (isnan(materials->alpha[c])) {
+                    return fail(materials, "line %d: no 'alpha %c VALUE' before its first use", line_no, c);
+                }
+                materials->kind[(size_t)row * cols + j] = c;
+            }
+            row++;
+        }
+        p = next;
+    }
+    if (row != rows) return fail(materials, "%d map rows, expected %d", row, rows);
+
+    materials->alpha_min = INFINITY;
+    materials->alpha_max = 0.0;
+    for (size_t c = 0; c < (size_t)rows * cols; c++) {
+        double a = materials->alpha[materials->kind[c]];
+        if (a < materials->alpha_min) materials->alpha_min = a;
+        if (a > materials->alpha_max) materials->alpha_max = a;
+    }
+    return 0;
+}
+
+int heat_materials_load(heat_materials *materials, const char *path, int rows, int cols, double base_alpha,
+                        int wrap_rows, int wrap_cols) {
+    char *text = heat_mask_read(path);
+    if (text == NULL) {
+        memset(materials, 0, sizeof(*materials));
+        snprintf(materials->error, sizeof(materials->error), "cannot read %s", path);
+        return -1;
+    }
+    int status = heat_materials_parse(materials, text, rows, cols, base_alpha, wrap_rows, wrap_cols);
+    free(text);
+    return status;
+}
+
+static void free_coefficients(heat_materials *materials) {
+    free(materials->down);
+    free(materials->right);
+    free(materials->down_f);
+    free(materials->right_f);
+    materials->down = materials->right = NULL;
+    materials->down_f = materials->right_f = NULL;
+}
+
+void heat_materials_free(heat_materials *materials) {
+    free(materials->kind);
+    materials->kind = NULL;
+    free_coefficients(materials);
+}
+
+// Diffusivity of cell (i, j); with periodic edges the ghost ring holds
+// the opposite interior row/column, and so does its material
+static double alpha_at(const heat_materials *m, int i, int j) {
+    if (m->wrap_rows && i == 0) i = m->rows - 2;
+    if (m->wrap_rows && i == m->rows - 1) i = 1;
+    if (m->wrap_cols && j == 0) j = m->cols - 2;
+    if (m->wrap_cols && j == m->cols - 1) j = 1;
+    return m->alpha[m->kind[(size_t)i * m->cols + j]];
+}
+
+// Harmonic mean: the series conductance of two half cells
+static double face_alpha(double a, double b) {
+    return a + b > 0.0 ? 2.0 * a * b / (a + b) : 0.0;
+}
+
+int heat_materials_build(heat_materials *materials, const heat_grid *grid, int row_begin, int row_end,
+                         int single) {
+    free_coefficients(materials);
+    if (row_begin < 0) row_begin = 0;
+    if (row_end > materials->rows) row_end = materials->rows;
+    materials->row_begin = row_begin;
+    materials->row_end = row_end;
+    materials->single = single;
+    if (row_end <= row_begin) return 0;
+
+    int cols = materials->cols;
+    size_t cells = (size_t)(row_end - row_begin) * cols;
+    if (single) {
+        materials->down_f = (float *)calloc(cells, sizeof(float));
+        materials->right_f = (float *)calloc(cells, sizeof(float));
+        if (!materials->down_f || !materials->right_f) return fail(materials, "out of memory");
+    } else {
+        materials->down = (double *)calloc(cells, sizeof(double));
+        materials->right = (double *)calloc(cells, sizeof(double));
+        if (!materials->down || !materials->right) return fail(materials, "out of memory");
+    }
+
+    double dt_dx2 = grid->dt / (grid->dx * grid->dx);
+    double dt_dy2 = grid->dt / (grid->dy * grid->dy);
+    for (int i = row_begin; i < row_end; i++) {
+        for (int j = 0; j < cols; j++) {
+            double a = alpha_at(materials, i, j);
+            double down = i + 1 < materials->rows ? dt_dx2 * face_alpha(a, alpha_at(materials, i + 1, j)) : 0.0;
+            double right = j + 1 < cols ? dt_dy2 * face_alpha(a, alpha_at(materials, i, j + 1)) : 0.0;
+            size_t at = (size_t)(i - row_begin) * cols + j;
+            if (single) {
+                materials->down_f[at] = (float)down;
+                materials->right_f[at] = (float)right;
+            } else {
+                materials->down[at] = down;
+                materials->right[at] = right;
+            }
+        }
+    }
+    return 0;
+}
+
+// Flux form: each face carries coeff * (neighbour - centre), so what
+// leaves one cell enters its neighbour. `up`/`down` are the coefficients
+// of the faces above and below the row, `right` those to the right of
+// each cell (the face to the left of j is right[j - 1]). The residual
+// variants store nothing and only report the largest change.
+#define MATERIALS_ROW(NAME, TYPE, STORE)                                                                        \
+    static double NAME(const double *row, double *out, int s, const TYPE *up, const TYPE *down,                 \
+                       const TYPE *right, int j0, int j1) {                                                     \
+        double max_change = 0.0;                                                                                \
+        for (int j = j0; j < j1; j++) {                                                                         \
+            double mid = row[j];                                                                                \
+            double change = up[j] * (row[j - s] - mid) + down[j] * (row[j + s] - mid) +                         \
+                            right[j - 1] * (row[j - 1] - mid) + right[j] * (row[j + 1] - mid);                  \
+            STORE;                                                                                              \
+            if (change < 0.0) change = -change;                                                                 \
+            if (change > max_change) max_change = change;                                                       \
+        }                                                                                                       \
+        return max_change;                                                                                      \
+    }
+
+MATERIALS_ROW(materials_row, double, out[j] = mid + change)
+MATERIALS_ROW(materials_row_f, float, out[j] = mid + change)
+MATERIALS_ROW(materials_rate, double, (void)out)
+MATERIALS_ROW(materials_rate_f, float, (void)out)
+
+static double sweep(const heat_materials *m, int row_offset, const heat_grid *grid, const double *T,
+                    double *T_new, heat_region region) {
+    int s = grid->stride;
+    int cols = m->cols;
+    double max_change = 0.0;
+
+    for (int i = region.row_begin; i < region.row_end; i++) {
+        size_t face = (size_t)(i + row_offset - m->row_begin) * cols;
+        const double *row = T + (size_t)i * s;
+        double *out = T_new ? T_new + (size_t)i * s : NULL;
+        int j0 = region.col_begin, j1 = region.col_end;
+        double change;
+        if (m->single) {
+            const float *up = m->down_f + face - cols, *down = m->down_f + face, *right = m->right_f + face;
+            change = out ? materials_row_f(row, out, s, up, down, right, j0, j1)
+                         : materials_rate_f(row, out, s, up, down, right, j0, j1);
+        } else {
+            const double *up = m->down + face - cols, *down = m->down + face, *right = m->right + face;
+            change = out ? materials_row(row, out, s, up, down, right, j0, j1)
+                         : materials_rate(row, out, s, up, down, right, j0, j1);
+        }
+        if (change > max_change) max_change = change;
+    }
+    return max_change;
+}
+
+double heat_materials_step(const heat_materials *materials, int row_offset, const heat_grid *grid,
+                           const double *T, double *T_new, heat_region region) {
+    return sweep(materials, row_offset, grid, T, T_new, region);
+}
+
+double heat_materials_residual(const heat_materials *materials, int row_offset, const heat_grid *grid,
+                               const double *T, heat_region region) {
+    return sweep(materials, row_offset, grid, T, NULL, region) / (grid->dt * grid->alpha);
+}
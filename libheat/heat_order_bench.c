@@ -0,0 +1,134 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "heat.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Error versus cost of the 2nd-order (5-point) and 4th-order (wide
+// cross) stencils on T = sin(pi x) sin(pi y) exp(-2 pi^2 alpha t) over the
+// unit square with T = 0 on the edges. For each order it refines until
+// the max error, relative to the exact peak at t_end, meets the tolerance.
+// It reports the coarsest grid that passes and what it cost.
+//
+// dt is the smaller of 90% of the order's stability limit and the step
+// that keeps the explicit-Euler time error under a quarter of the
+// tolerance, so the comparison measures the spatial order.
+// Usage: heat_order_bench [tolerance t_end]
+
+#define ALPHA 0.1
+#define STABILITY_FRACTION 0.9
+static const int grid_sizes[] = {9, 11, 13, 17, 21, 25, 33, 41, 49, 65, 81, 97, 129, 161, 193, 257};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    double error;       // max |T - exact| / exact peak
+    int steps;
+    double mcell_updates;
+    double seconds;
+} run_result;
+
+static run_result run(int order, int n, double tol, double t_end) {
+    const double pi = acos(-1.0);
+    double h = 1.0 / (n - 1);
+    double mu = 2.0 * pi * pi * ALPHA;
+    // Stable for alpha*dt*(1/dx^2 + 1/dy^2) <= 1/2 (5-point) or 3/8 (wide cross)
+    double limit = order == 4 ? 3.0 / 8.0 : 0.5;
+    double dt_stable = STABILITY_FRACTION * limit * h * h / (2.0 * ALPHA);
+    double dt_time = tol / (2.0 * mu * mu * t_end);
+    double dt = fmin(dt_stable, dt_time);
+    int steps = (int)ceil(t_end / dt);
+    dt = t_end / steps;
+
+    heat_grid grid = {n, n, n, ALPHA, h, h, dt};
+    size_t cells = (size_t)n * n;
+    double *T = (double *)calloc(cells, sizeof(double));
+    double *T_new = (double *)calloc(cells, sizeof(double));
+    if (!T || !T_new) {
+        fprintf(stderr, "ERROR: allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 1; i < n - 1; i++) {
+        for (int j = 1; j < n - 1; j++) {
+            T[(size_t)i * n + j] = sin(pi * i * h) * sin(pi * j * h);
+        }
+    }
+
+    const heat_backend *scalar = heat_get_backend("scalar");
+    heat_region interior = heat_interior(&grid);
+    double start = now();
+    for (int step = 0; step < steps; step++) {
+        if (order == 4) {
+            heat_step4(&grid, T, T_new, interior, HEAT_ALL_EDGES);
+        } else {
+            scalar->step(&grid, T, T_new, interior);
+        }
+        double *tmp = T;
+        T = T_new;
+        T_new = tmp;
+    }
+    run_result result = {0.0, steps, (double)(n - 2) * (n - 2) * steps * 1e-6, now() - start};
+
+    double peak = exp(-mu * t_end);
+    for (int i = 1; i < n - 1; i++) {
+        for (int j = 1; j < n - 1; j++) {
+            double exact = peak * sin(pi * i * h) * sin(pi * j * h);
+            result.error = fmax(result.error, fabs(T[(size_t)i * n + j] - exact) / peak);
+        }
+    }
+    free(T);
+    free(T_new);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    double tol = argc > 1 ? atof(argv[1]) : 1e-4;
+    double t_end = argc > 2 ? atof(argv[2]) : 0.5;
+    if (tol <= 0.0 || t_end <= 0.0) {
+        fprintf(stderr, "Usage: %s [tolerance t_end]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("Decaying sin(pi x) sin(pi y) mode, alpha=%.2f, t_end=%.3f, tolerance %.1e\n", ALPHA, t_end, tol);
+    printf("%5s %6s %12s %8s %14s %10s\n", "order", "grid", "rel. error", "steps", "Mcell-updates", "time (s)");
+
+    run_result best[2];
+    int best_n[2] = {0, 0};
+    int count = (int)(sizeof(grid_sizes) / sizeof(grid_sizes[0]));
+    for (int o = 0; o < 2; o++) {
+        int order = o == 0 ? 2 : 4;
+        for (int g = 0; g < count && best_n[o] == 0; g++) {
+            int n = grid_sizes[g];
+            run_result r = run(order, n, tol, t_end);
+            printf("%5d %6d %12.3e %8d %14.1f %10.4f%s\n", order, n, r.error, r.steps, r.mcell_updates,
+                   r.seconds, r.error <= tol ? "  <- coarsest passing" : "");
+            if (r.error <= tol) {
+                best[o] = r;
+                best_n[o] = n;
+            }
+        }
+    }
+
+    printf("\n");
+    for (int o = 0; o < 2; o++) {
+        if (best_n[o] == 0) {
+            printf("order %d: no grid up to %d meets %.1e\n", o == 0 ? 2 : 4, grid_sizes[count - 1], tol);
+        } else {
+            printf("order %d: %dx%d grid, %.1f Mcell-updates, %.4f s\n", o == 0 ? 2 : 4, best_n[o], best_n[o],
+                   best[o].mcell_updates, best[o].seconds);
+        }
+    }
+    if (best_n[0] && best_n[1]) {
+        printf("4th order needs %.1fx fewer cell-updates and %.1fx less time\n",
+               best[0].mcell_updates / best[1].mcell_updates, best[0].seconds / best[1].seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "heat.h"
+#include "heat_backends.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static heat_backend registry[HEAT_MAX_BACKENDS];
+static int registry_count = 0;
+static int builtins_loaded = 0;
+
+static void load_builtins(void) {
+    if (builtins_loaded) return;
+    builtins_loaded = 1;
+    heat_register_backend(&heat_backend_scalar);
+    heat_register_backend(&heat_backend_simd);
+    heat_register_backend(&heat_backend_threaded);
+    heat_register_backend(&heat_backend_tiled);
+}
+
+int heat_register_backend(const heat_backend *backend) {
+    load_builtins();
+    if (backend == NULL || backend->name == NULL || backend->step == NULL) return -1;
+    if (registry_count == HEAT_MAX_BACKENDS) return -1;
+    for (int b = 0; b < registry_count; b++) {
+        if (strcmp(registry[b].name, backend->name) == 0) return -1;
+    }
+    registry[registry_count++] = *backend;
+    return 0;
+}
+
+const heat_backend *heat_get_backend(const char *name) {
+    load_builtins();
+    for (int b = 0; b < registry_count; b++) {
+        if (strcmp(registry[b].name, name) == 0) return &registry[b];
+    }
+    return NULL;
+}
+
+int heat_backend_count(void) {
+    load_builtins();
+    return registry_count;
+}
+
+const heat_backend *heat_backend_at(int index) {
+    load_builtins();
+    if (index < 0 || index >= registry_count) return NULL;
+    return &registry[index];
+}
+
+const heat_backend *heat_select_backend(const char *name) {
+    if (name == NULL) name = getenv(HEAT_BACKEND_ENV);
+    if (name == NULL || name[0] == '\0') name = HEAT_DEFAULT_BACKEND;
+    return heat_get_backend(name);
+}
+
+void heat_list_backends(FILE *fp) {
+    load_builtins();
+    for (int b = 0; b < registry_count; b++) {
+        fprintf(fp, "  %-10s %s\n", registry[b].name, registry[b].description);
+    }
+}
+
+heat_region heat_interior(const heat_grid *grid) {
+    heat_region region = {1, grid->rows - 1, 1, grid->cols - 1};
+    return region;
+}
+
+double heat_residual(const heat_grid *grid, const double *T, heat_region region) {
+    int s = grid->stride;
+    double dx2 = grid->dx * grid->dx;
+    double dy2 = grid->dy * grid->dy;
+    double max_res = 0.0;
+
+    for (int i = region.row_begin; i < region.row_end; i++) {
+        const double *row = T + (size_t)i * s;
+        for (int j = region.col_begin; j < region.col_end; j++) {
+            double laplacian = (row[j + s] - 2.0 * row[j] + row[j - s]) / dx2 +
+                               (row[j + 1] - 2.0 * row[j] + row[j - 1]) / dy2;
+            double res = fabs(laplacian);
+            if (res > max_res) {
+                max_res = res;
+            }
+        }
+    }
+    return max_res;
+}
+
+void heat_write_rows(const heat_grid *grid, const double *T, int row_begin, int row_end, FILE *fp) {
+    for (int i = row_begin; i < row_end; i++) {
+        const double *row = T + (size_t)i * grid->stride;
+        for (int j = 0; j < grid->cols; j++) {
+            fprintf(fp, "%.6f ", row[j]);
+        }
+        fprintf(fp, "\n");
+    }
+}
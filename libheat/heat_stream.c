@@ -0,0 +1,196 @@
+#define _DEFAULT_SOURCE
+
+#include "heat.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+int heat_map_field(heat_mapped_field *field, const char *path, int rows, int cols) {
+    field->T = NULL;
+    field->rows = rows;
+    field->cols = cols;
+    field->bytes = (size_t)rows * cols * sizeof(double);
+    field->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (field->fd < 0) {
+        fprintf(stderr, "libheat: cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (ftruncate(field->fd, (off_t)field->bytes) != 0) {
+        fprintf(stderr, "libheat: cannot size %s to %zu bytes: %s\n", path, field->bytes, strerror(errno));
+        close(field->fd);
+        return -1;
+    }
+    void *base = mmap(NULL, field->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, field->fd, 0);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "libheat: cannot map %s: %s\n", path, strerror(errno));
+        close(field->fd);
+        return -1;
+    }
+    field->T = (double *)base;
+    return 0;
+}
+
+void heat_unmap_field(heat_mapped_field *field) {
+    if (field->T == NULL) return;
+    munmap(field->T, field->bytes);
+    close(field->fd);
+    field->T = NULL;
+}
+
+// Pages lying entirely inside rows [row_begin, row_end). Pages shared with
+// a neighbouring row stay mapped, since that row may still be in use.
+static int page_span(const heat_mapped_field *field, int row_begin, int row_end, char **start, size_t *length) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t row_bytes = (size_t)field->cols * sizeof(double);
+    size_t begin = ((size_t)row_begin * row_bytes + page - 1) / page * page;
+    size_t end = (size_t)row_end * row_bytes / page * page;
+    if (row_end == field->rows) end = field->bytes;
+    if (end <= begin) return 0;
+    *start = (char *)field->T + begin;
+    *length = end - begin;
+    return 1;
+}
+
+void heat_release_rows(heat_mapped_field *field, int row_begin, int row_end) {
+    char *start;
+    size_t length;
+    if (!page_span(field, row_begin, row_end, &start, &length)) return;
+    // Shared file pages keep their contents in the page cache
+    msync(start, length, MS_ASYNC);
+    madvise(start, length, MADV_DONTNEED);
+}
+
+// Ask the kernel to start reading rows [row_begin, row_end) in now
+static void prefetch_rows(heat_mapped_field *field, int row_begin, int row_end) {
+    if (row_end > field->rows) row_end = field->rows;
+    if (row_begin >= row_end) return;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t row_bytes = (size_t)field->cols * sizeof(double);
+    size_t begin = (size_t)row_begin * row_bytes / page * page;
+    madvise((char *)field->T + begin, (size_t)row_end * row_bytes - begin, MADV_WILLNEED);
+}
+
+// One pass: level 0 is the field as stored, level k is k steps later and
+// the last level is written back. Every level but the last keeps its three
+// most recent rows in a ring (row r in slot r % 3). A row arriving at
+// level k lets level k+1 compute the row above it, so the levels trail
+// each other by one row and the pass reads and writes each row once.
+typedef struct {
+    heat_mapped_field *field;
+    const heat_grid *grid;
+    const heat_bc *bc;
+    int levels;                 // steps in this pass
+    double *rings;              // levels rings of 3 rows, level 0 first
+    double *edge;               // 2 rows for filling a ghost row
+    double max_change;          // max |dT| of the last level
+} stream_pass;
+
+static double *ring_row(const stream_pass *p, int level, int r) {
+    return p->rings + ((size_t)level * 3 + r % 3) * p->grid->cols;
+}
+
+// Columns [1, cols-1) of one row; same per-cell arithmetic as heat_update_span
+static double update_row(const heat_grid *grid, const double *up, const double *mid, const double *down,
+                         double *out) {
+    double dx2 = grid->dx * grid->dx;
+    double dy2 = grid->dy * grid->dy;
+    double factor = grid->alpha * grid->dt;
+    double max_change = 0.0;
+
+    for (int j = 1; j < grid->cols - 1; j++) {
+        double d2T_dx2 = (down[j] - 2.0 * mid[j] + up[j]) / dx2;
+        double d2T_dy2 = (mid[j + 1] - 2.0 * mid[j] + mid[j - 1]) / dy2;
+        double change = factor * (d2T_dx2 + d2T_dy2);
+        out[j] = mid[j] + change;
+        if (change < 0.0) change = -change;
+        if (change > max_change) max_change = change;
+    }
+    return max_change;
+}
+
+static void fill_sides(const stream_pass *p, double *row) {
+    heat_grid line = {1, p->grid->cols, p->grid->cols, 0.0, p->grid->dx, p->grid->dy, 0.0};
+    heat_fill_edge(&line, row, HEAT_EDGE_LEFT, &p->bc[HEAT_EDGE_LEFT], 0, 1);
+    heat_fill_edge(&line, row, HEAT_EDGE_RIGHT, &p->bc[HEAT_EDGE_RIGHT], 0, 1);
+}
+
+// Ghost row (top or bottom) of an intermediate level from its inner row
+static void fill_ghost_row(const stream_pass *p, heat_edge edge, const double *inner, double *ghost) {
+    int cols = p->grid->cols;
+    heat_grid pair = {2, cols, cols, 0.0, p->grid->dx, p->grid->dy, 0.0};
+    int inner_row = edge == HEAT_EDGE_TOP ? 1 : 0;
+    memcpy(p->edge + (size_t)inner_row * cols, inner, cols * sizeof(double));
+    heat_fill_edge(&pair, p->edge, edge, &p->bc[edge], 0, cols);
+    memcpy(ghost, p->edge + (size_t)(1 - inner_row) * cols, cols * sizeof(double));
+    fill_sides(p, ghost);
+}
+
+// Row r of `level` is in its ring: advance the row above it one level
+static void feed(stream_pass *p, int level, int r) {
+    int rows = p->grid->rows;
+    if (r < 2) return;
+    int i = r - 1;
+    int next = level + 1;
+    double *out = next == p->levels ? p->field->T + (size_t)i * p->grid->cols : ring_row(p, next, i);
+    double change = update_row(p->grid, ring_row(p, level, i - 1), ring_row(p, level, i),
+                               ring_row(p, level, r), out);
+    fill_sides(p, out);
+    if (next == p->levels) {
+        if (change > p->max_change) p->max_change = change;
+        return;
+    }
+
+    if (i == 1) {
+        fill_ghost_row(p, HEAT_EDGE_TOP, out, ring_row(p, next, 0));
+        feed(p, next, 0);
+    }
+    feed(p, next, i);
+    if (i == rows - 2) {
+        fill_ghost_row(p, HEAT_EDGE_BOTTOM, out, ring_row(p, next, rows - 1));
+        feed(p, next, rows - 1);
+    }
+}
+
+double heat_stream_steps(heat_mapped_field *field, const heat_grid *grid, const heat_bc bc[HEAT_EDGE_COUNT],
+                         int steps, int slab_rows) {
+    if (steps < 1 || slab_rows < 1) return -1.0;
+    if (steps > 1 && (bc[HEAT_EDGE_TOP].type == HEAT_BC_PERIODIC || bc[HEAT_EDGE_BOTTOM].type == HEAT_BC_PERIODIC)) {
+        return -1.0;
+    }
+    int rows = grid->rows, cols = grid->cols;
+    stream_pass p = {field, grid, bc, steps, NULL, NULL, 0.0};
+    p.rings = (double *)malloc(((size_t)steps * 3 + 2) * cols * sizeof(double));
+    if (p.rings == NULL) return -1.0;
+    p.edge = p.rings + (size_t)steps * 3 * cols;
+
+    // Rows below `released` are finished and dropped from the resident
+    // set a slab at a time; the next slab is requested a slab ahead
+    int released = 1;
+    for (int r = 0; r < rows; r++) {
+        if (r % slab_rows == 0) prefetch_rows(field, r + slab_rows, r + 2 * slab_rows);
+        memcpy(ring_row(&p, 0, r), field->T + (size_t)r * cols, cols * sizeof(double));
+        feed(&p, 0, r);
+        int written = r - steps + 1;     // rows [1, written) hold their final values
+        if (written - released >= slab_rows) {
+            heat_release_rows(field, released, written);
+            released = written;
+        }
+    }
+
+    // The written-back level's ghost rows, in heat_fill_edge order so the
+    // corners take the left/right values. Periodic rows wrap onto the
+    // finished far side, which is why they need one step per pass.
+    heat_grid whole = *grid;
+    heat_fill_edge(&whole, field->T, HEAT_EDGE_TOP, &bc[HEAT_EDGE_TOP], 0, cols);
+    heat_fill_edge(&whole, field->T, HEAT_EDGE_BOTTOM, &bc[HEAT_EDGE_BOTTOM], 0, cols);
+    fill_sides(&p, field->T);
+    fill_sides(&p, field->T + (size_t)(rows - 1) * cols);
+    heat_release_rows(field, 0, rows);
+
+    free(p.rings);
+    return p.max_change;
+}
@@ -0,0 +1,181 @@
+#include "heat.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *kind_names[HEAT_STRETCH_COUNT] = {"uniform", "tanh", "geometric"};
+static const char *side_names[] = {"both", "start", "end"};
+
+const char *heat_stretch_name(heat_stretch_kind kind) {
+    return (kind >= 0 && kind < HEAT_STRETCH_COUNT) ? kind_names[kind] : "unknown";
+}
+
+int heat_parse_stretch(const char *spec, int *axis, heat_stretch *stretch) {
+    if ((spec[0] != 'x' && spec[0] != 'y') || spec[1] != '=') return -1;
+    const char *name = spec + 2;
+    const char *colon = strchr(name, ':');
+    size_t len = colon ? (size_t)(colon - name) : strlen(name);
+    int k = -1;
+    for (int n = 0; n < HEAT_STRETCH_COUNT; n++) {
+        if (strlen(kind_names[n]) == len && strncmp(name, kind_names[n], len) == 0) k = n;
+    }
+    if (k < 0) return -1;
+
+    heat_stretch s = {(heat_stretch_kind)k, 0.0, HEAT_CLUSTER_BOTH};
+    if (k != HEAT_STRETCH_UNIFORM) {
+        if (colon == NULL) return -1;
+        char *end;
+        s.param = strtod(colon + 1, &end);
+        if (end == colon + 1) return -1;
+        if (*end == ':') {
+            int side = -1;
+            for (int n = 0; n < 3; n++) {
+                if (strcmp(end + 1, side_names[n]) == 0) side = n;
+            }
+            if (side < 0) return -1;
+            s.side = (heat_cluster_side)side;
+        } else if (*end != '\0') {
+            return -1;
+        }
+        // tanh needs a positive strength, geometric a growth ratio above 1
+        if (k == HEAT_STRETCH_TANH && !(s.param > 0.0)) return -1;
+        if (k == HEAT_STRETCH_GEOMETRIC && !(s.param > 1.0)) return -1;
+    } else if (colon != NULL) {
+        return -1;
+    }
+    *axis = spec[0] == 'x' ? 0 : 1;
+    *stretch = s;
+    return 0;
+}
+
+// Fraction s(xi) of the length at parameter xi in [0, 1]; the spacing is
+// small where ds/dxi is small
+static double tanh_map(const heat_stretch *s, double xi) {
+    double b = s->param;
+    switch (s->side) {
+        case HEAT_CLUSTER_START: return 1.0 + tanh(b * (xi - 1.0)) / tanh(b);
+        case HEAT_CLUSTER_END:   return tanh(b * xi) / tanh(b);
+        default:                 return 0.5 * (1.0 + tanh(b * (2.0 * xi - 1.0)) / tanh(b));
+    }
+}
+
+void heat_stretch_coords(const heat_stretch *stretch, int n, double length, double *coord) {
+    int intervals = n - 1;
+    if (stretch->kind == HEAT_STRETCH_GEOMETRIC) {
+        // Interval k grows by the ratio with its distance from the clustered edge(s)
+        double total = 0.0;
+        coord[0] = 0.0;
+        for (int k = 0; k < intervals; k++) {
+            int from = k;
+            if (stretch->side == HEAT_CLUSTER_END) from = intervals - 1 - k;
+            if (stretch->side == HEAT_CLUSTER_BOTH && intervals - 1 - k < k) from = intervals - 1 - k;
+            total += pow(stretch->param, from);
+            coord[k + 1] = total;
+        }
+        for (int k = 1; k <= intervals; k++) coord[k] *= length / total;
+    } else {
+        for (int k = 0; k <= intervals; k++) {
+            double xi = (double)k / intervals;
+            coord[k] = length * (stretch->kind == HEAT_STRETCH_TANH ? tanh_map(stretch, xi) : xi);
+        }
+    }
+    coord[intervals] = length;
+}
+
+void heat_stretched_free(heat_stretched *st) {
+    free(st->x);
+    free(st->y);
+    free(st->up);
+    free(st->down);
+    free(st->left);
+    free(st->right);
+    memset(st, 0, sizeof(*st));
+}
+
+// Non-uniform second difference at node k: 2 / (h- + h+) times the
+// difference of the one-sided slopes, split into the weights of the two
+// neighbours (times alpha * dt)
+static void node_weights(const double *coord, int n, double alpha_dt, double *lower, double *upper) {
+    lower[0] = upper[0] = lower[n - 1] = upper[n - 1] = 0.0;
+    for (int k = 1; k < n - 1; k++) {
+        double hm = coord[k] - coord[k - 1];
+        double hp = coord[k + 1] - coord[k];
+        lower[k] = alpha_dt * 2.0 / (hm * (hm + hp));
+        upper[k] = alpha_dt * 2.0 / (hp * (hm + hp));
+    }
+}
+
+int heat_stretched_init(heat_stretched *st, const heat_grid *grid, const heat_stretch *sx, const heat_stretch *sy) {
+    memset(st, 0, sizeof(*st));
+    st->rows = grid->rows;
+    st->cols = grid->cols;
+    st->x = (double *)malloc(grid->rows * sizeof(double));
+    st->y = (double *)malloc(grid->cols * sizeof(double));
+    st->up = (double *)malloc(grid->rows * sizeof(double));
+    st->down = (double *)malloc(grid->rows * sizeof(double));
+    st->left = (double *)malloc(grid->cols * sizeof(double));
+    st->right = (double *)malloc(grid->cols * sizeof(double));
+    if (!st->x || !st->y || !st->up || !st->down || !st->left || !st->right) {
+        heat_stretched_free(st);
+        return -1;
+    }
+    // The domain keeps its uniform extent; only the nodes move
+    heat_stretch_coords(sx, grid->rows, (grid->rows - 1) * grid->dx, st->x);
+    heat_stretch_coords(sy, grid->cols, (grid->cols - 1) * grid->dy, st->y);
+    double alpha_dt = grid->alpha * grid->dt;
+    node_weights(st->x, grid->rows, alpha_dt, st->up, st->down);
+    node_weights(st->y, grid->cols, alpha_dt, st->left, st->right);
+    return 0;
+}
+
+double heat_stretched_stable_dt(const heat_stretched *st, double alpha) {
+    // Explicit Euler is stable while every cell's weights sum to <= 1,
+    // i.e. alpha * dt * (2 / (h- h+) down the rows + across the columns)
+    double rows_max = 0.0, cols_max = 0.0;
+    for (int i = 1; i < st->rows - 1; i++) {
+        double h2 = (st->x[i] - st->x[i - 1]) * (st->x[i + 1] - st->x[i]);
+        rows_max = fmax(rows_max, 2.0 / h2);
+    }
+    for (int j = 1; j < st->cols - 1; j++) {
+        double h2 = (st->y[j] - st->y[j - 1]) * (st->y[j + 1] - st->y[j]);
+        cols_max = fmax(cols_max, 2.0 / h2);
+    }
+    return 1.0 / (alpha * (rows_max + cols_max));
+}
+
+double heat_stretched_step(const heat_stretched *st, const heat_grid *grid, const double *T, double *T_new,
+                           heat_region region) {
+    int s = grid->stride;
+    const double *left = st->left, *right = st->right;
+    double max_change = 0.0;
+
+    for (int i = region.row_begin; i < region.row_end; i++) {
+        const double *row = T + (size_t)i * s;
+        double *out = T_new + (size_t)i * s;
+        double up = st->up[i], down = st->down[i];
+        for (int j = region.col_begin; j < region.col_end; j++) {
+            double mid = row[j];
+            double change = up * (row[j - s] - mid) + down * (row[j + s] - mid) +
+                            left[j] * (row[j - 1] - mid) + right[j] * (row[j + 1] - mid);
+            out[j] = mid + change;
+            if (change < 0.0) change = -change;
+            if (change > max_change) max_change = change;
+        }
+    }
+    return max_change;
+}
+
+void heat_stretched_fill_edge(const heat_stretched *st, const heat_grid *grid, double *T, heat_edge edge,
+                              const heat_bc *bc, int begin, int end) {
+    // Neumann and Robin hold on the face between the ring and the first
+    // interior node, so they need the spacing at that edge
+    heat_grid local = *grid;
+    switch (edge) {
+        case HEAT_EDGE_TOP:    local.dx = st->x[1] - st->x[0]; break;
+        case HEAT_EDGE_BOTTOM: local.dx = st->x[st->rows - 1] - st->x[st->rows - 2]; break;
+        case HEAT_EDGE_LEFT:   local.dy = st->y[1] - st->y[0]; break;
+        default:               local.dy = st->y[st->cols - 1] - st->y[st->cols - 2]; break;
+    }
+    heat_fill_edge(&local, T, edge, bc, begin, end);
+}
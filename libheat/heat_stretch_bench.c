@@ -0,0 +1,148 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "heat.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Uniform versus stretched rows on the drivers' thin boundary layers:
+// a plate of thickness 1 between two hot faces (T = 1), insulated sides,
+// started from the exact solution at t_end / 4 so the layers are already
+// formed. For each spacing it refines until the max error at t_end,
+// relative to the face temperature, meets the tolerance, and reports the
+// coarsest grid that passes and what it cost. dt is 90% of each grid's
+// stability limit, so finer boundary cells also mean more steps.
+// Usage: heat_stretch_bench [tolerance t_end]
+
+#define ALPHA 0.1
+#define COLS 4
+#define STABILITY_FRACTION 0.9
+static const int grid_sizes[] = {9, 11, 13, 17, 21, 25, 33, 41, 49, 65, 81, 97, 129, 161, 193, 257, 321, 385, 513};
+
+static const char *specs[] = {"x=uniform", "x=tanh:1.5", "x=tanh:2.5", "x=geometric:1.08"};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 1 - sum over odd k of 4/(k pi) sin(k pi x) exp(-alpha (k pi)^2 t)
+static double exact(double x, double t) {
+    const double pi = acos(-1.0);
+    double sum = 0.0;
+    for (int k = 1; k < 20000; k += 2) {
+        double decay = exp(-ALPHA * (k * pi) * (k * pi) * t);
+        if (decay < 1e-17) break;
+        sum += 4.0 / (k * pi) * sin(k * pi * x) * decay;
+    }
+    return 1.0 - sum;
+}
+
+typedef struct {
+    double error;
+    int steps;
+    double mcell_updates;
+    double seconds;
+} run_result;
+
+static run_result run(const heat_stretch *stretch, int n, double t_end) {
+    // The columns carry no gradient; wide ones keep them out of the stability limit
+    heat_grid grid = {n, COLS, COLS, ALPHA, 1.0 / (n - 1), 1.0, 1.0};
+    heat_stretch uniform = {HEAT_STRETCH_UNIFORM, 0.0, HEAT_CLUSTER_BOTH};
+    heat_stretched st;
+    if (heat_stretched_init(&st, &grid, stretch, &uniform) != 0) {
+        fprintf(stderr, "ERROR: allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    double t0 = 0.25 * t_end;
+    int steps = (int)ceil((t_end - t0) / (STABILITY_FRACTION * heat_stretched_stable_dt(&st, ALPHA)));
+    grid.dt = (t_end - t0) / steps;
+    heat_stretched_free(&st);
+    if (heat_stretched_init(&st, &grid, stretch, &uniform) != 0) {
+        fprintf(stderr, "ERROR: allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t cells = (size_t)n * COLS;
+    double *T = (double *)malloc(cells * sizeof(double));
+    double *T_new = (double *)malloc(cells * sizeof(double));
+    if (!T || !T_new) {
+        fprintf(stderr, "ERROR: allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++) {
+        double value = i == 0 || i == n - 1 ? 1.0 : exact(st.x[i], t0);
+        for (int j = 0; j < COLS; j++) T[(size_t)i * COLS + j] = value;
+    }
+    memcpy(T_new, T, cells * sizeof(double));
+
+    heat_bc insulated = {HEAT_BC_NEUMANN, 0.0, 0.0};
+    heat_region interior = heat_interior(&grid);
+    double start = now();
+    for (int step = 0; step < steps; step++) {
+        heat_stretched_fill_edge(&st, &grid, T, HEAT_EDGE_LEFT, &insulated, 1, n - 1);
+        heat_stretched_fill_edge(&st, &grid, T, HEAT_EDGE_RIGHT, &insulated, 1, n - 1);
+        heat_stretched_step(&st, &grid, T, T_new, interior);
+        double *tmp = T;
+        T = T_new;
+        T_new = tmp;
+    }
+    run_result result = {0.0, steps, (double)(n - 2) * (COLS - 2) * steps * 1e-6, now() - start};
+
+    for (int i = 1; i < n - 1; i++) {
+        result.error = fmax(result.error, fabs(T[(size_t)i * COLS + 1] - exact(st.x[i], t_end)));
+    }
+    heat_stretched_free(&st);
+    free(T);
+    free(T_new);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    double tol = argc > 1 ? atof(argv[1]) : 1e-3;
+    double t_end = argc > 2 ? atof(argv[2]) : 0.01;
+    if (tol <= 0.0 || t_end <= 0.0) {
+        fprintf(stderr, "Usage: %s [tolerance t_end]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("Hot-faced plate, alpha=%.2f, t_end=%.4f (layer ~%.3f thick), tolerance %.1e\n", ALPHA, t_end,
+           2.0 * sqrt(ALPHA * t_end), tol);
+    printf("%-18s %6s %12s %8s %14s %10s\n", "rows", "nodes", "error", "steps", "Mcell-updates", "time (s)");
+
+    int count = (int)(sizeof(grid_sizes) / sizeof(grid_sizes[0]));
+    int nspecs = (int)(sizeof(specs) / sizeof(specs[0]));
+    int best_n[sizeof(specs) / sizeof(specs[0])] = {0};
+    run_result best[sizeof(specs) / sizeof(specs[0])];
+    for (int k = 0; k < nspecs; k++) {
+        int axis;
+        heat_stretch stretch;
+        heat_parse_stretch(specs[k], &axis, &stretch);
+        for (int g = 0; g < count && best_n[k] == 0; g++) {
+            run_result r = run(&stretch, grid_sizes[g], t_end);
+            printf("%-18s %6d %12.3e %8d %14.2f %10.4f%s\n", specs[k] + 2, grid_sizes[g], r.error, r.steps,
+                   r.mcell_updates, r.seconds, r.error <= tol ? "  <- coarsest passing" : "");
+            if (r.error <= tol) {
+                best[k] = r;
+                best_n[k] = grid_sizes[g];
+            }
+        }
+    }
+
+    printf("\n");
+    for (int k = 0; k < nspecs; k++) {
+        if (best_n[k] == 0) {
+            printf("%-18s no grid up to %d rows meets %.1e\n", specs[k] + 2, grid_sizes[count - 1], tol);
+        } else if (k > 0 && best_n[0]) {
+            printf("%-18s %4d rows (%.1fx fewer), %.1fx the cell-updates of uniform\n", specs[k] + 2, best_n[k],
+                   (double)best_n[0] / best_n[k], best[k].mcell_updates / best[0].mcell_updates);
+        } else {
+            printf("%-18s %4d rows, %.2f Mcell-updates\n", specs[k] + 2, best_n[k], best[k].mcell_updates);
+        }
+    }
+    return 0;
+}